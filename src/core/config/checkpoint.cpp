@@ -0,0 +1,32 @@
+#include "filesystem.hpp"
+#include "flock/core/config.hpp"
+
+namespace flock {
+
+std::string Config::get_checkpoint_table_name() { return "FLOCKMTL_CHECKPOINT_INTERNAL_TABLE"; }
+
+void Config::ConfigCheckpointTable(duckdb::Connection& con, std::string& schema_name, const ConfigType type) {
+    // The journal must outlive the query (and a crashed process), so it only lives in the global storage
+    if (type != ConfigType::GLOBAL) {
+        return;
+    }
+
+    const std::string table_name = Config::get_checkpoint_table_name();
+    auto result = con.Query(duckdb_fmt::format(" SELECT table_name "
+                                               "   FROM information_schema.tables "
+                                               "  WHERE table_schema = '{}' "
+                                               "    AND table_name = '{}'; ",
+                                               schema_name, table_name));
+    if (result->RowCount() == 0) {
+        con.Query(duckdb_fmt::format(" CREATE TABLE {}.{} ( "
+                                     " request_hash VARCHAR NOT NULL, "
+                                     " row_hash VARCHAR NOT NULL, "
+                                     " result VARCHAR NOT NULL, "
+                                     " created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP, "
+                                     " PRIMARY KEY (request_hash, row_hash) "
+                                     " ); ",
+                                     schema_name, table_name));
+    }
+}
+
+}// namespace flock
@@ -74,6 +74,9 @@ void Config::ConfigureTables(duckdb::Connection& con, const ConfigType type) {
     ConfigSchema(con, schema);
     ConfigModelTable(con, schema, type);
     ConfigPromptTable(con, schema, type);
+    ConfigSemanticViewTables(con, schema, type);
+    ConfigReduceStateTable(con, schema, type);
+    ConfigCheckpointTable(con, schema, type);
     con.Commit();
 }
 
@@ -145,4 +148,12 @@ Config::StorageAttachmentGuard::~StorageAttachmentGuard() {
     }
 }
 
+std::mutex& Config::ExclusiveStorageGuard::Mutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+Config::ExclusiveStorageGuard::ExclusiveStorageGuard(duckdb::Connection& con, bool read_only)
+    : lock(Mutex()), guard(con, read_only) {}
+
 }// namespace flock
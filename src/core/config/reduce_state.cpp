@@ -0,0 +1,34 @@
+#include "filesystem.hpp"
+#include "flock/core/config.hpp"
+
+namespace flock {
+
+std::string Config::get_reduce_state_table_name() { return "FLOCKMTL_REDUCE_STATE_INTERNAL_TABLE"; }
+
+void Config::ConfigReduceStateTable(duckdb::Connection& con, std::string& schema_name, const ConfigType type) {
+    // Incremental llm_reduce state is shared across databases, so it only lives in the global storage
+    if (type != ConfigType::GLOBAL) {
+        return;
+    }
+
+    const std::string table_name = Config::get_reduce_state_table_name();
+    auto result = con.Query(duckdb_fmt::format(" SELECT table_name "
+                                               "   FROM information_schema.tables "
+                                               "  WHERE table_schema = '{}' "
+                                               "    AND table_name = '{}'; ",
+                                               schema_name, table_name));
+    if (result->RowCount() == 0) {
+        con.Query(duckdb_fmt::format(" CREATE TABLE {}.{} ( "
+                                     " state_key VARCHAR NOT NULL, "
+                                     " request_hash VARCHAR NOT NULL, "
+                                     " summary VARCHAR NOT NULL, "
+                                     " watermark VARCHAR NOT NULL, "
+                                     " boundary_rows VARCHAR NOT NULL, "
+                                     " updated_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP, "
+                                     " PRIMARY KEY (state_key, request_hash) "
+                                     " ); ",
+                                     schema_name, table_name));
+    }
+}
+
+}// namespace flock
@@ -0,0 +1,52 @@
+#include "filesystem.hpp"
+#include "flock/core/config.hpp"
+
+namespace flock {
+
+std::string Config::get_semantic_views_table_name() { return "FLOCKMTL_SEMANTIC_VIEW_INTERNAL_TABLE"; }
+
+std::string Config::get_semantic_view_results_table_name() { return "FLOCKMTL_SEMANTIC_VIEW_RESULTS_INTERNAL_TABLE"; }
+
+void Config::ConfigSemanticViewTables(duckdb::Connection& con, std::string& schema_name, const ConfigType type) {
+    // Semantic views are defined over local tables, so they are only tracked in the local database
+    if (type != ConfigType::LOCAL) {
+        return;
+    }
+
+    const std::string table_name = Config::get_semantic_views_table_name();
+    auto result = con.Query(duckdb_fmt::format(" SELECT table_name "
+                                               "   FROM information_schema.tables "
+                                               "  WHERE table_schema = '{}' "
+                                               "    AND table_name = '{}'; ",
+                                               schema_name, table_name));
+    if (result->RowCount() == 0) {
+        con.Query(duckdb_fmt::format(" CREATE TABLE {}.{} ( "
+                                     " view_name VARCHAR NOT NULL PRIMARY KEY, "
+                                     " source_table VARCHAR NOT NULL, "
+                                     " key_column VARCHAR NOT NULL, "
+                                     " definition VARCHAR NOT NULL, "
+                                     " created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP "
+                                     " ); ",
+                                     schema_name, table_name));
+    }
+
+    const std::string results_table_name = Config::get_semantic_view_results_table_name();
+    result = con.Query(duckdb_fmt::format(" SELECT table_name "
+                                          "   FROM information_schema.tables "
+                                          "  WHERE table_schema = '{}' "
+                                          "    AND table_name = '{}'; ",
+                                          schema_name, results_table_name));
+    if (result->RowCount() == 0) {
+        con.Query(duckdb_fmt::format(" CREATE TABLE {}.{} ( "
+                                     " view_name VARCHAR NOT NULL, "
+                                     " row_key VARCHAR NOT NULL, "
+                                     " input_hash VARCHAR NOT NULL, "
+                                     " result VARCHAR, "
+                                     " refreshed_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP, "
+                                     " PRIMARY KEY (view_name, row_key) "
+                                     " ); ",
+                                     schema_name, results_table_name));
+    }
+}
+
+}// namespace flock
@@ -3,6 +3,7 @@
 #include "flock/core/common.hpp"
 #include "flock/core/config.hpp"
 #include "flock/custom_parser/query_parser.hpp"
+#include "flock/model_manager/repository.hpp"
 #include <sstream>
 #include <stdexcept>
 
@@ -87,21 +88,23 @@ void ModelParser::ParseCreateModel(Tokenizer& tokenizer, std::unique_ptr<QuerySt
         token = tokenizer.NextToken();
         try {
             nlohmann::json input_args = nlohmann::json::parse(token.value);
-            // Only allow tuple_format, batch_size, model_parameters
+            // Only allow tuple_format, batch_size, model_parameters, execution_mode
             for (auto it = input_args.begin(); it != input_args.end(); ++it) {
                 const std::string& key = it.key();
-                if (key == "tuple_format" || key == "batch_size" || key == "model_parameters") {
+                if (key == "tuple_format" || key == "batch_size" || key == "model_parameters" || key == "execution_mode") {
                     const auto& param_val = it.value();
                     if (key == "batch_size") {
                         if (!param_val.is_number_integer()) {
                             throw std::runtime_error("Expected 'batch_size' to be an integer.");
                         }
                         model_args[key] = param_val.get<int>();
+                    } else if (key == "execution_mode") {
+                        model_args[key] = ExecutionModeToString(ParseExecutionMode(param_val.get<std::string>()));
                     } else {
                         model_args[key] = it.value();
                     }
                 } else {
-                    throw std::runtime_error("Unknown model_args parameter: '" + key + "'. Only tuple_format, batch_size, and model_parameters are allowed.");
+                    throw std::runtime_error("Unknown model_args parameter: '" + key + "'. Only tuple_format, batch_size, model_parameters, and execution_mode are allowed.");
                 }
             }
         } catch (const std::exception& e) {
@@ -225,21 +228,23 @@ void ModelParser::ParseUpdateModel(Tokenizer& tokenizer, std::unique_ptr<QuerySt
             token = tokenizer.NextToken();
             try {
                 nlohmann::json input_args = nlohmann::json::parse(token.value);
-                // Only allow tuple_format, batch_size, model_parameters
+                // Only allow tuple_format, batch_size, model_parameters, execution_mode
                 for (auto it = input_args.begin(); it != input_args.end(); ++it) {
                     const std::string& key = it.key();
-                    if (key == "tuple_format" || key == "batch_size" || key == "model_parameters") {
+                    if (key == "tuple_format" || key == "batch_size" || key == "model_parameters" || key == "execution_mode") {
                         const auto& param_val = it.value();
                         if (key == "batch_size") {
                             if (!param_val.is_number_integer()) {
                                 throw std::runtime_error("Expected 'batch_size' to be an integer.");
                             }
                             new_model_args[key] = param_val.get<int>();
+                        } else if (key == "execution_mode") {
+                            new_model_args[key] = ExecutionModeToString(ParseExecutionMode(param_val.get<std::string>()));
                         } else {
                             new_model_args[key] = it.value();
                         }
                     } else {
-                        throw std::runtime_error("Unknown model_args parameter: '" + key + "'. Only tuple_format, batch_size, and model_parameters are allowed.");
+                        throw std::runtime_error("Unknown model_args parameter: '" + key + "'. Only tuple_format, batch_size, model_parameters, and execution_mode are allowed.");
                     }
                 }
             } catch (const std::exception& e) {
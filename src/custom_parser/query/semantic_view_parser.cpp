@@ -0,0 +1,540 @@
+#include "flock/custom_parser/query/semantic_view_parser.hpp"
+
+#include "duckdb/main/materialized_query_result.hpp"
+#include "flock/core/common.hpp"
+#include "flock/core/config.hpp"
+#include "flock/custom_parser/query_parser.hpp"
+
+#include <functional>
+#include <sstream>
+#include <stdexcept>
+
+namespace flock {
+
+namespace {
+
+std::string QuoteIdentifier(const std::string& name) {
+    std::string quoted = "\"";
+    for (char c: name) {
+        quoted += c;
+        if (c == '"') {
+            quoted += '"';
+        }
+    }
+    return quoted + "\"";
+}
+
+std::string QuoteLiteral(const std::string& value) { return FormatValueForSQL(duckdb::Value(value)); }
+
+void ThrowOnError(const duckdb::unique_ptr<duckdb::MaterializedQueryResult>& result) {
+    if (result->HasError()) {
+        throw std::runtime_error(result->GetError());
+    }
+}
+
+int64_t AffectedRows(const duckdb::unique_ptr<duckdb::MaterializedQueryResult>& result) {
+    ThrowOnError(result);
+    if (result->RowCount() == 0) {
+        return 0;
+    }
+    return result->GetValue(0, 0).GetValue<int64_t>();
+}
+
+std::string SemanticViewsTable() { return "flock_config." + Config::get_semantic_views_table_name(); }
+
+std::string SemanticViewResultsTable() { return "flock_config." + Config::get_semantic_view_results_table_name(); }
+
+std::string ContextColumnName(const nlohmann::json& context_column) {
+    return context_column.is_string() ? context_column.get<std::string>() : context_column["name"].get<std::string>();
+}
+
+// Hash of everything that determines a row's result: the view definition and the row's input columns
+std::string InputHashExpression(const nlohmann::json& definition, const std::string& alias) {
+    std::ostringstream inputs;
+    auto first = true;
+    for (const auto& context_column: definition["context_columns"]) {
+        auto column = QuoteIdentifier(ContextColumnName(context_column));
+        inputs << (first ? "" : ", ") << column << " := " << alias << "." << column;
+        first = false;
+    }
+    return duckdb_fmt::format("md5({} || CAST(struct_pack({}) AS VARCHAR))", QuoteLiteral(definition.dump()),
+                              inputs.str());
+}
+
+std::string RowKeyExpression(const std::string& key_column, const std::string& alias) {
+    return duckdb_fmt::format("CAST({}.{} AS VARCHAR)", alias, QuoteIdentifier(key_column));
+}
+
+// Build the llm_complete call over the projected input columns of alias
+std::string LlmCompleteExpression(const nlohmann::json& definition, const std::string& alias) {
+    std::ostringstream context_columns;
+    auto first = true;
+    for (const auto& context_column: definition["context_columns"]) {
+        auto name = ContextColumnName(context_column);
+        context_columns << (first ? "" : ", ") << "{'data': " << alias << "." << QuoteIdentifier(name)
+                        << ", 'name': " << QuoteLiteral(name);
+        if (context_column.is_object()) {
+            for (const auto& [key, value]: context_column.items()) {
+                if (key != "name") {
+                    context_columns << ", " << QuoteLiteral(key) << ": " << SemanticViewParser::JsonToStructLiteral(value);
+                }
+            }
+        }
+        context_columns << "}";
+        first = false;
+    }
+
+    std::ostringstream prompt;
+    prompt << "{";
+    for (const auto& [key, value]: definition["prompt"].items()) {
+        prompt << QuoteLiteral(key) << ": " << SemanticViewParser::JsonToStructLiteral(value) << ", ";
+    }
+    prompt << "'context_columns': [" << context_columns.str() << "]}";
+
+    return duckdb_fmt::format("llm_complete({}, {})", SemanticViewParser::JsonToStructLiteral(definition["model"]),
+                              prompt.str());
+}
+
+// Results are stored per key, so a key that appears twice in the source table cannot be materialized
+void CheckUniqueKeys(duckdb::Connection& con, const std::string& view_name, const std::string& source_table,
+                     const std::string& key_column) {
+    auto result = con.Query(duckdb_fmt::format(" SELECT {} AS flock_row_key, COUNT(*) "
+                                               "   FROM {} AS s "
+                                               "  WHERE s.{} IS NOT NULL "
+                                               "  GROUP BY flock_row_key "
+                                               " HAVING COUNT(*) > 1 "
+                                               "  LIMIT 1; ",
+                                               RowKeyExpression(key_column, "s"), source_table,
+                                               QuoteIdentifier(key_column)));
+    ThrowOnError(result);
+    if (result->RowCount() != 0) {
+        throw std::runtime_error(duckdb_fmt::format(
+                "Semantic view '{}' requires unique values in key column '{}', but '{}' appears {} times in '{}'.",
+                view_name, key_column, result->GetValue(0, 0).ToString(), result->GetValue(1, 0).ToString(),
+                source_table));
+    }
+}
+
+// Recompute results for new or changed rows, drop results for rows that left the source table.
+// Each chunk of results commits on its own, so a failed model call only loses the chunk in flight
+// and running the refresh again resumes from the rows that are still missing.
+std::string RefreshSemanticView(duckdb::Connection& con, const std::string& view_name) {
+    auto result = con.Query(duckdb_fmt::format(" SELECT source_table, key_column, definition "
+                                               "   FROM {} "
+                                               "  WHERE view_name = {}; ",
+                                               SemanticViewsTable(), QuoteLiteral(view_name)));
+    ThrowOnError(result);
+    if (result->RowCount() == 0) {
+        throw std::runtime_error(duckdb_fmt::format("Semantic view '{}' doesn't exist.", view_name));
+    }
+    auto source_table = result->GetValue(0, 0).ToString();
+    auto key_column = result->GetValue(1, 0).ToString();
+    auto definition = nlohmann::json::parse(result->GetValue(2, 0).ToString());
+
+    std::ostringstream input_columns;
+    for (const auto& context_column: definition["context_columns"]) {
+        input_columns << ", s." << QuoteIdentifier(ContextColumnName(context_column));
+    }
+
+    CheckUniqueKeys(con, view_name, source_table, key_column);
+
+    auto removed_rows = AffectedRows(con.Query(duckdb_fmt::format(
+            " DELETE FROM {} AS r "
+            "  WHERE r.view_name = {} "
+            "    AND NOT EXISTS (SELECT 1 FROM {} AS s WHERE {} = r.row_key); ",
+            SemanticViewResultsTable(), QuoteLiteral(view_name), source_table,
+            RowKeyExpression(key_column, "s"))));
+
+    // Every stale row gets a result, so each chunk shrinks the set of stale rows until it is empty
+    auto chunk_query = duckdb_fmt::format(
+            " INSERT OR REPLACE INTO {} (view_name, row_key, input_hash, result, refreshed_at) "
+            " SELECT {}, c.flock_row_key, c.flock_input_hash, {}, now() "
+            "   FROM (SELECT {} AS flock_row_key, {} AS flock_input_hash{} "
+            "           FROM {} AS s "
+            "          WHERE s.{} IS NOT NULL "
+            "            AND NOT EXISTS (SELECT 1 FROM {} AS r "
+            "                             WHERE r.view_name = {} "
+            "                               AND r.row_key = {} "
+            "                               AND r.input_hash = {}) "
+            "          ORDER BY flock_row_key "
+            "          LIMIT {}) AS c; ",
+            SemanticViewResultsTable(), QuoteLiteral(view_name), LlmCompleteExpression(definition, "c"),
+            RowKeyExpression(key_column, "s"), InputHashExpression(definition, "s"), input_columns.str(),
+            source_table, QuoteIdentifier(key_column), SemanticViewResultsTable(), QuoteLiteral(view_name),
+            RowKeyExpression(key_column, "s"), InputHashExpression(definition, "s"),
+            SemanticViewParser::REFRESH_CHUNK_ROWS);
+
+    int64_t computed_rows = 0;
+    while (true) {
+        auto chunk_rows = AffectedRows(con.Query(chunk_query));
+        computed_rows += chunk_rows;
+        if (chunk_rows < SemanticViewParser::REFRESH_CHUNK_ROWS) {
+            break;
+        }
+    }
+
+    return duckdb_fmt::format("SELECT 'Semantic view refreshed successfully' AS status, "
+                              "{} AS computed_rows, {} AS removed_rows",
+                              computed_rows, removed_rows);
+}
+
+// Run the statements of fn in one transaction, so a failure leaves nothing behind
+std::string RunInTransaction(duckdb::Connection& con, const std::function<std::string()>& fn) {
+    con.BeginTransaction();
+    try {
+        auto query = fn();
+        con.Commit();
+        return query;
+    } catch (...) {
+        con.Rollback();
+        throw;
+    }
+}
+
+}// namespace
+
+nlohmann::json SemanticViewParser::ValidateDefinition(const nlohmann::json& definition) {
+    if (!definition.is_object()) {
+        throw std::runtime_error("Expected the semantic view definition to be a JSON object.");
+    }
+    for (const auto& [key, value]: definition.items()) {
+        if (key != "model" && key != "prompt" && key != "context_columns" && key != "output_column") {
+            throw std::runtime_error("Unknown semantic view parameter: '" + key +
+                                     "'. Only model, prompt, context_columns, and output_column are allowed.");
+        }
+    }
+    if (!definition.contains("model") || !definition["model"].is_object() || !definition["model"].contains("model_name")) {
+        throw std::runtime_error("Expected 'model' to be an object with a 'model_name'.");
+    }
+    if (!definition.contains("prompt") || !definition["prompt"].is_object() ||
+        (!definition["prompt"].contains("prompt") && !definition["prompt"].contains("prompt_name"))) {
+        throw std::runtime_error("Expected 'prompt' to be an object with a 'prompt' or 'prompt_name'.");
+    }
+    if (!definition.contains("context_columns") || !definition["context_columns"].is_array() ||
+        definition["context_columns"].empty()) {
+        throw std::runtime_error("Expected 'context_columns' to be a non-empty list of column names.");
+    }
+    for (const auto& context_column: definition["context_columns"]) {
+        if (!context_column.is_string() &&
+            !(context_column.is_object() && context_column.contains("name") && context_column["name"].is_string())) {
+            throw std::runtime_error("Expected each context column to be a column name or an object with a 'name'.");
+        }
+    }
+
+    auto validated = definition;
+    if (!validated.contains("output_column")) {
+        validated["output_column"] = DEFAULT_OUTPUT_COLUMN;
+    } else if (!validated["output_column"].is_string() || validated["output_column"].get<std::string>().empty()) {
+        throw std::runtime_error("Expected 'output_column' to be a non-empty string.");
+    }
+    return validated;
+}
+
+std::string SemanticViewParser::JsonToStructLiteral(const nlohmann::json& value) {
+    if (value.is_object()) {
+        std::ostringstream literal;
+        literal << "{";
+        auto first = true;
+        for (const auto& [key, child]: value.items()) {
+            literal << (first ? "" : ", ") << QuoteLiteral(key) << ": " << JsonToStructLiteral(child);
+            first = false;
+        }
+        literal << "}";
+        return literal.str();
+    }
+    if (value.is_array()) {
+        std::ostringstream literal;
+        literal << "[";
+        for (size_t i = 0; i < value.size(); i++) {
+            literal << (i == 0 ? "" : ", ") << JsonToStructLiteral(value[i]);
+        }
+        literal << "]";
+        return literal.str();
+    }
+    if (value.is_string()) {
+        return QuoteLiteral(value.get<std::string>());
+    }
+    if (value.is_null()) {
+        return "NULL";
+    }
+    return value.dump();
+}
+
+void SemanticViewParser::Parse(const std::string& query, std::unique_ptr<QueryStatement>& statement) {
+    Tokenizer tokenizer(query);
+    auto token = tokenizer.NextToken();
+    auto value = duckdb::StringUtil::Upper(token.value);
+
+    if (token.type == TokenType::KEYWORD) {
+        if (value == "CREATE") {
+            ParseCreateSemanticView(tokenizer, statement);
+        } else if (value == "REFRESH") {
+            ParseRefreshSemanticView(tokenizer, statement);
+        } else if (value == "DELETE") {
+            ParseDeleteSemanticView(tokenizer, statement);
+        } else if (value == "GET") {
+            ParseGetSemanticView(tokenizer, statement);
+        } else {
+            throw std::runtime_error("Unknown keyword: " + token.value);
+        }
+    } else {
+        throw std::runtime_error("Unknown keyword: " + token.value);
+    }
+}
+
+std::string SemanticViewParser::ExpectSemanticView(Tokenizer& tokenizer) {
+    auto token = tokenizer.NextToken();
+    if (token.type != TokenType::KEYWORD || duckdb::StringUtil::Upper(token.value) != "SEMANTIC") {
+        throw std::runtime_error("Unknown keyword: " + token.value);
+    }
+    token = tokenizer.NextToken();
+    auto value = duckdb::StringUtil::Upper(token.value);
+    if (token.type != TokenType::KEYWORD || (value != "VIEW" && value != "VIEWS")) {
+        throw std::runtime_error("Expected 'VIEW' after 'SEMANTIC'.");
+    }
+    return value;
+}
+
+void SemanticViewParser::ParseCreateSemanticView(Tokenizer& tokenizer, std::unique_ptr<QueryStatement>& statement) {
+    if (ExpectSemanticView(tokenizer) != "VIEW") {
+        throw std::runtime_error("Expected 'VIEW' after 'SEMANTIC'.");
+    }
+
+    auto token = tokenizer.NextToken();
+    if (token.type != TokenType::PARENTHESIS || token.value != "(") {
+        throw std::runtime_error("Expected opening parenthesis '(' after 'SEMANTIC VIEW'.");
+    }
+
+    token = tokenizer.NextToken();
+    if (token.type != TokenType::STRING_LITERAL || token.value.empty()) {
+        throw std::runtime_error("Expected non-empty string literal for view name.");
+    }
+    auto view_name = token.value;
+
+    token = tokenizer.NextToken();
+    if (token.type != TokenType::SYMBOL || token.value != ",") {
+        throw std::runtime_error("Expected comma ',' after view name.");
+    }
+
+    token = tokenizer.NextToken();
+    if (token.type != TokenType::STRING_LITERAL || token.value.empty()) {
+        throw std::runtime_error("Expected non-empty string literal for source table.");
+    }
+    auto source_table = token.value;
+
+    token = tokenizer.NextToken();
+    if (token.type != TokenType::SYMBOL || token.value != ",") {
+        throw std::runtime_error("Expected comma ',' after source table.");
+    }
+
+    token = tokenizer.NextToken();
+    if (token.type != TokenType::STRING_LITERAL || token.value.empty()) {
+        throw std::runtime_error("Expected non-empty string literal for key column.");
+    }
+    auto key_column = token.value;
+
+    token = tokenizer.NextToken();
+    if (token.type != TokenType::SYMBOL || token.value != ",") {
+        throw std::runtime_error("Expected comma ',' after key column.");
+    }
+
+    token = tokenizer.NextToken();
+    if (token.type != TokenType::JSON) {
+        throw std::runtime_error("Expected JSON definition after key column.");
+    }
+    nlohmann::json definition;
+    try {
+        definition = nlohmann::json::parse(token.value);
+    } catch (const std::exception& e) {
+        throw std::runtime_error(std::string("Failed to parse semantic view definition JSON: ") + e.what());
+    }
+    definition = ValidateDefinition(definition);
+
+    token = tokenizer.NextToken();
+    if (token.type != TokenType::PARENTHESIS || token.value != ")") {
+        throw std::runtime_error("Expected closing parenthesis ')' after semantic view definition.");
+    }
+
+    token = tokenizer.NextToken();
+    if (token.type == TokenType::END_OF_FILE || token.type == TokenType::SYMBOL || token.value == ";") {
+        auto create_statement = std::make_unique<CreateSemanticViewStatement>();
+        create_statement->view_name = view_name;
+        create_statement->source_table = source_table;
+        create_statement->key_column = key_column;
+        create_statement->definition = definition;
+        statement = std::move(create_statement);
+    } else {
+        throw std::runtime_error("Unexpected characters after the closing parenthesis. Only a semicolon is allowed.");
+    }
+}
+
+void SemanticViewParser::ParseRefreshSemanticView(Tokenizer& tokenizer, std::unique_ptr<QueryStatement>& statement) {
+    if (ExpectSemanticView(tokenizer) != "VIEW") {
+        throw std::runtime_error("Expected 'VIEW' after 'SEMANTIC'.");
+    }
+
+    auto token = tokenizer.NextToken();
+    if (token.type != TokenType::STRING_LITERAL || token.value.empty()) {
+        throw std::runtime_error("Expected non-empty string literal for view name.");
+    }
+    auto view_name = token.value;
+
+    token = tokenizer.NextToken();
+    if (token.type == TokenType::END_OF_FILE || token.type == TokenType::SYMBOL || token.value == ";") {
+        auto refresh_statement = std::make_unique<RefreshSemanticViewStatement>();
+        refresh_statement->view_name = view_name;
+        statement = std::move(refresh_statement);
+    } else {
+        throw std::runtime_error("Unexpected characters after the view name. Only a semicolon is allowed.");
+    }
+}
+
+void SemanticViewParser::ParseDeleteSemanticView(Tokenizer& tokenizer, std::unique_ptr<QueryStatement>& statement) {
+    if (ExpectSemanticView(tokenizer) != "VIEW") {
+        throw std::runtime_error("Expected 'VIEW' after 'SEMANTIC'.");
+    }
+
+    auto token = tokenizer.NextToken();
+    if (token.type != TokenType::STRING_LITERAL || token.value.empty()) {
+        throw std::runtime_error("Expected non-empty string literal for view name.");
+    }
+    auto view_name = token.value;
+
+    token = tokenizer.NextToken();
+    if (token.type == TokenType::END_OF_FILE || token.type == TokenType::SYMBOL || token.value == ";") {
+        auto delete_statement = std::make_unique<DeleteSemanticViewStatement>();
+        delete_statement->view_name = view_name;
+        statement = std::move(delete_statement);
+    } else {
+        throw std::runtime_error("Unexpected characters after the view name. Only a semicolon is allowed.");
+    }
+}
+
+void SemanticViewParser::ParseGetSemanticView(Tokenizer& tokenizer, std::unique_ptr<QueryStatement>& statement) {
+    auto value = ExpectSemanticView(tokenizer);
+
+    auto token = tokenizer.NextToken();
+    if ((token.type == TokenType::END_OF_FILE || token.type == TokenType::SYMBOL || token.value == ";") && value == "VIEWS") {
+        statement = std::make_unique<GetAllSemanticViewStatement>();
+    } else {
+        if (token.type != TokenType::STRING_LITERAL || token.value.empty()) {
+            throw std::runtime_error("Expected non-empty string literal for view name.");
+        }
+        auto view_name = token.value;
+
+        token = tokenizer.NextToken();
+        if (token.type == TokenType::END_OF_FILE || token.type == TokenType::SYMBOL || token.value == ";") {
+            auto get_statement = std::make_unique<GetSemanticViewStatement>();
+            get_statement->view_name = view_name;
+            statement = std::move(get_statement);
+        } else {
+            throw std::runtime_error("Unexpected characters after the view name. Only a semicolon is allowed.");
+        }
+    }
+}
+
+std::string SemanticViewParser::ToSQL(const QueryStatement& statement) const {
+    std::string query;
+
+    // Semantic views live next to their source tables in the local database. Refreshing calls llm_complete,
+    // which attaches the global storage itself, so these statements run on a plain connection.
+    auto con = Config::GetConnection();
+    switch (statement.type) {
+        case StatementType::CREATE_SEMANTIC_VIEW: {
+            const auto& create_stmt = static_cast<const CreateSemanticViewStatement&>(statement);
+            // The definition and the view commit together, so a rejected definition leaves nothing behind
+            RunInTransaction(con, [&]() {
+                auto result = con.Query(duckdb_fmt::format(" SELECT view_name FROM {} WHERE view_name = {}; ",
+                                                           SemanticViewsTable(), QuoteLiteral(create_stmt.view_name)));
+                ThrowOnError(result);
+                if (result->RowCount() != 0) {
+                    throw std::runtime_error(
+                            duckdb_fmt::format("Semantic view '{}' already exists.", create_stmt.view_name));
+                }
+
+                CheckUniqueKeys(con, create_stmt.view_name, create_stmt.source_table, create_stmt.key_column);
+
+                const auto& definition = create_stmt.definition;
+                ThrowOnError(con.Query(duckdb_fmt::format(
+                        " INSERT INTO {} (view_name, source_table, key_column, definition) "
+                        " VALUES ({}, {}, {}, {}); ",
+                        SemanticViewsTable(), QuoteLiteral(create_stmt.view_name),
+                        QuoteLiteral(create_stmt.source_table), QuoteLiteral(create_stmt.key_column),
+                        QuoteLiteral(definition.dump()))));
+
+                // Rows whose inputs changed since the last refresh show NULL until the view is refreshed again.
+                // A plain CREATE VIEW fails on a name clash instead of replacing an existing user view.
+                ThrowOnError(con.Query(duckdb_fmt::format(
+                        " CREATE VIEW {} AS "
+                        " SELECT s.*, r.result AS {} "
+                        "   FROM {} AS s "
+                        "   LEFT JOIN {} AS r "
+                        "     ON r.view_name = {} "
+                        "    AND r.row_key = {} "
+                        "    AND r.input_hash = {}; ",
+                        QuoteIdentifier(create_stmt.view_name),
+                        QuoteIdentifier(definition["output_column"].get<std::string>()), create_stmt.source_table,
+                        SemanticViewResultsTable(), QuoteLiteral(create_stmt.view_name),
+                        RowKeyExpression(create_stmt.key_column, "s"), InputHashExpression(definition, "s"))));
+
+                return std::string();
+            });
+
+            // The first refresh runs outside that transaction, so a failure keeps the chunks already computed
+            try {
+                query = RefreshSemanticView(con, create_stmt.view_name);
+            } catch (const std::exception& e) {
+                throw std::runtime_error(duckdb_fmt::format(
+                        "Semantic view '{}' was created but its first refresh failed: {} Run REFRESH SEMANTIC VIEW "
+                        "'{}' to compute the remaining rows.",
+                        create_stmt.view_name, e.what(), create_stmt.view_name));
+            }
+            break;
+        }
+        case StatementType::REFRESH_SEMANTIC_VIEW: {
+            const auto& refresh_stmt = static_cast<const RefreshSemanticViewStatement&>(statement);
+            query = RefreshSemanticView(con, refresh_stmt.view_name);
+            break;
+        }
+        case StatementType::DELETE_SEMANTIC_VIEW: {
+            const auto& delete_stmt = static_cast<const DeleteSemanticViewStatement&>(statement);
+            ThrowOnError(con.Query(duckdb_fmt::format(" DROP VIEW IF EXISTS {}; "
+                                                      " DELETE FROM {} WHERE view_name = {}; "
+                                                      " DELETE FROM {} WHERE view_name = {}; ",
+                                                      QuoteIdentifier(delete_stmt.view_name),
+                                                      SemanticViewResultsTable(), QuoteLiteral(delete_stmt.view_name),
+                                                      SemanticViewsTable(), QuoteLiteral(delete_stmt.view_name))));
+            query = "SELECT 'Semantic view deleted successfully' AS status";
+            break;
+        }
+        case StatementType::GET_SEMANTIC_VIEW: {
+            const auto& get_stmt = static_cast<const GetSemanticViewStatement&>(statement);
+            query = FormatResultsAsValues(con.Query(duckdb_fmt::format(
+                    " SELECT v.view_name, v.source_table, v.key_column, v.definition, v.created_at, "
+                    "        COUNT(r.row_key) AS materialized_rows, MAX(r.refreshed_at) AS last_refreshed_at "
+                    "   FROM {} AS v "
+                    "   LEFT JOIN {} AS r ON r.view_name = v.view_name "
+                    "  WHERE v.view_name = {} "
+                    "  GROUP BY ALL; ",
+                    SemanticViewsTable(), SemanticViewResultsTable(), QuoteLiteral(get_stmt.view_name))));
+            break;
+        }
+        case StatementType::GET_ALL_SEMANTIC_VIEW: {
+            query = FormatResultsAsValues(con.Query(duckdb_fmt::format(
+                    " SELECT v.view_name, v.source_table, v.key_column, v.definition, v.created_at, "
+                    "        COUNT(r.row_key) AS materialized_rows, MAX(r.refreshed_at) AS last_refreshed_at "
+                    "   FROM {} AS v "
+                    "   LEFT JOIN {} AS r ON r.view_name = v.view_name "
+                    "  GROUP BY ALL "
+                    "  ORDER BY v.view_name; ",
+                    SemanticViewsTable(), SemanticViewResultsTable())));
+            break;
+        }
+        default:
+            throw std::runtime_error("Unknown statement type.");
+    }
+
+    return query;
+}
+
+}// namespace flock
@@ -103,7 +103,7 @@ std::string QueryParser::ParseQuery(const std::string& query) {
     auto token = tokenizer.NextToken();
     auto value = duckdb::StringUtil::Upper(token.value);
     if (token.type != TokenType::KEYWORD ||
-        (value != "CREATE" && value != "DELETE" && value != "UPDATE" && value != "GET")) {
+        (value != "CREATE" && value != "DELETE" && value != "UPDATE" && value != "GET" && value != "REFRESH")) {
         throw std::runtime_error(duckdb_fmt::format("Unknown keyword: {}", token.value));
     }
 
@@ -121,6 +121,10 @@ inline std::string QueryParser::ParsePromptOrModel(Tokenizer tokenizer, const st
         PromptParser prompt_parser;
         prompt_parser.Parse(query, statement);
         return prompt_parser.ToSQL(*statement);
+    } else if (token.type == TokenType::KEYWORD && value == "SEMANTIC") {
+        SemanticViewParser semantic_view_parser;
+        semantic_view_parser.Parse(query, statement);
+        return semantic_view_parser.ToSQL(*statement);
     } else if (token.type == TokenType::KEYWORD && (value == "GLOBAL" || value == "LOCAL")) {
         return ParsePromptOrModel(tokenizer, query);
     } else {
@@ -1,5 +1,6 @@
 #include "flock/core/config.hpp"
 #include "flock/functions/aggregate/llm_first_or_last.hpp"
+#include "flock/functions/batch_packer.hpp"
 #include "flock/functions/llm_function_bind_data.hpp"
 #include "flock/metrics/manager.hpp"
 
@@ -87,12 +88,16 @@ nlohmann::json LlmFirstOrLast::Evaluate(nlohmann::json& tuples) {
 
     auto batch_tuples = nlohmann::json::array();
     int start_index = 0;
-    auto batch_size = std::min<int>(model.GetModelDetails().batch_size, num_tuples);
+    auto batch_size = std::min<int>(
+            BatchPacker::LearnedMaxRows(model.GetModelDetails(), "llm_first_or_last", model.GetModelDetails().batch_size),
+            num_tuples);
 
     if (batch_size <= 0) {
         throw std::runtime_error("Batch size must be greater than zero");
     }
 
+    PromptManager::PrefetchTranscriptions(tuples);
+
     do {
         for (auto i = 0; i < static_cast<int>(tuples.size()); i++) {
             if (start_index == 0) {
@@ -131,7 +136,8 @@ nlohmann::json LlmFirstOrLast::Evaluate(nlohmann::json& tuples) {
             }
         } catch (const ExceededMaxOutputTokensError&) {
             start_index -= batch_size;
-            batch_size = static_cast<int>(batch_size * 0.9);
+            BatchPacker::RecordOverflow(model.GetModelDetails(), "llm_first_or_last", batch_size);
+            batch_size /= 2;
             if (batch_size <= 0) {
                 throw std::runtime_error("Batch size reduced to zero, unable to process tuples");
             }
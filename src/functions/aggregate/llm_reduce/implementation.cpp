@@ -1,17 +1,200 @@
+#include "duckdb/main/client_context.hpp"
+#include "duckdb/main/materialized_query_result.hpp"
 #include "flock/core/config.hpp"
 #include "flock/functions/aggregate/llm_reduce.hpp"
+#include "flock/functions/batch_packer.hpp"
+#include "flock/functions/checkpoint_journal.hpp"
 #include "flock/functions/llm_function_bind_data.hpp"
 #include "flock/metrics/manager.hpp"
 
 #include <chrono>
+#include <cstdlib>
+#include <set>
 
 namespace flock {
 
+namespace {
+
+struct StoredReduceState {
+    nlohmann::json summary;
+    LlmReduce::Watermark watermark;
+};
+
+std::string ReduceStateTable() {
+    return "flock_storage.flock_config." + Config::get_reduce_state_table_name();
+}
+
+// The stored summary is only reused for the same model, prompt and aggregate
+std::string ReduceRequestIdentity(const LlmFunctionBindData& bind_data, AggregateFunctionType function_type) {
+    return bind_data.model_json.dump() + "\n" + bind_data.prompt + "\n" +
+           std::to_string(static_cast<int>(function_type));
+}
+
+std::optional<StoredReduceState> LoadReduceState(const std::string& state_key, const std::string& request_identity) {
+    auto con = Config::GetConnection();
+    Config::ExclusiveStorageGuard guard(con, true);
+    auto statement = con.Prepare(duckdb_fmt::format(" SELECT summary, watermark, boundary_rows "
+                                                    "   FROM {} "
+                                                    "  WHERE state_key = $1 AND request_hash = md5($2); ",
+                                                    ReduceStateTable()));
+    auto result = statement->Execute(duckdb::Value(state_key), duckdb::Value(request_identity));
+    auto& materialized_result = result->Cast<duckdb::MaterializedQueryResult>();
+    if (materialized_result.HasError()) {
+        throw std::runtime_error(materialized_result.GetError());
+    }
+    if (materialized_result.RowCount() == 0) {
+        return std::nullopt;
+    }
+    StoredReduceState state;
+    state.summary = nlohmann::json::parse(materialized_result.GetValue(0, 0).ToString());
+    state.watermark.value = materialized_result.GetValue(1, 0).ToString();
+    state.watermark.boundary_rows =
+            nlohmann::json::parse(materialized_result.GetValue(2, 0).ToString()).get<std::vector<std::string>>();
+    return state;
+}
+
+void SaveReduceState(const std::string& state_key, const std::string& request_identity,
+                     const nlohmann::json& summary, const LlmReduce::Watermark& watermark) {
+    auto con = Config::GetConnection();
+    Config::ExclusiveStorageGuard guard(con, false);
+    auto statement = con.Prepare(duckdb_fmt::format(
+            " INSERT OR REPLACE INTO {} "
+            " (state_key, request_hash, summary, watermark, boundary_rows, updated_at) "
+            " VALUES ($1, md5($2), $3, $4, $5, now()); ",
+            ReduceStateTable()));
+    auto result = statement->Execute(duckdb::Value(state_key), duckdb::Value(request_identity),
+                                     duckdb::Value(summary.dump()), duckdb::Value(watermark.value),
+                                     duckdb::Value(nlohmann::json(watermark.boundary_rows).dump()));
+    if (result->HasError()) {
+        throw std::runtime_error(result->GetError());
+    }
+}
+
+std::string JsonToWatermark(const nlohmann::json& value) {
+    // NULL cells are rendered as the string "NULL"; such rows cannot be ordered and are skipped
+    if (value.is_null() || (value.is_string() && value.get<std::string>() == "NULL")) {
+        return "";
+    }
+    return value.is_string() ? value.get<std::string>() : value.dump();
+}
+
+bool ParseNumber(const std::string& value, double& number) {
+    if (value.empty()) {
+        return false;
+    }
+    char* end = nullptr;
+    number = std::strtod(value.c_str(), &end);
+    return end == value.c_str() + value.size();
+}
+
+}// namespace
+
+std::optional<LlmReduce::IncrementalInput> LlmReduce::SplitIncrementalColumns(const nlohmann::json& tuples) {
+    IncrementalInput input;
+    input.tuples = nlohmann::json::array();
+    auto has_watermark = false;
+    auto has_state_key = false;
+
+    for (const auto& column: tuples) {
+        auto name = column.value("name", "");
+        if (name == WATERMARK_COLUMN) {
+            has_watermark = true;
+            for (const auto& value: column["data"]) {
+                input.watermarks.push_back(JsonToWatermark(value));
+            }
+        } else if (name == STATE_KEY_COLUMN) {
+            has_state_key = true;
+            for (const auto& value: column["data"]) {
+                auto state_key = JsonToWatermark(value);
+                if (state_key.empty()) {
+                    throw std::runtime_error(
+                            duckdb_fmt::format("Incremental llm_reduce requires a non-NULL '{}' on every row.",
+                                               STATE_KEY_COLUMN));
+                }
+                if (!input.state_key.empty() && state_key != input.state_key) {
+                    throw std::runtime_error(duckdb_fmt::format(
+                            "Incremental llm_reduce found '{}' values '{}' and '{}' in the same group; "
+                            "use the GROUP BY key as the state key.",
+                            STATE_KEY_COLUMN, input.state_key, state_key));
+                }
+                input.state_key = state_key;
+            }
+        } else {
+            input.tuples.push_back(column);
+        }
+    }
+
+    if (!has_watermark) {
+        return std::nullopt;
+    }
+    // Without a key every group and query would read and overwrite the same stored summary
+    if (!has_state_key) {
+        throw std::runtime_error(duckdb_fmt::format(
+                "Incremental llm_reduce requires a '{}' context column, typically the GROUP BY key.",
+                STATE_KEY_COLUMN));
+    }
+    if (input.tuples.empty()) {
+        throw std::runtime_error(duckdb_fmt::format(
+                "Incremental llm_reduce needs at least one context column besides '{}' and '{}'.",
+                WATERMARK_COLUMN, STATE_KEY_COLUMN));
+    }
+    return input;
+}
+
+int LlmReduce::CompareWatermarks(const std::string& lhs, const std::string& rhs) {
+    double lhs_number, rhs_number;
+    if (ParseNumber(lhs, lhs_number) && ParseNumber(rhs, rhs_number)) {
+        return lhs_number < rhs_number ? -1 : (lhs_number > rhs_number ? 1 : 0);
+    }
+    return lhs.compare(rhs) < 0 ? -1 : (lhs.compare(rhs) > 0 ? 1 : 0);
+}
+
+nlohmann::json LlmReduce::SelectNewRows(const IncrementalInput& input, const Watermark& stored,
+                                        Watermark& max_watermark) {
+    max_watermark = stored;
+    std::set<std::string> boundary_rows(stored.boundary_rows.begin(), stored.boundary_rows.end());
+    auto new_tuples = input.tuples;
+    for (auto& column: new_tuples) {
+        column["data"] = nlohmann::json::array();
+    }
+
+    for (size_t row = 0; row < input.watermarks.size(); row++) {
+        const auto& watermark = input.watermarks[row];
+        if (watermark.empty()) {
+            continue;
+        }
+        auto order = stored.value.empty() ? 1 : CompareWatermarks(watermark, stored.value);
+        if (order < 0) {
+            continue;
+        }
+        // Rows at the stored watermark arrived late unless they were already folded in
+        auto row_hash = CheckpointJournal::RowHash(input.tuples, row);
+        if (order == 0 && boundary_rows.count(row_hash) != 0) {
+            continue;
+        }
+
+        for (size_t col = 0; col < new_tuples.size(); col++) {
+            new_tuples[col]["data"].push_back(input.tuples[col]["data"][row]);
+        }
+        auto max_order = max_watermark.value.empty() ? 1 : CompareWatermarks(watermark, max_watermark.value);
+        if (max_order > 0) {
+            max_watermark.value = watermark;
+            max_watermark.boundary_rows.clear();
+        }
+        if (max_order >= 0) {
+            max_watermark.boundary_rows.push_back(row_hash);
+        }
+    }
+    return new_tuples;
+}
+
 duckdb::unique_ptr<duckdb::FunctionData> LlmReduce::Bind(
         duckdb::ClientContext& context,
         duckdb::AggregateFunction& function,
         duckdb::vector<duckdb::unique_ptr<duckdb::Expression>>& arguments) {
-    return AggregateFunctionBase::ValidateAndInitializeBindData(context, arguments, "llm_reduce");
+    auto bind_data = AggregateFunctionBase::ValidateAndInitializeBindData(context, arguments, "llm_reduce");
+    bind_data->client_context = context.shared_from_this();
+    return std::move(bind_data);
 }
 
 nlohmann::json LlmReduce::ReduceBatch(nlohmann::json& tuples,
@@ -28,17 +211,22 @@ nlohmann::json LlmReduce::ReduceBatch(nlohmann::json& tuples,
 }
 
 nlohmann::json LlmReduce::ReduceLoop(const nlohmann::json& tuples,
-                                     const AggregateFunctionType& function_type) {
+                                     const AggregateFunctionType& function_type,
+                                     const nlohmann::json& initial_summary) {
     auto batch_tuples = nlohmann::json::array();
-    auto summary = nlohmann::json::object({{"Previous Batch Summary", ""}});
+    auto summary = nlohmann::json::object({{"Previous Batch Summary", initial_summary}});
     int start_index = 0;
     int num_tuples = static_cast<int>(tuples[0]["data"].size());
-    auto batch_size = std::min<int>(model.GetModelDetails().batch_size, num_tuples);
+    auto batch_size = std::min<int>(
+            BatchPacker::LearnedMaxRows(model.GetModelDetails(), "llm_reduce", model.GetModelDetails().batch_size),
+            num_tuples);
 
     if (batch_size <= 0) {
         throw std::runtime_error("Batch size must be greater than zero");
     }
 
+    PromptManager::PrefetchTranscriptions(tuples);
+
     do {
         for (auto i = 0; i < static_cast<int>(tuples.size()); i++) {
             batch_tuples.push_back(nlohmann::json::object());
@@ -61,8 +249,9 @@ nlohmann::json LlmReduce::ReduceLoop(const nlohmann::json& tuples,
             batch_tuples.clear();
             summary = nlohmann::json::object({{"Previous Batch Summary", response}});
         } catch (const ExceededMaxOutputTokensError&) {
-            start_index -= batch_size;// Retry the current batch with reduced size
-            batch_size = static_cast<int>(batch_size * 0.9);
+            start_index -= batch_size;// Retry the current batch at half the size
+            BatchPacker::RecordOverflow(model.GetModelDetails(), "llm_reduce", batch_size);
+            batch_size /= 2;
             if (batch_size <= 0) {
                 throw std::runtime_error("Batch size reduced to zero, unable to process tuples");
             }
@@ -88,6 +277,10 @@ void LlmReduce::FinalizeResults(duckdb::Vector& states, duckdb::AggregateInputDa
 
     auto db = Config::db;
     std::vector<const void*> processed_state_ids;
+    auto active_query = duckdb::DConstants::INVALID_INDEX;
+    if (auto context = bind_data.client_context.lock()) {
+        active_query = context->transaction.GetActiveQuery();
+    }
 
     // Process each state individually
     for (idx_t i = 0; i < count; i++) {
@@ -112,13 +305,35 @@ void LlmReduce::FinalizeResults(duckdb::Vector& states, duckdb::AggregateInputDa
         LlmReduce reduce_instance;
         reduce_instance.model = bind_data.CreateModel();
         reduce_instance.user_query = bind_data.prompt;
-        auto response = reduce_instance.ReduceLoop(*state->value, function_type);
+        nlohmann::json response;
+        if (auto incremental = SplitIncrementalColumns(*state->value)) {
+            if (!bind_data.reduce_state_claims->Claim(active_query, incremental->state_key)) {
+                throw std::runtime_error(duckdb_fmt::format(
+                        "Incremental llm_reduce found '{}' value '{}' in more than one group.", STATE_KEY_COLUMN,
+                        incremental->state_key));
+            }
+            auto request_identity = ReduceRequestIdentity(bind_data, function_type);
+            auto stored = LoadReduceState(incremental->state_key, request_identity);
+            Watermark max_watermark;
+            auto new_tuples = SelectNewRows(*incremental, stored ? stored->watermark : Watermark{}, max_watermark);
+            if (new_tuples[0]["data"].empty()) {
+                response = stored ? stored->summary : nlohmann::json(nullptr);
+            } else {
+                response = reduce_instance.ReduceLoop(new_tuples, function_type,
+                                                      stored ? stored->summary : nlohmann::json(""));
+                SaveReduceState(incremental->state_key, request_identity, response, max_watermark);
+            }
+        } else {
+            response = reduce_instance.ReduceLoop(*state->value, function_type);
+        }
 
         auto exec_end = std::chrono::high_resolution_clock::now();
         double exec_duration_ms = std::chrono::duration<double, std::milli>(exec_end - exec_start).count();
         MetricsManager::AddExecutionTime(exec_duration_ms);
 
-        if (response.is_string()) {
+        if (response.is_null()) {
+            result.SetValue(result_idx, nullptr);
+        } else if (response.is_string()) {
             result.SetValue(result_idx, response.get<std::string>());
         } else {
             result.SetValue(result_idx, response.dump());
@@ -1,5 +1,6 @@
 #include "flock/core/config.hpp"
 #include "flock/functions/aggregate/llm_rerank.hpp"
+#include "flock/functions/batch_packer.hpp"
 #include "flock/functions/llm_function_bind_data.hpp"
 #include "flock/metrics/manager.hpp"
 
@@ -114,10 +115,14 @@ nlohmann::json LlmRerank::SlidingWindow(nlohmann::json& tuples) {
         batch_size = std::min<int>(batch_size, num_tuples);
     }
 
+    batch_size = BatchPacker::LearnedMaxRows(model.GetModelDetails(), "llm_rerank", batch_size);
+
     if (batch_size <= 0) {
         throw std::runtime_error("Batch size must be greater than zero");
     }
 
+    PromptManager::PrefetchTranscriptions(tuples);
+
     while (start_index < num_tuples || !carry_forward_tuples.empty()) {
         auto window_tuples = carry_forward_tuples;
 
@@ -225,8 +230,9 @@ nlohmann::json LlmRerank::SlidingWindow(nlohmann::json& tuples) {
             }
 
         } catch (const ExceededMaxOutputTokensError&) {
-            // Retry the current batch with reduced size
-            batch_size = static_cast<int>(batch_size * 0.9);
+            // Retry the current batch at half the size
+            BatchPacker::RecordOverflow(model.GetModelDetails(), "llm_rerank", batch_size);
+            batch_size /= 2;
             if (batch_size <= 0) {
                 throw std::runtime_error("Batch size reduced to zero, unable to process tuples");
             }
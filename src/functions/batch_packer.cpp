@@ -0,0 +1,196 @@
+#include "flock/functions/batch_packer.hpp"
+#include "flock/model_manager/output_budget.hpp"
+#include "flock/model_manager/tokenizer.hpp"
+
+#include <algorithm>
+#include <mutex>
+#include <numeric>
+#include <unordered_map>
+
+namespace flock {
+
+namespace {
+
+std::mutex learned_max_rows_mutex;
+std::unordered_map<std::string, int> learned_max_rows;
+
+std::string LearnedMaxRowsKey(const ModelDetails& model_details, const std::string& function) {
+    return model_details.provider_name + "/" + model_details.model + "/" + function;
+}
+
+OutputType DefaultItemType(const ScalarFunctionType function_type) {
+    switch (function_type) {
+        case ScalarFunctionType::FILTER:
+            return OutputType::BOOL;
+        case ScalarFunctionType::CLASSIFY:
+            return OutputType::INTEGER;
+        default:
+            return OutputType::STRING;
+    }
+}
+
+// Requests whose items follow a schema of another type (e.g. the cascade's answer and confidence) learn their own
+// limit, so an overflow there does not shrink the plain batches of the same function
+std::string ScalarFunctionName(const ModelDetails& model_details, const ScalarFunctionType function_type) {
+    std::string name;
+    switch (function_type) {
+        case ScalarFunctionType::FILTER:
+            name = "llm_filter";
+            break;
+        case ScalarFunctionType::CLASSIFY:
+            name = "llm_classify";
+            break;
+        default:
+            name = "llm_complete";
+    }
+    const auto default_type = DefaultItemType(function_type);
+    const auto item_type = OutputBudget::RequestItemType(model_details.model_parameters, default_type);
+    return item_type == default_type ? name : name + "/" + IProvider::GetOutputTypeString(item_type);
+}
+
+}// namespace
+
+int64_t BatchPacker::EstimateTokens(const std::string& text, const std::string& model) {
+    return model.empty() ? TokenCounter::Approximate(text) : TokenCounter::Count(model, text);
+}
+
+std::vector<int64_t> BatchPacker::EstimateRowTokens(const nlohmann::json& tuples, const std::string& model) {
+    const auto num_rows = tuples.empty() ? 0 : tuples[0]["data"].size();
+    std::vector<int64_t> row_tokens(num_rows, 0);
+    for (const auto& column: tuples) {
+        const auto& data = column["data"];
+        for (size_t row = 0; row < num_rows && row < data.size(); row++) {
+            const auto& value = data[row];
+            row_tokens[row] += CELL_OVERHEAD_TOKENS + EstimateTokens(value.is_string() ? value.get<std::string>() : value.dump(), model);
+        }
+    }
+    return row_tokens;
+}
+
+int64_t BatchPacker::ContextWindow(const ModelDetails& model_details) {
+    const auto& parameters = model_details.model_parameters;
+    switch (GetProviderType(model_details.provider_name)) {
+        case FLOCKMTL_OLLAMA:
+            if (parameters.contains("options") && parameters["options"].contains("num_ctx") &&
+                parameters["options"]["num_ctx"].is_number_integer()) {
+                return parameters["options"]["num_ctx"].get<int64_t>();
+            }
+            return 4096;
+        case FLOCKMTL_ANTHROPIC:
+            return 200000;
+        default:
+            return 128000;
+    }
+}
+
+int64_t BatchPacker::MaxOutputTokens(const ModelDetails& model_details) {
+    const auto& parameters = model_details.model_parameters;
+    for (const auto* key: {"max_completion_tokens", "max_output_tokens", "max_tokens"}) {
+        if (parameters.contains(key) && parameters[key].is_number_integer()) {
+            return parameters[key].get<int64_t>();
+        }
+    }
+    if (parameters.contains("options") && parameters["options"].contains("num_predict") &&
+        parameters["options"]["num_predict"].is_number_integer() &&
+        parameters["options"]["num_predict"].get<int64_t>() > 0) {
+        return parameters["options"]["num_predict"].get<int64_t>();
+    }
+    return DEFAULT_MAX_OUTPUT_TOKENS;
+}
+
+PackingBudget BatchPacker::Budget(const ModelDetails& model_details, const std::string& user_prompt,
+                                  const ScalarFunctionType function_type) {
+    PackingBudget budget;
+    // In latency mode every tuple is a request of its own
+    budget.max_rows = model_details.execution_mode == ExecutionMode::LATENCY
+                              ? 1
+                              : LearnedMaxRows(model_details, function_type, model_details.batch_size);
+    budget.max_output_tokens = MaxOutputTokens(model_details);
+    // The answers are reserved per packed row rather than at the full output cap, which alone fills a default
+    // Ollama context window
+    budget.max_input_tokens = std::max<int64_t>(ContextWindow(model_details) - PROMPT_OVERHEAD_TOKENS -
+                                                        EstimateTokens(user_prompt, model_details.model),
+                                                1);
+    // Rows are budgeted by the items they return, which follow the model's schema when it sets one; strings and
+    // objects take as many output tokens per row as observed for the model so far
+    const auto item_type =
+            OutputBudget::RequestItemType(model_details.model_parameters, DefaultItemType(function_type));
+    switch (item_type) {
+        case OutputType::BOOL:
+            budget.output_tokens_per_row = FILTER_OUTPUT_TOKENS_PER_ROW;
+            break;
+        case OutputType::INTEGER:
+            budget.output_tokens_per_row = OutputBudget::INTEGER_ITEM_TOKENS;
+            break;
+        default:
+            budget.output_tokens_per_row = OutputBudget::ItemTokens(model_details.model, item_type)
+                                                   .value_or(COMPLETE_OUTPUT_TOKENS_PER_ROW);
+    }
+    return budget;
+}
+
+int BatchPacker::LearnedMaxRows(const ModelDetails& model_details, const std::string& function, const int max_rows) {
+    std::lock_guard<std::mutex> lock(learned_max_rows_mutex);
+    const auto it = learned_max_rows.find(LearnedMaxRowsKey(model_details, function));
+    return it == learned_max_rows.end() ? max_rows : std::min(max_rows, it->second);
+}
+
+void BatchPacker::RecordOverflow(const ModelDetails& model_details, const std::string& function, const int rows) {
+    const auto limit = std::max(rows / 2, 1);
+    std::lock_guard<std::mutex> lock(learned_max_rows_mutex);
+    auto [it, inserted] = learned_max_rows.emplace(LearnedMaxRowsKey(model_details, function), limit);
+    if (!inserted) {
+        it->second = std::min(it->second, limit);
+    }
+}
+
+int BatchPacker::LearnedMaxRows(const ModelDetails& model_details, const ScalarFunctionType function_type,
+                                const int max_rows) {
+    return LearnedMaxRows(model_details, ScalarFunctionName(model_details, function_type), max_rows);
+}
+
+void BatchPacker::RecordOverflow(const ModelDetails& model_details, const ScalarFunctionType function_type,
+                                 const int rows) {
+    RecordOverflow(model_details, ScalarFunctionName(model_details, function_type), rows);
+}
+
+void BatchPacker::ClearLearnedMaxRows() {
+    std::lock_guard<std::mutex> lock(learned_max_rows_mutex);
+    learned_max_rows.clear();
+}
+
+std::vector<std::vector<size_t>> BatchPacker::Pack(const std::vector<int64_t>& row_tokens, const PackingBudget& budget) {
+    if (budget.max_rows <= 0) {
+        throw std::runtime_error("Batch size must be greater than zero");
+    }
+
+    std::vector<size_t> order(row_tokens.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return row_tokens[a] < row_tokens[b]; });
+
+    std::vector<std::vector<size_t>> batches;
+    std::vector<size_t> batch;
+    int64_t input_tokens = 0;
+    for (const auto row: order) {
+        const auto output_tokens = static_cast<int64_t>(batch.size() + 1) * budget.output_tokens_per_row;
+        const auto fits = static_cast<int>(batch.size()) < budget.max_rows &&
+                          input_tokens + row_tokens[row] + output_tokens <= budget.max_input_tokens &&
+                          output_tokens <= budget.max_output_tokens;
+        // A row that exceeds the budget on its own still gets a request of its own
+        if (!fits && !batch.empty()) {
+            std::sort(batch.begin(), batch.end());
+            batches.push_back(std::move(batch));
+            batch.clear();
+            input_tokens = 0;
+        }
+        batch.push_back(row);
+        input_tokens += row_tokens[row];
+    }
+    if (!batch.empty()) {
+        std::sort(batch.begin(), batch.end());
+        batches.push_back(std::move(batch));
+    }
+    return batches;
+}
+
+}// namespace flock
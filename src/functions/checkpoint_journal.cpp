@@ -0,0 +1,101 @@
+#include "flock/functions/checkpoint_journal.hpp"
+
+#include "duckdb/common/crypto/md5.hpp"
+#include "duckdb/main/materialized_query_result.hpp"
+#include "flock/core/config.hpp"
+
+namespace flock {
+
+namespace {
+
+std::string Md5Hex(const std::string& input) {
+    duckdb::MD5Context context;
+    context.Add(input);
+    return context.FinishHex();
+}
+
+std::string CheckpointTable() { return "flock_storage.flock_config." + Config::get_checkpoint_table_name(); }
+
+duckdb::Value ToVarcharList(const std::vector<std::string>& values) {
+    duckdb::vector<duckdb::Value> list_values;
+    list_values.reserve(values.size());
+    for (const auto& value: values) {
+        list_values.emplace_back(value);
+    }
+    return duckdb::Value::LIST(duckdb::LogicalType::VARCHAR, std::move(list_values));
+}
+
+}// namespace
+
+std::string CheckpointJournal::RequestHash(const nlohmann::json& model_json, const std::string& prompt,
+                                           ScalarFunctionType function_type) {
+    // Rotating a secret must not invalidate the journal
+    auto model_identity = model_json;
+    model_identity.erase("secret");
+    return Md5Hex(model_identity.dump() + "\n" + prompt + "\n" + std::to_string(static_cast<int>(function_type)));
+}
+
+std::string CheckpointJournal::RowHash(const nlohmann::json& columns, size_t row) {
+    auto row_identity = nlohmann::json::array();
+    for (const auto& column: columns) {
+        auto cell = nlohmann::json::object();
+        for (const auto& item: column.items()) {
+            cell[item.key()] = item.key() == "data" ? item.value()[row] : item.value();
+        }
+        row_identity.push_back(cell);
+    }
+    return Md5Hex(row_identity.dump());
+}
+
+std::unordered_map<std::string, nlohmann::json> CheckpointJournal::Load(const std::string& request_hash,
+                                                                        const std::vector<std::string>& row_hashes) {
+    std::unordered_map<std::string, nlohmann::json> results;
+    if (row_hashes.empty()) {
+        return results;
+    }
+
+    auto con = Config::GetConnection();
+    Config::ExclusiveStorageGuard guard(con, true);
+    auto statement = con.Prepare(duckdb_fmt::format(" SELECT row_hash, result "
+                                                    "   FROM {} "
+                                                    "  WHERE request_hash = $1 "
+                                                    "    AND list_contains($2::VARCHAR[], row_hash); ",
+                                                    CheckpointTable()));
+    auto query_result = statement->Execute(duckdb::Value(request_hash), ToVarcharList(row_hashes));
+    auto& materialized_result = query_result->Cast<duckdb::MaterializedQueryResult>();
+    if (materialized_result.HasError()) {
+        throw std::runtime_error(materialized_result.GetError());
+    }
+    for (idx_t row = 0; row < materialized_result.RowCount(); row++) {
+        results[materialized_result.GetValue(0, row).ToString()] =
+                nlohmann::json::parse(materialized_result.GetValue(1, row).ToString());
+    }
+    return results;
+}
+
+void CheckpointJournal::Append(const std::string& request_hash, const std::vector<std::string>& row_hashes,
+                               const nlohmann::json& results) {
+    std::vector<std::string> hashes;
+    std::vector<std::string> values;
+    for (size_t i = 0; i < row_hashes.size() && i < results.size(); i++) {
+        if (!results[i].is_null()) {
+            hashes.push_back(row_hashes[i]);
+            values.push_back(results[i].dump());
+        }
+    }
+    if (hashes.empty()) {
+        return;
+    }
+
+    auto con = Config::GetConnection();
+    Config::ExclusiveStorageGuard guard(con, false);
+    auto statement = con.Prepare(duckdb_fmt::format(" INSERT OR REPLACE INTO {} (request_hash, row_hash, result) "
+                                                    " SELECT $1, unnest($2::VARCHAR[]), unnest($3::VARCHAR[]); ",
+                                                    CheckpointTable()));
+    auto query_result = statement->Execute(duckdb::Value(request_hash), ToVarcharList(hashes), ToVarcharList(values));
+    if (query_result->HasError()) {
+        throw std::runtime_error(query_result->GetError());
+    }
+}
+
+}// namespace flock
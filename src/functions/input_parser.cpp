@@ -1,6 +1,8 @@
 #include "flock/functions/input_parser.hpp"
 
 #include "duckdb/common/operator/cast_operators.hpp"
+#include "duckdb/common/vector_operations/vector_operations.hpp"
+#include <optional>
 
 namespace flock {
 
@@ -38,53 +40,136 @@ static void ValidateAndCleanContextColumn(nlohmann::json& column, const std::ini
     }
 }
 
-nlohmann::json CastVectorOfStructsToJson(const duckdb::Vector& struct_vector, const int size) {
-    nlohmann::json struct_json;
+// Read access to a vector as text. Non-text vectors are cast once per chunk, which prints every cell the way
+// Value::ToString would, and text vectors are read from their string_t payload directly. NULL cells become JSON null.
+class TextVectorReader {
+public:
+    TextVectorReader(duckdb::Vector& vector, const duckdb::idx_t count) {
+        auto* source = &vector;
+        if (vector.GetType().id() != duckdb::LogicalTypeId::VARCHAR) {
+            cast_ = duckdb::make_uniq<duckdb::Vector>(duckdb::LogicalType::VARCHAR, count);
+            duckdb::VectorOperations::DefaultCast(vector, *cast_, count);
+            source = cast_.get();
+        }
+        source->ToUnifiedFormat(count, format_);
+        values_ = duckdb::UnifiedVectorFormat::GetData<duckdb::string_t>(format_);
+    }
 
-    for (auto i = 0; i < size; i++) {
-        for (auto j = 0; j < static_cast<int>(duckdb::StructType::GetChildCount(struct_vector.GetType())); j++) {
-            const auto key = duckdb::StructType::GetChildName(struct_vector.GetType(), j);
-            auto value = duckdb::StructValue::GetChildren(struct_vector.GetValue(i))[j];
-            if (key == "context_columns") {
-                if (value.GetTypeMutable().id() != duckdb::LogicalTypeId::LIST) {
-                    throw std::runtime_error("Expected 'context_columns' to be a list.");
-                }
+    void Append(const duckdb::idx_t row, nlohmann::json& data) const {
+        const auto idx = format_.sel->get_index(row);
+        if (!format_.validity.RowIsValid(idx)) {
+            data.push_back(nullptr);
+            return;
+        }
+        data.push_back(std::string(values_[idx].GetData(), values_[idx].GetSize()));
+    }
 
-                auto context_columns = duckdb::ListValue::GetChildren(value);
-                for (auto context_column_idx = 0; context_column_idx < static_cast<int>(context_columns.size()); context_column_idx++) {
-                    auto context_column = context_columns[context_column_idx];
-                    auto context_column_json = CastVectorOfStructsToJson(duckdb::Vector(context_column), 1);
-                    auto allowed_keys = {"name", "data", "type", "detail", "transcription_model"};
-                    for (const auto& key: context_column_json.items()) {
-                        if (std::find(std::begin(allowed_keys), std::end(allowed_keys), key.key()) == std::end(allowed_keys)) {
-                            throw std::runtime_error(duckdb_fmt::format("Unexpected key in 'context_columns': {}", key.key()));
-                        }
-                    }
-
-                    auto required_keys = {"data"};
-                    for (const auto& key: required_keys) {
-                        if (!context_column_json.contains(key)) {
-                            throw std::runtime_error(duckdb_fmt::format("Expected 'context_columns' to contain key: {}", key));
-                        }
-                    }
-
-                    if (struct_json.contains("context_columns") && struct_json["context_columns"].size() == context_columns.size()) {
-                        struct_json["context_columns"][context_column_idx]["data"].push_back(context_column_json["data"]);
-                    } else {
-                        struct_json["context_columns"].push_back(context_column_json);
-                        ValidateAndCleanContextColumn(struct_json["context_columns"][context_column_idx], allowed_keys);
-                        struct_json["context_columns"][context_column_idx]["data"] = nlohmann::json::array();
-                        struct_json["context_columns"][context_column_idx]["data"].push_back(context_column_json["data"]);
-                    }
-                }
-            } else if (key == "batch_size") {
-                if (value.GetTypeMutable() != duckdb::LogicalType::INTEGER) {
-                    throw std::runtime_error("Expected 'batch_size' to be an integer.");
-                }
-                struct_json[key] = value.GetValue<int>();
-            } else {
-                struct_json[key] = value.ToString();
+private:
+    duckdb::unique_ptr<duckdb::Vector> cast_;
+    duckdb::UnifiedVectorFormat format_;
+    const duckdb::string_t* values_ = nullptr;
+};
+
+void AppendVectorAsStrings(duckdb::Vector& vector, const duckdb::idx_t count, nlohmann::json& data) {
+    const TextVectorReader reader(vector, count);
+    for (duckdb::idx_t row = 0; row < count; row++) {
+        reader.Append(row, data);
+    }
+}
+
+// Every row holds the same list of context column structs. Their metadata is taken from the first row and
+// validated once, then the data of each row is appended column by column.
+static void CastContextColumnsToJson(duckdb::Vector& list_vector, const duckdb::idx_t count, nlohmann::json& context_columns) {
+    const auto& column_type = duckdb::ListType::GetChildType(list_vector.GetType());
+    if (column_type.id() != duckdb::LogicalTypeId::STRUCT) {
+        throw std::runtime_error("Expected 'context_columns' to be a list of structs.");
+    }
+
+    auto allowed_keys = {"name", "data", "type", "detail", "transcription_model"};
+    std::optional<duckdb::idx_t> data_field;
+    const auto field_count = duckdb::StructType::GetChildCount(column_type);
+    for (duckdb::idx_t f = 0; f < field_count; f++) {
+        const auto& key = duckdb::StructType::GetChildName(column_type, f);
+        if (std::find(std::begin(allowed_keys), std::end(allowed_keys), key) == std::end(allowed_keys)) {
+            throw std::runtime_error(duckdb_fmt::format("Unexpected key in 'context_columns': {}", key));
+        }
+        if (key == "data") {
+            data_field = f;
+        }
+    }
+    if (!data_field) {
+        throw std::runtime_error("Expected 'context_columns' to contain key: data");
+    }
+
+    duckdb::UnifiedVectorFormat list_format;
+    list_vector.ToUnifiedFormat(count, list_format);
+    const auto lists = duckdb::UnifiedVectorFormat::GetData<duckdb::list_entry_t>(list_format);
+    const auto list_size = duckdb::ListVector::GetListSize(list_vector);
+
+    duckdb::Vector columns(duckdb::ListVector::GetEntry(list_vector));
+    columns.Flatten(list_size);
+    auto& fields = duckdb::StructVector::GetEntries(columns);
+
+    const auto first_idx = list_format.sel->get_index(0);
+    const auto width = list_format.validity.RowIsValid(first_idx) ? lists[first_idx].length : 0;
+    for (duckdb::idx_t c = 0; c < width; c++) {
+        auto column = nlohmann::json::object();
+        for (duckdb::idx_t f = 0; f < field_count; f++) {
+            if (f != *data_field) {
+                column[duckdb::StructType::GetChildName(column_type, f)] =
+                        fields[f]->GetValue(lists[first_idx].offset + c).ToString();
+            }
+        }
+        ValidateAndCleanContextColumn(column, allowed_keys);
+        column["data"] = nlohmann::json::array();
+        context_columns.push_back(std::move(column));
+    }
+
+    const TextVectorReader data(*fields[*data_field], list_size);
+    for (duckdb::idx_t i = 0; i < count; i++) {
+        const auto idx = list_format.sel->get_index(i);
+        const auto length = list_format.validity.RowIsValid(idx) ? lists[idx].length : 0;
+        if (length != width) {
+            throw std::runtime_error("Expected every row to have the same number of 'context_columns'.");
+        }
+        for (duckdb::idx_t c = 0; c < width; c++) {
+            data.Append(lists[idx].offset + c, context_columns[c]["data"]);
+        }
+    }
+}
+
+nlohmann::json CastVectorOfStructsToJson(duckdb::Vector& struct_vector, const int size) {
+    nlohmann::json struct_json;
+    if (size <= 0) {
+        return struct_json;
+    }
+    const auto count = static_cast<duckdb::idx_t>(size);
+
+    duckdb::Vector input(struct_vector);
+    input.Flatten(count);
+    const auto& struct_type = input.GetType();
+    auto& entries = duckdb::StructVector::GetEntries(input);
+
+    for (duckdb::idx_t j = 0; j < duckdb::StructType::GetChildCount(struct_type); j++) {
+        const auto& key = duckdb::StructType::GetChildName(struct_type, j);
+        auto& child = *entries[j];
+        if (key == "context_columns") {
+            if (child.GetType().id() != duckdb::LogicalTypeId::LIST) {
+                throw std::runtime_error("Expected 'context_columns' to be a list.");
+            }
+            auto context_columns = nlohmann::json::array();
+            CastContextColumnsToJson(child, count, context_columns);
+            if (!context_columns.empty()) {
+                struct_json[key] = std::move(context_columns);
+            }
+        } else if (key == "batch_size") {
+            if (child.GetType() != duckdb::LogicalType::INTEGER) {
+                throw std::runtime_error("Expected 'batch_size' to be an integer.");
             }
+            // Options are constant across the chunk, so they are read from the first row
+            struct_json[key] = child.GetValue(0).GetValue<int>();
+        } else {
+            struct_json[key] = child.GetValue(0).ToString();
         }
     }
     return struct_json;
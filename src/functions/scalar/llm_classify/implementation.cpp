@@ -0,0 +1,228 @@
+#include "duckdb/planner/expression/bound_function_expression.hpp"
+#include "flock/functions/scalar/llm_classify.hpp"
+#include "flock/functions/scalar/scalar.hpp"
+#include "flock/metrics/manager.hpp"
+#include "flock/model_manager/model.hpp"
+#include <algorithm>
+#include <cctype>
+
+namespace flock {
+
+namespace {
+
+// ENUM values are stored as their index in the smallest unsigned type that holds every label
+template<typename T>
+void WriteLabels(const std::vector<std::optional<idx_t>>& results, duckdb::Vector& result, const idx_t count) {
+    if (results.size() == 1) {
+        result.SetVectorType(duckdb::VectorType::CONSTANT_VECTOR);
+        if (results[0].has_value()) {
+            duckdb::ConstantVector::GetData<T>(result)[0] = static_cast<T>(*results[0]);
+        } else {
+            duckdb::ConstantVector::SetNull(result, true);
+        }
+        return;
+    }
+
+    result.SetVectorType(duckdb::VectorType::FLAT_VECTOR);
+    auto data = duckdb::FlatVector::GetData<T>(result);
+    auto& validity = duckdb::FlatVector::Validity(result);
+    for (idx_t i = 0; i < count; i++) {
+        if (i < results.size() && results[i].has_value()) {
+            data[i] = static_cast<T>(*results[i]);
+        } else {
+            validity.SetInvalid(i);
+        }
+    }
+}
+
+}// namespace
+
+duckdb::unique_ptr<duckdb::FunctionData> LlmClassify::Bind(
+        duckdb::ClientContext& context,
+        duckdb::ScalarFunction& bound_function,
+        duckdb::vector<duckdb::unique_ptr<duckdb::Expression>>& arguments) {
+    if (arguments.size() != 3) {
+        throw duckdb::BinderException(
+                "llm_classify requires 3 arguments: (1) model, (2) prompt with context_columns, (3) labels. Got " +
+                std::to_string(arguments.size()));
+    }
+    if (!arguments[2]->IsFoldable()) {
+        throw duckdb::BinderException("llm_classify: Third argument must be a constant list of labels");
+    }
+
+    const auto labels_value = duckdb::ExpressionExecutor::EvaluateScalar(context, *arguments[2]);
+    std::vector<std::string> labels;
+    if (!labels_value.IsNull()) {
+        for (const auto& label: duckdb::ListValue::GetChildren(labels_value)) {
+            if (label.IsNull() || label.ToString().empty()) {
+                throw duckdb::BinderException("llm_classify: Labels cannot be NULL or empty");
+            }
+            if (std::find(labels.begin(), labels.end(), label.ToString()) != labels.end()) {
+                throw duckdb::BinderException(duckdb_fmt::format("llm_classify: Duplicate label '{}'", label.ToString()));
+            }
+            labels.push_back(label.ToString());
+        }
+    }
+    if (labels.empty()) {
+        throw duckdb::BinderException("llm_classify: At least one label is required");
+    }
+    // The labels live in the bind data from here on
+    duckdb::Function::EraseArgument(bound_function, arguments, 2);
+
+    auto bind_data = ScalarFunctionBase::ValidateAndInitializeBindData(context, arguments, "llm_classify", false);
+    if (bind_data->logprobs) {
+        throw duckdb::BinderException("llm_classify: 'logprobs' is only supported by llm_filter");
+    }
+    if (bind_data->HasCascade()) {
+        throw duckdb::BinderException("llm_classify: 'cascade' is only supported by llm_complete and llm_filter");
+    }
+    if (HasItemSchema(bind_data->model_json)) {
+        throw duckdb::BinderException("llm_classify: The labels are the output schema, so the model cannot set its own");
+    }
+    if (bind_data->empty_value &&
+        (!bind_data->empty_value->is_string() ||
+         std::find(labels.begin(), labels.end(), bind_data->empty_value->get<std::string>()) == labels.end())) {
+        throw duckdb::BinderException("llm_classify: 'empty_value' must be one of the labels");
+    }
+
+    if (!bind_data->model_json.is_null()) {
+        SetItemSchema(bind_data->model_json, LabelSchema(labels.size()));
+    }
+    bind_data->prompt = LabeledPrompt(bind_data->prompt, labels);
+
+    duckdb::Vector enum_labels(duckdb::LogicalType::VARCHAR, labels.size());
+    auto enum_data = duckdb::FlatVector::GetData<duckdb::string_t>(enum_labels);
+    for (idx_t i = 0; i < labels.size(); i++) {
+        enum_data[i] = duckdb::StringVector::AddString(enum_labels, labels[i]);
+    }
+    bound_function.return_type = duckdb::LogicalType::ENUM(enum_labels, labels.size());
+    bind_data->labels = std::move(labels);
+
+    return std::move(bind_data);
+}
+
+void LlmClassify::ValidateArguments(duckdb::DataChunk& args) {
+    if (args.ColumnCount() != 2) {
+        throw std::runtime_error("Invalid number of arguments.");
+    }
+    if (args.data[0].GetType().id() != duckdb::LogicalTypeId::STRUCT) {
+        throw std::runtime_error("Model details must be a struct.");
+    }
+    if (args.data[1].GetType().id() != duckdb::LogicalTypeId::STRUCT) {
+        throw std::runtime_error("Prompt details must be a struct.");
+    }
+}
+
+nlohmann::json LlmClassify::LabelSchema(const size_t label_count) {
+    auto indexes = nlohmann::json::array();
+    for (size_t i = 0; i < label_count; i++) {
+        indexes.push_back(i);
+    }
+    return {{"type", "integer"}, {"enum", indexes}};
+}
+
+std::string LlmClassify::LabeledPrompt(const std::string& prompt, const std::vector<std::string>& labels) {
+    auto labeled_prompt = prompt + "\n\nLabels:";
+    for (size_t i = 0; i < labels.size(); i++) {
+        labeled_prompt += duckdb_fmt::format("\n{}: {}", i, labels[i]);
+    }
+    return labeled_prompt;
+}
+
+std::optional<idx_t> LlmClassify::ParseLabel(const nlohmann::json& response, const std::vector<std::string>& labels) {
+    if (response.is_number_integer()) {
+        const auto index = response.get<int64_t>();
+        if (index >= 0 && static_cast<size_t>(index) < labels.size()) {
+            return static_cast<idx_t>(index);
+        }
+        return std::nullopt;
+    }
+    if (!response.is_string()) {
+        return std::nullopt;
+    }
+
+    auto label = response.get<std::string>();
+    duckdb::StringUtil::Trim(label);
+    for (idx_t i = 0; i < labels.size(); i++) {
+        if (duckdb::StringUtil::CIEquals(label, labels[i])) {
+            return i;
+        }
+    }
+    if (!label.empty() && label.size() < 10 && std::all_of(label.begin(), label.end(),
+                                                            [](unsigned char c) { return std::isdigit(c); })) {
+        const auto index = std::stoul(label);
+        if (index < labels.size()) {
+            return static_cast<idx_t>(index);
+        }
+    }
+    return std::nullopt;
+}
+
+std::vector<std::optional<idx_t>> LlmClassify::Operation(duckdb::DataChunk& args, LlmFunctionBindData* bind_data) {
+    auto prompt_context_json = CastVectorOfStructsToJson(args.data[1], args.size());
+    auto context_columns = nlohmann::json::array();
+    if (prompt_context_json.contains("context_columns")) {
+        context_columns = prompt_context_json["context_columns"];
+    }
+    return Operation(context_columns, bind_data);
+}
+
+std::vector<std::optional<idx_t>> LlmClassify::Operation(const nlohmann::json& context_columns,
+                                                         const LlmFunctionBindData* bind_data) {
+    Model model = bind_data->CreateModel();
+
+    auto model_details = model.GetModelDetails();
+    MetricsManager::SetModelInfo(model_details.model_name, model_details.provider_name);
+
+    const auto& labels = bind_data->labels;
+    std::vector<std::optional<idx_t>> results;
+    if (context_columns.empty()) {
+        results.push_back(ParseLabel(CompleteWithoutContext(bind_data->prompt, OutputType::INTEGER, model, *bind_data),
+                                     labels));
+    } else {
+        // Rows without any context keep the configured empty value and are not sent to the model
+        auto [rows, responses] = CompleteRowsWithContext(context_columns, bind_data->prompt,
+                                                         ScalarFunctionType::CLASSIFY, model, *bind_data);
+        const auto empty_label = bind_data->empty_value ? ParseLabel(*bind_data->empty_value, labels) : std::nullopt;
+        results.assign(context_columns[0]["data"].size(), empty_label);
+        for (size_t i = 0; i < rows.size(); i++) {
+            results[rows[i]] = ParseLabel(responses[i], labels);
+        }
+    }
+    return results;
+}
+
+void LlmClassify::Execute(duckdb::DataChunk& args, duckdb::ExpressionState& state, duckdb::Vector& result) {
+    auto& context = state.GetContext();
+    auto* db = context.db.get();
+    const void* invocation_id = MetricsManager::GenerateUniqueId();
+
+    MetricsManager::StartInvocation(db, invocation_id, FunctionType::LLM_CLASSIFY);
+
+    auto exec_start = std::chrono::high_resolution_clock::now();
+
+    auto& func_expr = state.expr.Cast<duckdb::BoundFunctionExpression>();
+    auto* bind_data = &func_expr.bind_info->Cast<LlmFunctionBindData>();
+    bind_data->constant_response->BeginQuery(context.transaction.GetActiveQuery());
+
+    const auto results = LlmClassify::Operation(args, bind_data);
+    switch (result.GetType().InternalType()) {
+        case duckdb::PhysicalType::UINT8:
+            WriteLabels<uint8_t>(results, result, args.size());
+            break;
+        case duckdb::PhysicalType::UINT16:
+            WriteLabels<uint16_t>(results, result, args.size());
+            break;
+        case duckdb::PhysicalType::UINT32:
+            WriteLabels<uint32_t>(results, result, args.size());
+            break;
+        default:
+            throw std::runtime_error("llm_classify: Unsupported ENUM size");
+    }
+
+    auto exec_end = std::chrono::high_resolution_clock::now();
+    double exec_duration_ms = std::chrono::duration<double, std::milli>(exec_end - exec_start).count();
+    MetricsManager::AddExecutionTime(exec_duration_ms);
+}
+
+}// namespace flock
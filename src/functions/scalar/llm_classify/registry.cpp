@@ -0,0 +1,15 @@
+#include "flock/registry/registry.hpp"
+#include "flock/functions/scalar/llm_classify.hpp"
+
+namespace flock {
+
+void ScalarRegistry::RegisterLlmClassify(duckdb::ExtensionLoader& loader) {
+    // The ENUM of the labels is set as the return type at bind
+    loader.RegisterFunction(duckdb::ScalarFunction("llm_classify",
+                                                   {duckdb::LogicalType::ANY, duckdb::LogicalType::ANY,
+                                                    duckdb::LogicalType::LIST(duckdb::LogicalType::VARCHAR)},
+                                                   duckdb::LogicalType::VARCHAR, LlmClassify::Execute,
+                                                   LlmClassify::Bind));
+}
+
+}// namespace flock
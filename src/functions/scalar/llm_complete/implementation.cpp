@@ -11,7 +11,25 @@ duckdb::unique_ptr<duckdb::FunctionData> LlmComplete::Bind(
         duckdb::ClientContext& context,
         duckdb::ScalarFunction& bound_function,
         duckdb::vector<duckdb::unique_ptr<duckdb::Expression>>& arguments) {
-    return ScalarFunctionBase::ValidateAndInitializeBindData(context, arguments, "llm_complete", false);
+    auto bind_data = ScalarFunctionBase::ValidateAndInitializeBindData(context, arguments, "llm_complete", false);
+    if (bind_data->logprobs) {
+        throw duckdb::BinderException("llm_complete: 'logprobs' is only supported by llm_filter");
+    }
+    // A schema with a type returns typed values, e.g. a STRUCT for an object with properties. The schema is read as
+    // written, since the resolved model has lost the order of its properties and the STRUCT fields follow it.
+    nlohmann::ordered_json model_json = bind_data->model_json;
+    if (model_json.contains("model_parameters")) {
+        const auto model_value = duckdb::ExpressionExecutor::EvaluateScalar(context, *arguments[0]);
+        model_json["model_parameters"] = Model::ResolveModelParameters(CastValueToJson(model_value));
+    }
+    const auto item_type = SchemaToLogicalType(GetItemSchema(model_json));
+    if (item_type.id() != duckdb::LogicalTypeId::VARCHAR) {
+        bound_function.return_type = item_type;
+        if (bind_data->empty_value) {
+            bind_data->empty_value = TypedEmptyValue(*bind_data->empty_value, item_type);
+        }
+    }
+    return std::move(bind_data);
 }
 
 
@@ -34,44 +52,58 @@ void LlmComplete::ValidateArguments(duckdb::DataChunk& args) {
     }
 }
 
-std::vector<std::string> LlmComplete::Operation(duckdb::DataChunk& args, LlmFunctionBindData* bind_data) {
-    Model model = bind_data->CreateModel();
-
-    auto model_details = model.GetModelDetails();
-    MetricsManager::SetModelInfo(model_details.model_name, model_details.provider_name);
+std::string LlmComplete::ResponseToString(const nlohmann::json& response) {
+    return response.is_string() ? response.get<std::string>() : response.dump();
+}
 
+nlohmann::json LlmComplete::ContextColumns(duckdb::DataChunk& args) {
     auto prompt_context_json = CastVectorOfStructsToJson(args.data[1], args.size());
     auto context_columns = nlohmann::json::array();
     if (prompt_context_json.contains("context_columns")) {
         context_columns = prompt_context_json["context_columns"];
     }
+    return context_columns;
+}
+
+std::vector<std::optional<std::string>> LlmComplete::Operation(duckdb::DataChunk& args, LlmFunctionBindData* bind_data) {
+    return Operation(ContextColumns(args), bind_data);
+}
+
+std::vector<std::optional<std::string>> LlmComplete::Operation(const nlohmann::json& context_columns, const LlmFunctionBindData* bind_data) {
+    std::vector<std::optional<std::string>> results;
+    for (const auto& response: Responses(context_columns, bind_data)) {
+        results.push_back(response ? std::optional<std::string>(ResponseToString(*response)) : std::nullopt);
+    }
+    return results;
+}
+
+std::vector<std::optional<nlohmann::json>> LlmComplete::Responses(const nlohmann::json& context_columns,
+                                                                  const LlmFunctionBindData* bind_data) {
+    Model model = bind_data->CreateModel();
+
+    auto model_details = model.GetModelDetails();
+    MetricsManager::SetModelInfo(model_details.model_name, model_details.provider_name);
 
     auto prompt = bind_data->prompt;
 
-    std::vector<std::string> results;
-    if (context_columns.empty()) {
-        auto template_str = prompt;
-        model.AddCompletionRequest(template_str, 1, OutputType::STRING);
-        auto response = model.CollectCompletions()[0]["items"][0];
-        if (response.is_string()) {
-            results.push_back(response.get<std::string>());
-        } else {
-            results.push_back(response.dump());
-        }
-    } else {
-        if (context_columns.empty()) {
-            return results;
+    // Rows that failed under a tolerant error policy are NULL
+    const auto to_result = [&](const nlohmann::json& response) -> std::optional<nlohmann::json> {
+        if (response.is_null() && bind_data->error_policy != ErrorPolicy::FAIL) {
+            return std::nullopt;
         }
+        return response;
+    };
 
-        auto responses = BatchAndComplete(context_columns, prompt, ScalarFunctionType::COMPLETE, model);
-
-        results.reserve(responses.size());
-        for (const auto& response: responses) {
-            if (response.is_string()) {
-                results.push_back(response.get<std::string>());
-            } else {
-                results.push_back(response.dump());
-            }
+    std::vector<std::optional<nlohmann::json>> results;
+    if (context_columns.empty()) {
+        results.push_back(to_result(CompleteWithoutContext(prompt, OutputType::STRING, model, *bind_data)));
+    } else {
+        // Rows without any context keep the configured empty value and are not sent to the model
+        auto [rows, responses] = CompleteRowsWithContext(context_columns, prompt, ScalarFunctionType::COMPLETE, model,
+                                                         *bind_data);
+        results.assign(context_columns[0]["data"].size(), bind_data->empty_value);
+        for (size_t i = 0; i < rows.size(); i++) {
+            results[rows[i]] = to_result(responses[i]);
         }
     }
     return results;
@@ -88,17 +120,13 @@ void LlmComplete::Execute(duckdb::DataChunk& args, duckdb::ExpressionState& stat
 
     auto& func_expr = state.expr.Cast<duckdb::BoundFunctionExpression>();
     auto* bind_data = &func_expr.bind_info->Cast<LlmFunctionBindData>();
+    bind_data->constant_response->BeginQuery(context.transaction.GetActiveQuery());
 
-    if (const auto results = LlmComplete::Operation(args, bind_data); static_cast<int>(results.size()) == 1) {
-        auto empty_vec = duckdb::Vector(std::string());
-        duckdb::UnaryExecutor::Execute<duckdb::string_t, duckdb::string_t>(
-                empty_vec, result, args.size(),
-                [&](duckdb::string_t name) { return duckdb::StringVector::AddString(result, results[0]); });
+    // A schema that types the result is written column-wise; everything else is JSON text
+    if (result.GetType().id() == duckdb::LogicalTypeId::VARCHAR) {
+        WriteStringResults(LlmComplete::Operation(args, bind_data), result, args.size());
     } else {
-        auto index = 0;
-        for (const auto& res: results) {
-            result.SetValue(index++, duckdb::Value(res));
-        }
+        WriteTypedResults(LlmComplete::Responses(ContextColumns(args), bind_data), result, args.size());
     }
 
     auto exec_end = std::chrono::high_resolution_clock::now();
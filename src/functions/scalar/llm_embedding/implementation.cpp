@@ -10,7 +10,14 @@ duckdb::unique_ptr<duckdb::FunctionData> LlmEmbedding::Bind(
         duckdb::ClientContext& context,
         duckdb::ScalarFunction& bound_function,
         duckdb::vector<duckdb::unique_ptr<duckdb::Expression>>& arguments) {
-    return ScalarFunctionBase::ValidateAndInitializeBindData(context, arguments, "llm_embedding", true, false);
+    auto bind_data = ScalarFunctionBase::ValidateAndInitializeBindData(context, arguments, "llm_embedding", true, false);
+    if (bind_data->HasCascade()) {
+        throw duckdb::BinderException("llm_embedding: 'cascade' is only supported by llm_complete and llm_filter");
+    }
+    if (bind_data->logprobs) {
+        throw duckdb::BinderException("llm_embedding: 'logprobs' is only supported by llm_filter");
+    }
+    return std::move(bind_data);
 }
 
 
@@ -26,14 +33,19 @@ void LlmEmbedding::ValidateArguments(duckdb::DataChunk& args) {
     }
 }
 
-std::vector<duckdb::vector<duckdb::Value>> LlmEmbedding::Operation(duckdb::DataChunk& args, LlmFunctionBindData* bind_data) {
+std::vector<std::vector<double>> LlmEmbedding::Operation(duckdb::DataChunk& args, LlmFunctionBindData* bind_data) {
     auto inputs = CastVectorOfStructsToJson(args.data[1], args.size());
     for (const auto& item: inputs.items()) {
         if (item.key() != "context_columns") {
             throw std::runtime_error(duckdb_fmt::format("Unexpected key in inputs: {}", item.key()));
         }
     }
-    for (const auto& context_column: inputs["context_columns"]) {
+    return Operation(inputs["context_columns"], bind_data);
+}
+
+std::vector<std::vector<double>> LlmEmbedding::Operation(const nlohmann::json& context_columns,
+                                                                   const LlmFunctionBindData* bind_data) {
+    for (const auto& context_column: context_columns) {
         if (context_column.contains("type") && context_column["type"].get<std::string>() == "image") {
             throw std::runtime_error("Image embedding is not supported yet. Please use text data for embedding.");
         }
@@ -45,11 +57,12 @@ std::vector<duckdb::vector<duckdb::Value>> LlmEmbedding::Operation(duckdb::DataC
     MetricsManager::SetModelInfo(model_details.model_name, model_details.provider_name);
 
     std::vector<std::string> prepared_inputs;
-    auto num_rows = inputs["context_columns"][0]["data"].size();
+    auto num_rows = context_columns[0]["data"].size();
     for (size_t row_idx = 0; row_idx < num_rows; row_idx++) {
         std::string concat_input;
-        for (auto& context_column: inputs["context_columns"]) {
-            concat_input += context_column["data"][row_idx].get<std::string>() + " ";
+        for (const auto& context_column: context_columns) {
+            const auto& value = context_column["data"][row_idx];
+            concat_input += (value.is_null() ? std::string() : value.get<std::string>()) + " ";
         }
         prepared_inputs.push_back(concat_input);
     }
@@ -68,15 +81,15 @@ std::vector<duckdb::vector<duckdb::Value>> LlmEmbedding::Operation(duckdb::DataC
         model.AddEmbeddingRequest(batch_inputs);
     }
 
-    std::vector<duckdb::vector<duckdb::Value>> results;
+    std::vector<std::vector<double>> results;
     auto all_embeddings = model.CollectEmbeddings();
     for (size_t index = 0; index < all_embeddings.size(); index++) {
         for (auto& embedding: all_embeddings[index]) {
-            duckdb::vector<duckdb::Value> formatted_embedding;
+            auto& formatted_embedding = results.emplace_back();
+            formatted_embedding.reserve(embedding.size());
             for (auto& value: embedding) {
-                formatted_embedding.push_back(duckdb::Value(static_cast<double>(value)));
+                formatted_embedding.push_back(value.get<double>());
             }
-            results.push_back(formatted_embedding);
         }
     }
     return results;
@@ -94,12 +107,7 @@ void LlmEmbedding::Execute(duckdb::DataChunk& args, duckdb::ExpressionState& sta
     auto& func_expr = state.expr.Cast<duckdb::BoundFunctionExpression>();
     auto* bind_data = &func_expr.bind_info->Cast<LlmFunctionBindData>();
 
-    auto results = LlmEmbedding::Operation(args, bind_data);
-
-    auto index = 0;
-    for (const auto& res: results) {
-        result.SetValue(index++, duckdb::Value::LIST(res));
-    }
+    WriteListResults(LlmEmbedding::Operation(args, bind_data), result, args.size());
 
     auto exec_end = std::chrono::high_resolution_clock::now();
     double exec_duration_ms = std::chrono::duration<double, std::milli>(exec_end - exec_start).count();
@@ -14,6 +14,20 @@ duckdb::unique_ptr<duckdb::FunctionData> LlmFilter::Bind(
     return ScalarFunctionBase::ValidateAndInitializeBindData(context, arguments, "llm_filter", false);
 }
 
+duckdb::unique_ptr<duckdb::FunctionData> LlmFilter::ConfidenceBind(
+        duckdb::ClientContext& context,
+        duckdb::ScalarFunction& bound_function,
+        duckdb::vector<duckdb::unique_ptr<duckdb::Expression>>& arguments) {
+    auto bind_data = ScalarFunctionBase::ValidateAndInitializeBindData(context, arguments, "llm_filter_confidence", false);
+    if (!bind_data->logprobs) {
+        bind_data->logprobs = true;
+        if (!bind_data->model_json.is_null()) {
+            ValidateLogprobs(*bind_data);
+        }
+    }
+    return std::move(bind_data);
+}
+
 
 void LlmFilter::ValidateArguments(duckdb::DataChunk& args) {
     if (args.ColumnCount() < 2 || args.ColumnCount() > 3) {
@@ -32,40 +46,94 @@ void LlmFilter::ValidateArguments(duckdb::DataChunk& args) {
     }
 }
 
-std::vector<std::string> LlmFilter::Operation(duckdb::DataChunk& args, LlmFunctionBindData* bind_data) {
-    Model model = bind_data->CreateModel();
-
-    auto model_details = model.GetModelDetails();
-    MetricsManager::SetModelInfo(model_details.model_name, model_details.provider_name);
+std::optional<bool> LlmFilter::ParseVerdict(const nlohmann::json& response) {
+    if (response.is_boolean()) {
+        return response.get<bool>();
+    }
+    if (response.is_number()) {
+        return response.get<double>() != 0;
+    }
+    if (response.is_string()) {
+        auto verdict = response.get<std::string>();
+        duckdb::StringUtil::Trim(verdict);
+        if (duckdb::StringUtil::CIEquals(verdict, "true") || verdict == "1") {
+            return true;
+        }
+        if (duckdb::StringUtil::CIEquals(verdict, "false") || verdict == "0") {
+            return false;
+        }
+    }
+    return std::nullopt;
+}
 
+std::vector<std::optional<bool>> LlmFilter::Operation(duckdb::DataChunk& args, LlmFunctionBindData* bind_data) {
     auto prompt_context_json = CastVectorOfStructsToJson(args.data[1], args.size());
     auto context_columns = nlohmann::json::array();
     if (prompt_context_json.contains("context_columns")) {
         context_columns = prompt_context_json["context_columns"];
     }
+    return Operation(context_columns, bind_data);
+}
+
+std::vector<std::optional<bool>> LlmFilter::Operation(const nlohmann::json& context_columns, const LlmFunctionBindData* bind_data) {
+    if (bind_data->logprobs) {
+        std::vector<std::optional<bool>> results;
+        for (const auto& confidence: ConfidenceOperation(context_columns, bind_data)) {
+            results.push_back(confidence ? std::optional<bool>(*confidence >= YES_THRESHOLD) : std::nullopt);
+        }
+        return results;
+    }
+
+    Model model = bind_data->CreateModel();
+
+    auto model_details = model.GetModelDetails();
+    MetricsManager::SetModelInfo(model_details.model_name, model_details.provider_name);
 
     auto prompt = bind_data->prompt;
 
-    std::vector<std::string> results;
+    std::vector<std::optional<bool>> results;
     if (context_columns.empty()) {
-        auto template_str = prompt;
-        model.AddCompletionRequest(template_str, 1, OutputType::BOOL);
-        auto response = model.CollectCompletions()[0]["items"][0];
-        if (response.is_null()) {
-            results.push_back("true");
-        } else {
-            results.push_back(response.dump());
-        }
+        results.push_back(ParseVerdict(CompleteWithoutContext(prompt, OutputType::BOOL, model, *bind_data)));
     } else {
-        auto responses = BatchAndComplete(context_columns, prompt, ScalarFunctionType::FILTER, model);
+        // Rows without any context keep the configured empty value and are not sent to the model
+        auto [rows, responses] = CompleteRowsWithContext(context_columns, prompt, ScalarFunctionType::FILTER, model,
+                                                         *bind_data);
+        const auto empty_verdict = bind_data->empty_value ? ParseVerdict(*bind_data->empty_value) : std::nullopt;
+        results.assign(context_columns[0]["data"].size(), empty_verdict);
+        for (size_t i = 0; i < rows.size(); i++) {
+            results[rows[i]] = ParseVerdict(responses[i]);
+        }
+    }
 
-        results.reserve(responses.size());
-        for (const auto& response: responses) {
-            if (response.is_null()) {
-                results.emplace_back("true");
-                continue;
-            }
-            results.push_back(response.dump());
+    return results;
+}
+
+std::vector<std::optional<double>> LlmFilter::ConfidenceOperation(const nlohmann::json& context_columns,
+                                                                 const LlmFunctionBindData* bind_data) {
+    Model model = bind_data->CreateModel();
+
+    auto model_details = model.GetModelDetails();
+    MetricsManager::SetModelInfo(model_details.model_name, model_details.provider_name);
+
+    const auto to_result = [](const nlohmann::json& response) -> std::optional<double> {
+        if (!response.is_number()) {
+            return std::nullopt;
+        }
+        return response.get<double>();
+    };
+
+    std::vector<std::optional<double>> results;
+    if (context_columns.empty()) {
+        results.push_back(to_result(CompleteWithoutContext(bind_data->prompt, OutputType::BOOL, model, *bind_data)));
+    } else {
+        // Rows without any context are certain of the configured empty value
+        auto [rows, responses] = CompleteRowsWithContext(context_columns, bind_data->prompt, ScalarFunctionType::FILTER,
+                                                         model, *bind_data);
+        const auto empty_verdict = bind_data->empty_value ? ParseVerdict(*bind_data->empty_value) : std::nullopt;
+        results.assign(context_columns[0]["data"].size(),
+                       empty_verdict ? std::optional<double>(*empty_verdict ? 1.0 : 0.0) : std::nullopt);
+        for (size_t i = 0; i < rows.size(); i++) {
+            results[rows[i]] = to_result(responses[i]);
         }
     }
 
@@ -83,12 +151,73 @@ void LlmFilter::Execute(duckdb::DataChunk& args, duckdb::ExpressionState& state,
 
     auto& func_expr = state.expr.Cast<duckdb::BoundFunctionExpression>();
     auto* bind_data = &func_expr.bind_info->Cast<LlmFunctionBindData>();
+    bind_data->constant_response->BeginQuery(context.transaction.GetActiveQuery());
 
+    // DuckDB evaluates the conjuncts of a filter in order and only passes the rows that are still selected, so
+    // rows eliminated by cheaper predicates never reach the model
     const auto results = LlmFilter::Operation(args, bind_data);
+    if (results.size() == 1) {
+        result.SetVectorType(duckdb::VectorType::CONSTANT_VECTOR);
+        if (results[0].has_value()) {
+            duckdb::ConstantVector::GetData<bool>(result)[0] = *results[0];
+        } else {
+            duckdb::ConstantVector::SetNull(result, true);
+        }
+    } else {
+        result.SetVectorType(duckdb::VectorType::FLAT_VECTOR);
+        auto data = duckdb::FlatVector::GetData<bool>(result);
+        auto& validity = duckdb::FlatVector::Validity(result);
+        for (idx_t i = 0; i < args.size(); i++) {
+            if (i < results.size() && results[i].has_value()) {
+                data[i] = *results[i];
+            } else {
+                validity.SetInvalid(i);
+            }
+        }
+    }
 
-    auto index = 0;
-    for (const auto& res: results) {
-        result.SetValue(index++, duckdb::Value(res));
+    auto exec_end = std::chrono::high_resolution_clock::now();
+    double exec_duration_ms = std::chrono::duration<double, std::milli>(exec_end - exec_start).count();
+    MetricsManager::AddExecutionTime(exec_duration_ms);
+}
+
+void LlmFilter::ConfidenceExecute(duckdb::DataChunk& args, duckdb::ExpressionState& state, duckdb::Vector& result) {
+    auto& context = state.GetContext();
+    auto* db = context.db.get();
+    const void* invocation_id = MetricsManager::GenerateUniqueId();
+
+    MetricsManager::StartInvocation(db, invocation_id, FunctionType::LLM_FILTER);
+
+    auto exec_start = std::chrono::high_resolution_clock::now();
+
+    auto& func_expr = state.expr.Cast<duckdb::BoundFunctionExpression>();
+    auto* bind_data = &func_expr.bind_info->Cast<LlmFunctionBindData>();
+    bind_data->constant_response->BeginQuery(context.transaction.GetActiveQuery());
+
+    auto prompt_context_json = CastVectorOfStructsToJson(args.data[1], args.size());
+    auto context_columns = nlohmann::json::array();
+    if (prompt_context_json.contains("context_columns")) {
+        context_columns = prompt_context_json["context_columns"];
+    }
+    const auto results = LlmFilter::ConfidenceOperation(context_columns, bind_data);
+    if (results.size() == 1) {
+        result.SetVectorType(duckdb::VectorType::CONSTANT_VECTOR);
+        if (results[0].has_value()) {
+            duckdb::ConstantVector::GetData<double>(result)[0] = *results[0];
+        } else {
+            duckdb::ConstantVector::SetNull(result, true);
+        }
+    } else {
+        result.SetVectorType(duckdb::VectorType::FLAT_VECTOR);
+        auto data = duckdb::FlatVector::GetData<double>(result);
+        auto& validity = duckdb::FlatVector::Validity(result);
+        for (idx_t i = 0; i < args.size(); i++) {
+            if (i < results.size() && results[i].has_value()) {
+                data[i] = *results[i];
+            } else {
+                validity.SetInvalid(i);
+            }
+        }
     }
 
     auto exec_end = std::chrono::high_resolution_clock::now();
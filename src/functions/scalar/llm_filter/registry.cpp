@@ -6,8 +6,12 @@ namespace flock {
 void ScalarRegistry::RegisterLlmFilter(duckdb::ExtensionLoader& loader) {
     loader.RegisterFunction(duckdb::ScalarFunction("llm_filter",
                                                    {duckdb::LogicalType::ANY, duckdb::LogicalType::ANY},
-                                                   duckdb::LogicalType::VARCHAR, LlmFilter::Execute,
+                                                   duckdb::LogicalType::BOOLEAN, LlmFilter::Execute,
                                                    LlmFilter::Bind));
+    loader.RegisterFunction(duckdb::ScalarFunction("llm_filter_confidence",
+                                                   {duckdb::LogicalType::ANY, duckdb::LogicalType::ANY},
+                                                   duckdb::LogicalType::DOUBLE, LlmFilter::ConfidenceExecute,
+                                                   LlmFilter::ConfidenceBind));
 }
 
 }// namespace flock
@@ -0,0 +1,38 @@
+#include "duckdb/planner/expression/bound_function_expression.hpp"
+#include "flock/functions/scalar/llm_token_count.hpp"
+#include "flock/model_manager/tokenizer.hpp"
+
+namespace flock {
+
+duckdb::unique_ptr<duckdb::FunctionData> LlmTokenCount::Bind(
+        duckdb::ClientContext& context,
+        duckdb::ScalarFunction& bound_function,
+        duckdb::vector<duckdb::unique_ptr<duckdb::Expression>>& arguments) {
+    if (arguments.size() != 2) {
+        throw duckdb::BinderException("llm_token_count requires 2 arguments: (1) model, (2) text. Got " +
+                                      std::to_string(arguments.size()));
+    }
+    if (arguments[0]->return_type.id() != duckdb::LogicalTypeId::STRUCT || !arguments[0]->IsFoldable()) {
+        throw duckdb::BinderException("llm_token_count: First argument must be a constant model (struct type)");
+    }
+
+    auto bind_data = duckdb::make_uniq<LlmFunctionBindData>();
+    auto model_value = duckdb::ExpressionExecutor::EvaluateScalar(context, *arguments[0]);
+    ScalarFunctionBase::InitializeModelJson(model_value, *bind_data);
+    return std::move(bind_data);
+}
+
+void LlmTokenCount::Execute(duckdb::DataChunk& args, duckdb::ExpressionState& state, duckdb::Vector& result) {
+    auto& func_expr = state.expr.Cast<duckdb::BoundFunctionExpression>();
+    const auto& bind_data = func_expr.bind_info->Cast<LlmFunctionBindData>();
+
+    // Resolve the tokenizer once per chunk rather than per row
+    const auto tokenizer = TokenCounter::ForModel(bind_data.model_json.value("model", std::string()));
+    duckdb::UnaryExecutor::Execute<duckdb::string_t, int64_t>(
+            args.data[1], result, args.size(), [&](duckdb::string_t text) {
+                const std::string_view view(text.GetData(), text.GetSize());
+                return tokenizer ? static_cast<int64_t>(tokenizer->Count(view)) : TokenCounter::Approximate(view);
+            });
+}
+
+}// namespace flock
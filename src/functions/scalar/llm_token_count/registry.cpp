@@ -0,0 +1,13 @@
+#include "flock/registry/registry.hpp"
+#include "flock/functions/scalar/llm_token_count.hpp"
+
+namespace flock {
+
+void ScalarRegistry::RegisterLlmTokenCount(duckdb::ExtensionLoader& loader) {
+    loader.RegisterFunction(duckdb::ScalarFunction("llm_token_count",
+                                                   {duckdb::LogicalType::ANY, duckdb::LogicalType::VARCHAR},
+                                                   duckdb::LogicalType::BIGINT, LlmTokenCount::Execute,
+                                                   LlmTokenCount::Bind));
+}
+
+}// namespace flock
@@ -1,6 +1,13 @@
 #include "flock/functions/scalar/scalar.hpp"
+#include "flock/functions/batch_packer.hpp"
+#include "flock/functions/checkpoint_journal.hpp"
+#include "flock/metrics/manager.hpp"
 #include "flock/model_manager/model.hpp"
+#include "flock/model_manager/output_budget.hpp"
 #include <duckdb/planner/expression/bound_function_expression.hpp>
+#include <algorithm>
+#include <deque>
+#include <unordered_set>
 
 namespace flock {
 
@@ -63,88 +70,866 @@ void ScalarFunctionBase::InitializeModelJson(
     }
 
     auto model_value = duckdb::ExpressionExecutor::EvaluateScalar(context, *model_expr);
+    InitializeModelJson(model_value, bind_data);
+}
+
+void ScalarFunctionBase::ValidateLogprobs(const LlmFunctionBindData& bind_data) {
+    if (bind_data.checkpoint) {
+        throw duckdb::BinderException("'logprobs' cannot be combined with 'checkpoint'.");
+    }
+    if (bind_data.HasCascade()) {
+        throw duckdb::BinderException("'cascade' cannot be combined with 'logprobs'.");
+    }
+    const auto provider = bind_data.model_json.value("provider", std::string());
+    const auto provider_type = GetProviderType(provider);
+    if (provider_type != FLOCKMTL_OPENAI && provider_type != FLOCKMTL_OLLAMA) {
+        throw duckdb::BinderException(duckdb_fmt::format(
+                "'logprobs' needs a provider that returns log probabilities (openai or ollama), got '{}'.", provider));
+    }
+    // Reasoning models reject logprobs or spend the single answer token on reasoning, leaving every row NULL
+    const auto model = bind_data.model_json.value("model", std::string());
+    if (OutputBudget::IsReasoningModel(model)) {
+        throw duckdb::BinderException(duckdb_fmt::format(
+                "'logprobs' needs a model that answers without reasoning first, got the reasoning model '{}'.", model));
+    }
+}
+
+void ScalarFunctionBase::InitializeModelJson(const duckdb::Value& model_value, LlmFunctionBindData& bind_data) {
     auto user_model_json = CastValueToJson(model_value);
+    if (user_model_json.contains("checkpoint")) {
+        auto checkpoint = duckdb::StringUtil::Lower(user_model_json["checkpoint"].is_string()
+                                                            ? user_model_json["checkpoint"].get<std::string>()
+                                                            : user_model_json["checkpoint"].dump());
+        if (checkpoint != "true" && checkpoint != "false") {
+            throw duckdb::BinderException("Expected 'checkpoint' to be a boolean.");
+        }
+        bind_data.checkpoint = checkpoint == "true";
+        user_model_json.erase("checkpoint");
+    }
+    if (user_model_json.contains("logprobs")) {
+        auto logprobs = duckdb::StringUtil::Lower(user_model_json["logprobs"].is_string()
+                                                          ? user_model_json["logprobs"].get<std::string>()
+                                                          : user_model_json["logprobs"].dump());
+        if (logprobs != "true" && logprobs != "false") {
+            throw duckdb::BinderException("Expected 'logprobs' to be a boolean.");
+        }
+        bind_data.logprobs = logprobs == "true";
+        user_model_json.erase("logprobs");
+    }
+    if (user_model_json.contains("empty_value")) {
+        const auto& empty_value = user_model_json["empty_value"];
+        bind_data.empty_value = empty_value.is_string() ? empty_value.get<std::string>() : empty_value.dump();
+        user_model_json.erase("empty_value");
+    }
+    if (user_model_json.contains("error_policy")) {
+        const auto& policy_json = user_model_json["error_policy"];
+        const auto policy = duckdb::StringUtil::Lower(policy_json.is_string() ? policy_json.get<std::string>() : policy_json.dump());
+        if (policy == "fail") {
+            bind_data.error_policy = ErrorPolicy::FAIL;
+        } else if (policy == "null") {
+            bind_data.error_policy = ErrorPolicy::NULL_ROW;
+        } else if (policy == "retry") {
+            bind_data.error_policy = ErrorPolicy::RETRY;
+        } else {
+            throw duckdb::BinderException("Expected 'error_policy' to be one of 'fail', 'null' or 'retry'.");
+        }
+        user_model_json.erase("error_policy");
+    }
+    if (user_model_json.contains("cascade")) {
+        auto cascade_json = user_model_json["cascade"];
+        if (!cascade_json.is_object() || !cascade_json.contains("model_name")) {
+            throw duckdb::BinderException("Expected 'cascade' to be a struct with the 'model_name' of the escalation model.");
+        }
+        if (cascade_json.contains("threshold")) {
+            const auto& threshold = cascade_json["threshold"];
+            try {
+                bind_data.cascade_threshold = threshold.is_number() ? threshold.get<double>()
+                                                                    : std::stod(threshold.get<std::string>());
+            } catch (const std::exception&) {
+                throw duckdb::BinderException("Expected the 'cascade' threshold to be a number.");
+            }
+            if (bind_data.cascade_threshold <= 0 || bind_data.cascade_threshold > 1) {
+                throw duckdb::BinderException("Expected the 'cascade' threshold to be in (0, 1].");
+            }
+            cascade_json.erase("threshold");
+        }
+        if (bind_data.checkpoint) {
+            throw duckdb::BinderException("'cascade' cannot be combined with 'checkpoint'.");
+        }
+        if (bind_data.logprobs) {
+            throw duckdb::BinderException("'cascade' cannot be combined with 'logprobs'.");
+        }
+        bind_data.cascade_model_json = Model::ResolveModelDetailsToJson(cascade_json);
+        user_model_json.erase("cascade");
+    }
     bind_data.model_json = Model::ResolveModelDetailsToJson(user_model_json);
+    if (bind_data.HasCascade() && HasItemSchema(bind_data.model_json)) {
+        throw duckdb::BinderException("'cascade' cannot be combined with a custom output schema on the primary model.");
+    }
+    if (bind_data.logprobs) {
+        ValidateLogprobs(bind_data);
+    }
 }
 
-nlohmann::json ScalarFunctionBase::Complete(nlohmann::json& columns, const std::string& user_prompt,
-                                            ScalarFunctionType function_type, Model& model) {
+void ScalarFunctionBase::AddCompletion(nlohmann::json& columns, const std::string& user_prompt,
+                                       ScalarFunctionType function_type, Model& model) {
     const auto [prompt, media_data] = PromptManager::Render(user_prompt, columns, function_type, model.GetModelDetails().tuple_format);
     OutputType output_type = OutputType::STRING;
     if (function_type == ScalarFunctionType::FILTER) {
         output_type = OutputType::BOOL;
+    } else if (function_type == ScalarFunctionType::CLASSIFY) {
+        output_type = OutputType::INTEGER;
     }
 
     model.AddCompletionRequest(prompt, static_cast<int>(columns[0]["data"].size()), output_type, media_data);
+}
+
+nlohmann::json ScalarFunctionBase::Complete(nlohmann::json& columns, const std::string& user_prompt,
+                                            ScalarFunctionType function_type, Model& model) {
+    AddCompletion(columns, user_prompt, function_type, model);
     auto response = model.CollectCompletions();
     return response[0]["items"];
 };
 
+nlohmann::json ScalarFunctionBase::SelectRows(const nlohmann::json& tuples, const std::vector<size_t>& rows) {
+    auto batch_tuples = nlohmann::json::array();
+    for (const auto& column: tuples) {
+        auto batch_column = nlohmann::json::object();
+        for (const auto& item: column.items()) {
+            if (item.key() != "data") {
+                batch_column[item.key()] = item.value();
+            } else {
+                batch_column["data"] = nlohmann::json::array();
+                for (const auto row: rows) {
+                    batch_column["data"].push_back(item.value()[row]);
+                }
+            }
+        }
+        batch_tuples.push_back(batch_column);
+    }
+    return batch_tuples;
+}
+
+void ScalarFunctionBase::FitResponseToBatch(nlohmann::json& response, size_t batch_rows) {
+    if (!response.is_array()) {
+        response = nlohmann::json::array();
+    }
+    if (response.size() < batch_rows) {
+        for (auto i = response.size(); i < batch_rows; i++) {
+            response.push_back(nullptr);
+        }
+    } else if (response.size() > batch_rows) {
+        response.erase(response.begin() + static_cast<std::ptrdiff_t>(batch_rows), response.end());
+    }
+}
+
 nlohmann::json ScalarFunctionBase::BatchAndComplete(const nlohmann::json& tuples,
                                                     const std::string& user_prompt,
-                                                    const ScalarFunctionType function_type, Model& model) {
-    const auto llm_template = PromptManager::GetTemplate(function_type);
-
+                                                    const ScalarFunctionType function_type, Model& model,
+                                                    const ErrorPolicy error_policy, const BatchCallback& on_batch) {
     const auto model_details = model.GetModelDetails();
-    auto batch_size = std::min<int>(model.GetModelDetails().batch_size, static_cast<int>(tuples[0]["data"].size()));
+    const auto budget = BatchPacker::Budget(model_details, user_prompt, function_type);
+    const auto batches = BatchPacker::Pack(BatchPacker::EstimateRowTokens(tuples, model_details.model), budget);
+
+    PromptManager::PrefetchTranscriptions(tuples);
 
     auto responses = nlohmann::json::array();
+    for (size_t row = 0; row < tuples[0]["data"].size(); row++) {
+        responses.push_back(nullptr);
+    }
+    CompleteBatches(tuples, user_prompt, function_type, model, batches, error_policy, on_batch, responses);
+    return responses;
+}
+
+std::vector<std::vector<size_t>> ScalarFunctionBase::SplitInHalves(const std::vector<size_t>& rows) {
+    const auto half = static_cast<std::ptrdiff_t>((rows.size() + 1) / 2);
+    return {std::vector<size_t>(rows.begin(), rows.begin() + half), std::vector<size_t>(rows.begin() + half, rows.end())};
+}
 
-    if (batch_size <= 0) {
-        throw std::runtime_error("Batch size must be greater than zero");
+void ScalarFunctionBase::CompleteBatches(const nlohmann::json& tuples, const std::string& user_prompt,
+                                         const ScalarFunctionType function_type, Model& model,
+                                         const std::vector<std::vector<size_t>>& batches,
+                                         const ErrorPolicy error_policy, const BatchCallback& on_batch,
+                                         nlohmann::json& responses) {
+    // Render every batch up front and collect them together, so the handler runs them concurrently
+    for (const auto& rows: batches) {
+        auto batch_tuples = SelectRows(tuples, rows);
+        AddCompletion(batch_tuples, user_prompt, function_type, model);
     }
 
-    auto batch_tuples = nlohmann::json::array();
-    int start_index = 0;
-
-    do {
-        batch_tuples.clear();
-
-        for (auto i = 0; i < static_cast<int>(tuples.size()); i++) {
-            batch_tuples.push_back(nlohmann::json::object());
-            for (const auto& item: tuples[i].items()) {
-                if (item.key() != "data") {
-                    batch_tuples[i][item.key()] = item.value();
-                } else {
-                    for (auto j = 0; j < batch_size && start_index + j < static_cast<int>(item.value().size()); j++) {
-                        if (j == 0) {
-                            batch_tuples[i]["data"] = nlohmann::json::array();
-                        }
-                        batch_tuples[i]["data"].push_back(item.value()[start_index + j]);
-                    }
+    std::vector<nlohmann::json> batch_responses;
+    std::unordered_set<size_t> failed;
+    std::unordered_set<size_t> overflowed;
+    try {
+        batch_responses = model.CollectCompletions();
+    } catch (ExceededMaxOutputTokensError& error) {
+        if (error.overflowed.empty()) {
+            // The failing batch is unknown, so fall back to one batch at a time and only split the ones that overflow
+            const auto sequential = BatchAndCompleteSequentially(tuples, user_prompt, function_type, model, batches,
+                                                                 error_policy, on_batch);
+            for (const auto& rows: batches) {
+                for (const auto row: rows) {
+                    responses[row] = sequential[row];
+                }
+            }
+            return;
+        }
+        batch_responses = std::move(error.results);
+        overflowed.insert(error.overflowed.begin(), error.overflowed.end());
+    } catch (FailedRequestsError& error) {
+        if (error_policy == ErrorPolicy::FAIL) {
+            throw;
+        }
+        // The batches that succeeded are kept, so only the failed ones are asked again or left NULL
+        batch_responses = std::move(error.results);
+        failed.insert(error.failed.begin(), error.failed.end());
+        overflowed.insert(error.overflowed.begin(), error.overflowed.end());
+    } catch (const std::exception&) {
+        if (error_policy == ErrorPolicy::FAIL) {
+            throw;
+        }
+        // Without the failed batches known, likewise isolate them one batch at a time
+        const auto sequential = BatchAndCompleteSequentially(tuples, user_prompt, function_type, model, batches,
+                                                             error_policy, on_batch);
+        for (const auto& rows: batches) {
+            for (const auto row: rows) {
+                responses[row] = sequential[row];
+            }
+        }
+        return;
+    }
+
+    std::vector<std::vector<size_t>> resubmitted;
+    std::vector<std::vector<size_t>> retries;
+    for (size_t batch = 0; batch < batches.size(); batch++) {
+        const auto& rows = batches[batch];
+        if (failed.count(batch)) {
+            // Under the retry policy every row of a failed batch is asked again on its own; otherwise they stay NULL
+            if (error_policy == ErrorPolicy::RETRY && rows.size() > 1) {
+                for (const auto row: rows) {
+                    retries.push_back({row});
+                }
+            }
+            continue;
+        }
+        if (overflowed.count(batch)) {
+            // Keep the items the model completed before the cut and only send the rest of the batch again
+            auto completed = nlohmann::json::array();
+            if (batch < batch_responses.size() && batch_responses[batch].contains("items") &&
+                batch_responses[batch]["items"].is_array()) {
+                completed = batch_responses[batch]["items"];
+            }
+            FitResponseToBatch(completed, std::min(completed.size(), rows.size()));
+            const std::vector<size_t> completed_rows(rows.begin(), rows.begin() + static_cast<std::ptrdiff_t>(completed.size()));
+            std::vector<size_t> remaining_rows(rows.begin() + static_cast<std::ptrdiff_t>(completed.size()), rows.end());
+            if (!completed_rows.empty()) {
+                if (on_batch) {
+                    on_batch(completed_rows, completed);
+                }
+                for (size_t i = 0; i < completed_rows.size(); i++) {
+                    responses[completed_rows[i]] = completed[i];
+                }
+            }
+            if (remaining_rows.empty()) {
+                continue;
+            }
+
+            // Later batches of this model start below the size that overflowed
+            BatchPacker::RecordOverflow(model.GetModelDetails(), function_type, static_cast<int>(rows.size()));
+            if (!completed_rows.empty()) {
+                resubmitted.push_back(std::move(remaining_rows));
+            } else if (rows.size() > 1) {
+                for (auto& half: SplitInHalves(rows)) {
+                    resubmitted.push_back(std::move(half));
                 }
+            } else if (error_policy == ErrorPolicy::FAIL) {
+                throw std::runtime_error("Batch size reduced to zero, unable to process tuples");
+            }
+            // Otherwise the row stays NULL
+            continue;
+        }
+
+        nlohmann::json response;
+        if (batch < batch_responses.size() && batch_responses[batch].contains("items")) {
+            response = batch_responses[batch]["items"];
+        }
+        FitResponseToBatch(response, rows.size());
+
+        if (on_batch) {
+            on_batch(rows, response);
+        }
+        for (size_t i = 0; i < rows.size(); i++) {
+            responses[rows[i]] = response[i];
+            if (error_policy == ErrorPolicy::RETRY && rows.size() > 1 && response[i].is_null()) {
+                retries.push_back({rows[i]});
             }
         }
+    }
+
+    // The rest of overflowing batches run concurrently again, and split further if they still overflow
+    if (!resubmitted.empty()) {
+        CompleteBatches(tuples, user_prompt, function_type, model, resubmitted, error_policy, on_batch, responses);
+    }
+
+    // Rows the model left out of a batch are asked again on their own
+    if (!retries.empty()) {
+        CompleteBatches(tuples, user_prompt, function_type, model, retries, error_policy, on_batch, responses);
+    }
+}
+
+nlohmann::json ScalarFunctionBase::BatchAndCompleteSequentially(const nlohmann::json& tuples,
+                                                                const std::string& user_prompt,
+                                                                const ScalarFunctionType function_type, Model& model,
+                                                                const std::vector<std::vector<size_t>>& batches,
+                                                                const ErrorPolicy error_policy,
+                                                                const BatchCallback& on_batch) {
+    auto responses = nlohmann::json::array();
+    for (size_t row = 0; row < tuples[0]["data"].size(); row++) {
+        responses.push_back(nullptr);
+    }
 
-        start_index += batch_size;
+    std::deque<std::vector<size_t>> queue(batches.begin(), batches.end());
+    while (!queue.empty()) {
+        auto rows = std::move(queue.front());
+        queue.pop_front();
+        auto batch_tuples = SelectRows(tuples, rows);
 
         try {
             auto response = Complete(batch_tuples, user_prompt, function_type, model);
+            FitResponseToBatch(response, rows.size());
 
-            if (response.size() < batch_tuples[0]["data"].size()) {
-                for (auto i = static_cast<int>(response.size()); i < batch_tuples[0]["data"].size(); i++) {
-                    response.push_back(nullptr);
-                }
-            } else if (response.size() > batch_tuples[0]["data"].size()) {
-                response.erase(response.begin() + batch_tuples.size(), response.end());
+            if (on_batch) {
+                on_batch(rows, response);
             }
-
-            for (const auto& tuple: response) {
-                responses.push_back(tuple);
+            for (size_t i = 0; i < rows.size(); i++) {
+                responses[rows[i]] = response[i];
+                if (error_policy == ErrorPolicy::RETRY && rows.size() > 1 && response[i].is_null()) {
+                    queue.push_back({rows[i]});
+                }
             }
         } catch (const ExceededMaxOutputTokensError&) {
-            start_index -= batch_size;
-            batch_size = static_cast<int>(batch_size * 0.9);
-            if (batch_size <= 0) {
+            if (rows.size() == 1) {
+                if (error_policy != ErrorPolicy::FAIL) {
+                    continue;// The row stays NULL
+                }
                 throw std::runtime_error("Batch size reduced to zero, unable to process tuples");
             }
+            // Retry the overflowing batch in halves
+            BatchPacker::RecordOverflow(model.GetModelDetails(), function_type, static_cast<int>(rows.size()));
+            auto halves = SplitInHalves(rows);
+            queue.insert(queue.begin(), halves.begin(), halves.end());
+        } catch (const std::exception&) {
+            if (error_policy == ErrorPolicy::FAIL) {
+                throw;
+            }
+            // Under the retry policy every row of a failed batch is asked again on its own; otherwise they stay NULL
+            if (error_policy == ErrorPolicy::RETRY && rows.size() > 1) {
+                for (auto row = rows.rbegin(); row != rows.rend(); ++row) {
+                    queue.push_front({*row});
+                }
+            }
+        }
+    }
+
+    return responses;
+}
+
+nlohmann::json ScalarFunctionBase::BatchAndCompleteWithCheckpoint(const nlohmann::json& tuples,
+                                                                  const std::string& user_prompt,
+                                                                  const ScalarFunctionType function_type, Model& model,
+                                                                  const LlmFunctionBindData& bind_data) {
+    const auto request_hash = CheckpointJournal::RequestHash(bind_data.model_json, user_prompt, function_type);
+    const auto num_rows = tuples[0]["data"].size();
+
+    std::vector<std::string> row_hashes;
+    row_hashes.reserve(num_rows);
+    for (size_t row = 0; row < num_rows; row++) {
+        row_hashes.push_back(CheckpointJournal::RowHash(tuples, row));
+    }
+    auto journaled = CheckpointJournal::Load(request_hash, row_hashes);
+
+    // Only rows that are not journaled yet go to the model, identical rows once
+    auto pending_tuples = tuples;
+    for (auto& column: pending_tuples) {
+        column["data"] = nlohmann::json::array();
+    }
+    std::vector<std::string> pending_hashes;
+    std::unordered_set<std::string> seen_hashes;
+    for (size_t row = 0; row < num_rows; row++) {
+        const auto& row_hash = row_hashes[row];
+        if (journaled.count(row_hash) || !seen_hashes.insert(row_hash).second) {
+            continue;
         }
+        for (size_t col = 0; col < tuples.size(); col++) {
+            pending_tuples[col]["data"].push_back(tuples[col]["data"][row]);
+        }
+        pending_hashes.push_back(row_hash);
+    }
 
-    } while (start_index < static_cast<int>(tuples[0]["data"].size()));
+    if (!pending_hashes.empty()) {
+        BatchAndComplete(pending_tuples, user_prompt, function_type, model, bind_data.error_policy,
+                         [&](const std::vector<size_t>& rows, const nlohmann::json& responses) {
+                             // Rows without a response are not journaled, so the next run asks for them again
+                             std::vector<std::string> batch_hashes;
+                             auto batch_responses = nlohmann::json::array();
+                             for (size_t i = 0; i < rows.size(); i++) {
+                                 if (responses[i].is_null()) {
+                                     continue;
+                                 }
+                                 batch_hashes.push_back(pending_hashes[rows[i]]);
+                                 batch_responses.push_back(responses[i]);
+                                 journaled[pending_hashes[rows[i]]] = responses[i];
+                             }
+                             if (!batch_hashes.empty()) {
+                                 CheckpointJournal::Append(request_hash, batch_hashes, batch_responses);
+                             }
+                         });
+    }
 
+    auto responses = nlohmann::json::array();
+    for (const auto& row_hash: row_hashes) {
+        auto it = journaled.find(row_hash);
+        responses.push_back(it == journaled.end() ? nlohmann::json(nullptr) : it->second);
+    }
     return responses;
 }
 
+nlohmann::json ScalarFunctionBase::CascadeItemSchema(const ScalarFunctionType function_type) {
+    const auto answer_type = function_type == ScalarFunctionType::FILTER ? "boolean" : "string";
+    return {{"type", "object"},
+            {"properties",
+             {{"answer", {{"type", answer_type}}},
+              {"confidence",
+               {{"type", "number"},
+                {"description", "How likely the answer is correct, from 0 (guess) to 1 (certain)"}}}}},
+            {"required", {"answer", "confidence"}},
+            {"additionalProperties", false}};
+}
+
+bool ScalarFunctionBase::HasItemSchema(const nlohmann::json& model_json) {
+    if (!model_json.contains("model_parameters")) {
+        return false;
+    }
+    const auto& parameters = model_json["model_parameters"];
+    return parameters.contains("response_format") || parameters.contains("output_format") ||
+           parameters.contains("format");
+}
+
+void ScalarFunctionBase::SetItemSchema(nlohmann::json& model_json, const nlohmann::json& item_schema) {
+    auto& parameters = model_json["model_parameters"];
+    switch (GetProviderType(model_json.value("provider", std::string()))) {
+        case FLOCKMTL_ANTHROPIC:
+            parameters["output_format"] = {{"schema", item_schema}};
+            break;
+        case FLOCKMTL_OLLAMA:
+            parameters["format"] = item_schema;
+            break;
+        default:
+            parameters["response_format"] = {{"strict", true}, {"json_schema", {{"schema", item_schema}}}};
+    }
+}
+
+nlohmann::ordered_json ScalarFunctionBase::GetItemSchema(const nlohmann::ordered_json& model_json) {
+    if (!model_json.contains("model_parameters")) {
+        return nullptr;
+    }
+    const auto& parameters = model_json["model_parameters"];
+    if (!parameters.contains("response_format") && !parameters.contains("output_format") &&
+        !parameters.contains("format")) {
+        return nullptr;
+    }
+    if (parameters.contains("response_format")) {
+        const auto& response_format = parameters["response_format"];
+        if (response_format.contains("json_schema") && response_format["json_schema"].contains("schema")) {
+            return response_format["json_schema"]["schema"];
+        }
+        return nullptr;
+    }
+    if (parameters.contains("output_format")) {
+        return parameters["output_format"].contains("schema") ? parameters["output_format"]["schema"] : nullptr;
+    }
+    return parameters["format"];
+}
+
+duckdb::LogicalType ScalarFunctionBase::SchemaToLogicalType(const nlohmann::ordered_json& schema) {
+    if (!schema.is_object() || !schema.contains("type")) {
+        return duckdb::LogicalType::JSON();
+    }
+    // A nullable field is typed by its other type
+    std::string type;
+    if (schema["type"].is_string()) {
+        type = schema["type"].get<std::string>();
+    } else if (schema["type"].is_array()) {
+        for (const auto& option: schema["type"]) {
+            if (option.is_string() && option != "null") {
+                type = option.get<std::string>();
+                break;
+            }
+        }
+    }
+
+    if (type == "object") {
+        if (!schema.contains("properties") || !schema["properties"].is_object() || schema["properties"].empty()) {
+            return duckdb::LogicalType::JSON();
+        }
+        duckdb::child_list_t<duckdb::LogicalType> children;
+        for (const auto& property: schema["properties"].items()) {
+            children.emplace_back(property.key(), SchemaToLogicalType(property.value()));
+        }
+        return duckdb::LogicalType::STRUCT(std::move(children));
+    }
+    if (type == "array") {
+        return duckdb::LogicalType::LIST(schema.contains("items") ? SchemaToLogicalType(schema["items"])
+                                                                  : duckdb::LogicalType::JSON());
+    }
+    if (type == "string") {
+        return duckdb::LogicalType::VARCHAR;
+    }
+    if (type == "integer") {
+        return duckdb::LogicalType::BIGINT;
+    }
+    if (type == "number") {
+        return duckdb::LogicalType::DOUBLE;
+    }
+    if (type == "boolean") {
+        return duckdb::LogicalType::BOOLEAN;
+    }
+    return duckdb::LogicalType::JSON();
+}
+
+nlohmann::json ScalarFunctionBase::TypedEmptyValue(const nlohmann::json& empty_value, const duckdb::LogicalType& type) {
+    // The configured value is JSON text, e.g. '0' for an integer or '{"category": "none"}' for an object
+    const auto value = empty_value.is_string() ? nlohmann::json::parse(empty_value.get<std::string>(), nullptr, false)
+                                               : empty_value;
+    bool matches;
+    switch (type.id()) {
+        case duckdb::LogicalTypeId::BOOLEAN:
+            matches = value.is_boolean();
+            break;
+        case duckdb::LogicalTypeId::BIGINT:
+            matches = value.is_number_integer();
+            break;
+        case duckdb::LogicalTypeId::DOUBLE:
+            matches = value.is_number();
+            break;
+        case duckdb::LogicalTypeId::STRUCT:
+            matches = value.is_object();
+            break;
+        case duckdb::LogicalTypeId::LIST:
+            matches = value.is_array();
+            break;
+        default:
+            matches = !value.is_discarded();
+    }
+    if (!matches) {
+        const auto text = empty_value.is_string() ? empty_value.get<std::string>() : empty_value.dump();
+        throw duckdb::BinderException(
+                duckdb_fmt::format("'empty_value' must be a JSON value of the result type {}, got '{}'.",
+                                   type.ToString(), text));
+    }
+    return value;
+}
+
+nlohmann::json ScalarFunctionBase::BatchAndCompleteCascade(const nlohmann::json& tuples, const std::string& user_prompt,
+                                                           const ScalarFunctionType function_type,
+                                                           const LlmFunctionBindData& bind_data) {
+    auto primary_json = bind_data.model_json;
+    SetItemSchema(primary_json, CascadeItemSchema(function_type));
+    Model primary(primary_json);
+    auto responses = BatchAndComplete(tuples, user_prompt, function_type, primary, bind_data.error_policy);
+
+    std::vector<size_t> escalated_rows;
+    for (size_t row = 0; row < responses.size(); row++) {
+        auto& response = responses[row];
+        const bool confident = response.is_object() && response.contains("answer") &&
+                               response.contains("confidence") && response["confidence"].is_number() &&
+                               response["confidence"].get<double>() >= bind_data.cascade_threshold;
+        if (confident) {
+            response = nlohmann::json(response["answer"]);
+        } else {
+            escalated_rows.push_back(row);
+        }
+    }
+    MetricsManager::UpdateCascadeRows(static_cast<int64_t>(responses.size() - escalated_rows.size()),
+                                      static_cast<int64_t>(escalated_rows.size()));
+
+    if (!escalated_rows.empty()) {
+        auto escalation = Model(bind_data.cascade_model_json);
+        const auto escalated = BatchAndComplete(SelectRows(tuples, escalated_rows), user_prompt, function_type,
+                                                escalation, bind_data.error_policy);
+        for (size_t i = 0; i < escalated_rows.size(); i++) {
+            responses[escalated_rows[i]] = escalated[i];
+        }
+    }
+    return responses;
+}
+
+nlohmann::json ScalarFunctionBase::CompleteYesNo(const nlohmann::json& tuples, const std::string& user_prompt,
+                                                 Model& model, const ErrorPolicy error_policy) {
+    const auto row_count = tuples.empty() ? size_t{0} : tuples[0]["data"].size();
+    const auto tuple_format = model.GetModelDetails().tuple_format;
+    const auto add_request = [&](const size_t row) {
+        const auto [prompt, media_data] = PromptManager::Render(user_prompt, SelectRows(tuples, {row}),
+                                                                ScalarFunctionType::YES_NO, tuple_format);
+        model.AddYesNoRequest(prompt, media_data);
+    };
+    const auto probability = [](const nlohmann::json& completion) -> nlohmann::json {
+        if (!completion.contains("items") || !completion["items"].is_array() || completion["items"].empty()) {
+            return nullptr;
+        }
+        return completion["items"][0];
+    };
+
+    auto responses = nlohmann::json::array();
+    for (size_t row = 0; row < row_count; row++) {
+        responses.push_back(nullptr);
+    }
+    if (row_count == 0) {
+        return responses;
+    }
+
+    // Every row is its own one-token request, so they all go out at once
+    try {
+        for (size_t row = 0; row < row_count; row++) {
+            add_request(row);
+        }
+        const auto completions = model.CollectCompletions();
+        for (size_t row = 0; row < row_count && row < completions.size(); row++) {
+            responses[row] = probability(completions[row]);
+        }
+        return responses;
+    } catch (const std::exception&) {
+        if (error_policy == ErrorPolicy::FAIL) {
+            throw;
+        }
+    }
+
+    // Find the failing rows by asking one row at a time
+    for (size_t row = 0; row < row_count; row++) {
+        try {
+            add_request(row);
+            responses[row] = probability(model.CollectCompletions()[0]);
+        } catch (const std::exception&) {
+            responses[row] = nullptr;
+        }
+    }
+    return responses;
+}
+
+nlohmann::json ScalarFunctionBase::CompleteRows(const nlohmann::json& tuples, const std::string& user_prompt,
+                                                const ScalarFunctionType function_type, Model& model,
+                                                const LlmFunctionBindData& bind_data) {
+    nlohmann::json responses;
+    if (bind_data.logprobs) {
+        responses = CompleteYesNo(tuples, user_prompt, model, bind_data.error_policy);
+    } else if (bind_data.checkpoint) {
+        responses = BatchAndCompleteWithCheckpoint(tuples, user_prompt, function_type, model, bind_data);
+    } else if (bind_data.HasCascade()) {
+        responses = BatchAndCompleteCascade(tuples, user_prompt, function_type, bind_data);
+    } else {
+        responses = BatchAndComplete(tuples, user_prompt, function_type, model, bind_data.error_policy);
+    }
+
+    if (bind_data.error_policy != ErrorPolicy::FAIL) {
+        const auto failed_rows = std::count_if(responses.begin(), responses.end(),
+                                               [](const nlohmann::json& response) { return response.is_null(); });
+        if (failed_rows > 0) {
+            MetricsManager::UpdateFailedRows(failed_rows);
+        }
+    }
+    return responses;
+}
+
+nlohmann::json ScalarFunctionBase::CompleteWithoutContext(const std::string& prompt, const OutputType output_type,
+                                                          Model& model, const LlmFunctionBindData& bind_data) {
+    auto& constant = *bind_data.constant_response;
+    // Hold the lock while asking, so threads that arrive meanwhile wait for the one request instead of sending their own
+    std::lock_guard<std::mutex> lock(constant.mutex);
+    if (!constant.response) {
+        try {
+            if (bind_data.logprobs) {
+                model.AddYesNoRequest(duckdb_fmt::format("{}\n\n{}", prompt, RESPONSE_FORMAT::YES_NO));
+            } else {
+                model.AddCompletionRequest(prompt, 1, output_type);
+            }
+            constant.response = model.CollectCompletions()[0]["items"][0];
+        } catch (const std::exception&) {
+            if (bind_data.error_policy == ErrorPolicy::FAIL) {
+                throw;
+            }
+            // Not memoized, so the next chunk asks again
+            MetricsManager::UpdateFailedRows(1);
+            return nullptr;
+        }
+    }
+    return *constant.response;
+}
+
+std::vector<size_t> ScalarFunctionBase::RowsWithContext(const nlohmann::json& tuples) {
+    const auto num_rows = tuples.empty() ? 0 : tuples[0]["data"].size();
+    std::vector<size_t> rows;
+    rows.reserve(num_rows);
+    for (size_t row = 0; row < num_rows; row++) {
+        for (const auto& column: tuples) {
+            const auto& value = column["data"][row];
+            if (!value.is_null() && !(value.is_string() && value.get_ref<const std::string&>().empty())) {
+                rows.push_back(row);
+                break;
+            }
+        }
+    }
+    return rows;
+}
+
+std::pair<std::vector<size_t>, nlohmann::json> ScalarFunctionBase::CompleteRowsWithContext(
+        const nlohmann::json& tuples, const std::string& user_prompt, const ScalarFunctionType function_type,
+        Model& model, const LlmFunctionBindData& bind_data) {
+    auto rows = RowsWithContext(tuples);
+    if (rows.empty()) {
+        return {std::move(rows), nlohmann::json::array()};
+    }
+    if (rows.size() == tuples[0]["data"].size()) {
+        return {std::move(rows), CompleteRows(tuples, user_prompt, function_type, model, bind_data)};
+    }
+    auto responses = CompleteRows(SelectRows(tuples, rows), user_prompt, function_type, model, bind_data);
+    return {std::move(rows), std::move(responses)};
+}
+
+void ScalarFunctionBase::WriteStringResults(const std::vector<std::optional<std::string>>& results,
+                                            duckdb::Vector& result, const idx_t count) {
+    if (results.size() == 1) {
+        result.SetVectorType(duckdb::VectorType::CONSTANT_VECTOR);
+        if (results[0].has_value()) {
+            duckdb::ConstantVector::GetData<duckdb::string_t>(result)[0] =
+                    duckdb::StringVector::AddString(result, *results[0]);
+        } else {
+            duckdb::ConstantVector::SetNull(result, true);
+        }
+        return;
+    }
+
+    result.SetVectorType(duckdb::VectorType::FLAT_VECTOR);
+    auto data = duckdb::FlatVector::GetData<duckdb::string_t>(result);
+    auto& validity = duckdb::FlatVector::Validity(result);
+    for (idx_t i = 0; i < count; i++) {
+        if (i < results.size() && results[i].has_value()) {
+            data[i] = duckdb::StringVector::AddString(result, *results[i]);
+        } else {
+            validity.SetInvalid(i);
+        }
+    }
+}
+
+namespace {
+
+void WriteTypedValue(const nlohmann::json& value, duckdb::Vector& vector, const idx_t row) {
+    const auto& type = vector.GetType();
+    // Nested values may arrive as JSON text
+    auto nested = value;
+    if (value.is_string() && (type.id() == duckdb::LogicalTypeId::STRUCT || type.id() == duckdb::LogicalTypeId::LIST)) {
+        nested = nlohmann::json::parse(value.get<std::string>(), nullptr, false);
+    }
+
+    switch (type.id()) {
+        case duckdb::LogicalTypeId::VARCHAR:
+            if (value.is_null()) {
+                break;
+            }
+            duckdb::FlatVector::GetData<duckdb::string_t>(vector)[row] =
+                    duckdb::StringVector::AddString(vector, value.is_string() ? value.get<std::string>() : value.dump());
+            return;
+        case duckdb::LogicalTypeId::BOOLEAN:
+            if (!value.is_boolean()) {
+                break;
+            }
+            duckdb::FlatVector::GetData<bool>(vector)[row] = value.get<bool>();
+            return;
+        case duckdb::LogicalTypeId::BIGINT:
+            if (!value.is_number()) {
+                break;
+            }
+            duckdb::FlatVector::GetData<int64_t>(vector)[row] =
+                    value.is_number_float() ? static_cast<int64_t>(value.get<double>()) : value.get<int64_t>();
+            return;
+        case duckdb::LogicalTypeId::DOUBLE:
+            if (!value.is_number()) {
+                break;
+            }
+            duckdb::FlatVector::GetData<double>(vector)[row] = value.get<double>();
+            return;
+        case duckdb::LogicalTypeId::STRUCT: {
+            if (!nested.is_object()) {
+                break;
+            }
+            auto& entries = duckdb::StructVector::GetEntries(vector);
+            for (idx_t i = 0; i < entries.size(); i++) {
+                const auto& name = duckdb::StructType::GetChildName(type, i);
+                WriteTypedValue(nested.contains(name) ? nested[name] : nlohmann::json(), *entries[i], row);
+            }
+            return;
+        }
+        case duckdb::LogicalTypeId::LIST: {
+            if (!nested.is_array()) {
+                break;
+            }
+            const auto offset = duckdb::ListVector::GetListSize(vector);
+            duckdb::ListVector::Reserve(vector, offset + nested.size());
+            auto& child = duckdb::ListVector::GetEntry(vector);
+            for (idx_t i = 0; i < nested.size(); i++) {
+                WriteTypedValue(nested[i], child, offset + i);
+            }
+            duckdb::ListVector::SetListSize(vector, offset + nested.size());
+            duckdb::FlatVector::GetData<duckdb::list_entry_t>(vector)[row] = duckdb::list_entry_t(offset, nested.size());
+            return;
+        }
+        default:
+            break;
+    }
+    if (type.id() == duckdb::LogicalTypeId::LIST) {
+        duckdb::FlatVector::GetData<duckdb::list_entry_t>(vector)[row] =
+                duckdb::list_entry_t(duckdb::ListVector::GetListSize(vector), 0);
+    }
+    duckdb::FlatVector::SetNull(vector, row, true);
+}
+
+}// namespace
+
+void ScalarFunctionBase::WriteTypedResults(const std::vector<std::optional<nlohmann::json>>& results,
+                                           duckdb::Vector& result, const idx_t count) {
+    result.SetVectorType(duckdb::VectorType::FLAT_VECTOR);
+    for (idx_t i = 0; i < count; i++) {
+        // A single result answers every row
+        const auto& row_result = results.size() == 1 ? results[0] : i < results.size() ? results[i] : std::nullopt;
+        WriteTypedValue(row_result ? *row_result : nlohmann::json(), result, i);
+    }
+}
+
+void ScalarFunctionBase::WriteListResults(const std::vector<std::vector<double>>& results, duckdb::Vector& result,
+                                          const idx_t count) {
+    result.SetVectorType(duckdb::VectorType::FLAT_VECTOR);
+    auto offset = duckdb::ListVector::GetListSize(result);
+    idx_t total = offset;
+    for (idx_t i = 0; i < count && i < results.size(); i++) {
+        total += results[i].size();
+    }
+    duckdb::ListVector::Reserve(result, total);
+
+    auto entries = duckdb::FlatVector::GetData<duckdb::list_entry_t>(result);
+    auto& validity = duckdb::FlatVector::Validity(result);
+    auto values = duckdb::FlatVector::GetData<double>(duckdb::ListVector::GetEntry(result));
+    for (idx_t i = 0; i < count; i++) {
+        if (i >= results.size()) {
+            entries[i] = duckdb::list_entry_t(offset, 0);
+            validity.SetInvalid(i);
+            continue;
+        }
+        entries[i] = duckdb::list_entry_t(offset, results[i].size());
+        std::copy(results[i].begin(), results[i].end(), values + offset);
+        offset += results[i].size();
+    }
+    duckdb::ListVector::SetListSize(result, offset);
+}
+
 void ScalarFunctionBase::InitializePrompt(
         duckdb::ClientContext& context,
         const duckdb::unique_ptr<duckdb::Expression>& prompt_expr,
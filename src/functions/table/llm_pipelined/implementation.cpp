@@ -0,0 +1,281 @@
+#include "flock/functions/table/llm_pipelined.hpp"
+#include "flock/functions/input_parser.hpp"
+#include "flock/functions/scalar/llm_complete.hpp"
+#include "flock/functions/scalar/llm_embedding.hpp"
+#include "flock/functions/scalar/llm_filter.hpp"
+#include "flock/metrics/manager.hpp"
+#include "flock/prompt_manager/prompt_manager.hpp"
+
+#include <algorithm>
+
+namespace flock {
+
+duckdb::TableFunction LlmPipelined::GetFunction(const std::string& name, FunctionType function_type) {
+    duckdb::vector<duckdb::LogicalType> arguments = {duckdb::LogicalType::TABLE, duckdb::LogicalType::ANY};
+    if (function_type != FunctionType::LLM_EMBEDDING) {
+        arguments.push_back(duckdb::LogicalType::ANY);
+    }
+
+    duckdb::TableFunction function(name, arguments, nullptr, Bind, nullptr, InitLocal);
+    function.in_out_function = Execute;
+    function.in_out_function_final = Finalize;
+    function.named_parameters["context_columns"] = duckdb::LogicalType::LIST(duckdb::LogicalType::VARCHAR);
+    function.named_parameters["lookahead"] = duckdb::LogicalType::BIGINT;
+    function.named_parameters["flush_after_ms"] = duckdb::LogicalType::BIGINT;
+    function.function_info = duckdb::make_shared_ptr<LlmPipelinedInfo>(function_type);
+    return function;
+}
+
+duckdb::unique_ptr<duckdb::FunctionData> LlmPipelined::Bind(duckdb::ClientContext& context,
+                                                            duckdb::TableFunctionBindInput& input,
+                                                            duckdb::vector<duckdb::LogicalType>& return_types,
+                                                            duckdb::vector<std::string>& names) {
+    auto bind_data = duckdb::make_uniq<LlmPipelinedBindData>();
+    bind_data->function_type = input.info->Cast<LlmPipelinedInfo>().function_type;
+    const auto function_name = input.table_function.name;
+
+    // inputs[0] is the placeholder of the input table
+    const auto& model_value = input.inputs[1];
+    if (model_value.type().id() != duckdb::LogicalTypeId::STRUCT) {
+        throw duckdb::BinderException(function_name + ": Second argument must be model (struct type)");
+    }
+    ScalarFunctionBase::InitializeModelJson(model_value, bind_data->llm);
+    if (bind_data->llm.HasCascade() && bind_data->function_type == FunctionType::LLM_EMBEDDING) {
+        throw duckdb::BinderException(function_name + ": 'cascade' is only supported by completions and filters");
+    }
+    if (bind_data->llm.logprobs && bind_data->function_type != FunctionType::LLM_FILTER) {
+        throw duckdb::BinderException(function_name + ": 'logprobs' is only supported by filters");
+    }
+
+    if (bind_data->function_type != FunctionType::LLM_EMBEDDING) {
+        const auto& prompt_value = input.inputs[2];
+        if (prompt_value.type().id() != duckdb::LogicalTypeId::STRUCT) {
+            throw duckdb::BinderException(function_name + ": Third argument must be prompt (struct type)");
+        }
+        auto prompt_json = CastValueToJson(prompt_value);
+        if (prompt_json.contains("context_columns")) {
+            throw duckdb::BinderException(function_name +
+                                          ": Pass the input column names with the 'context_columns' named parameter");
+        }
+        bind_data->llm.prompt = PromptManager::CreatePromptDetails(prompt_json).prompt;
+    }
+
+    // Every input column is context unless a subset is named
+    auto context_columns_param = input.named_parameters.find("context_columns");
+    if (context_columns_param != input.named_parameters.end()) {
+        for (const auto& child: duckdb::ListValue::GetChildren(context_columns_param->second)) {
+            bind_data->context_column_names.push_back(child.ToString());
+        }
+    } else {
+        bind_data->context_column_names = input.input_table_names;
+    }
+    if (bind_data->context_column_names.empty()) {
+        throw duckdb::BinderException(function_name + ": At least one context column is required");
+    }
+    for (const auto& column_name: bind_data->context_column_names) {
+        auto it = std::find_if(input.input_table_names.begin(), input.input_table_names.end(),
+                               [&](const std::string& name) { return duckdb::StringUtil::CIEquals(name, column_name); });
+        if (it == input.input_table_names.end()) {
+            throw duckdb::BinderException(function_name + ": Unknown context column '" + column_name + "'");
+        }
+        bind_data->context_column_indexes.push_back(static_cast<duckdb::idx_t>(it - input.input_table_names.begin()));
+    }
+
+    bind_data->lookahead = DEFAULT_LOOKAHEAD;
+    auto lookahead_param = input.named_parameters.find("lookahead");
+    if (lookahead_param != input.named_parameters.end()) {
+        auto lookahead = lookahead_param->second.GetValue<int64_t>();
+        if (lookahead < 0) {
+            throw duckdb::BinderException(function_name + ": 'lookahead' must not be negative");
+        }
+        bind_data->lookahead = static_cast<duckdb::idx_t>(lookahead);
+    }
+
+    bind_data->flush_after_ms = DEFAULT_FLUSH_AFTER_MS;
+    auto flush_after_param = input.named_parameters.find("flush_after_ms");
+    if (flush_after_param != input.named_parameters.end()) {
+        bind_data->flush_after_ms = flush_after_param->second.GetValue<int64_t>();
+        if (bind_data->flush_after_ms < 0) {
+            throw duckdb::BinderException(function_name + ": 'flush_after_ms' must not be negative");
+        }
+    }
+    const auto batch_size = bind_data->llm.model_json.value("batch_size", 0);
+    bind_data->batch_rows = batch_size > 0 ? static_cast<duckdb::idx_t>(batch_size) : STANDARD_VECTOR_SIZE;
+
+    for (const auto& name: input.input_table_names) {
+        if (duckdb::StringUtil::CIEquals(name, RESULT_COLUMN)) {
+            throw duckdb::BinderException(function_name + ": Input already has a column named '" +
+                                          std::string(RESULT_COLUMN) + "'");
+        }
+    }
+    return_types = input.input_table_types;
+    names = input.input_table_names;
+    switch (bind_data->function_type) {
+        case FunctionType::LLM_EMBEDDING:
+            return_types.push_back(duckdb::LogicalType::LIST(duckdb::LogicalType::DOUBLE));
+            break;
+        case FunctionType::LLM_FILTER:
+            return_types.push_back(duckdb::LogicalType::BOOLEAN);
+            break;
+        default:
+            return_types.push_back(duckdb::LogicalType::VARCHAR);
+    }
+    names.emplace_back(RESULT_COLUMN);
+
+    return std::move(bind_data);
+}
+
+duckdb::unique_ptr<duckdb::LocalTableFunctionState> LlmPipelined::InitLocal(duckdb::ExecutionContext& context,
+                                                                            duckdb::TableFunctionInitInput& input,
+                                                                            duckdb::GlobalTableFunctionState* global_state) {
+    return duckdb::make_uniq<LlmPipelinedLocalState>();
+}
+
+void LlmPipelined::AppendContextColumns(duckdb::DataChunk& chunk, const LlmPipelinedBindData& bind_data,
+                                        nlohmann::json& context_columns) {
+    if (context_columns.empty()) {
+        for (const auto& column_name: bind_data.context_column_names) {
+            context_columns.push_back({{"name", column_name}, {"data", nlohmann::json::array()}});
+        }
+    }
+    for (size_t i = 0; i < bind_data.context_column_indexes.size(); i++) {
+        AppendVectorAsStrings(chunk.data[bind_data.context_column_indexes[i]], chunk.size(), context_columns[i]["data"]);
+    }
+}
+
+std::vector<duckdb::Value> LlmPipelined::Operation(duckdb::DatabaseInstance* db, const LlmPipelinedBindData& bind_data,
+                                                   const nlohmann::json& context_columns) {
+    // The metrics context is thread local, so each worker starts its own invocation
+    const void* invocation_id = MetricsManager::GenerateUniqueId();
+    MetricsManager::StartInvocation(db, invocation_id, bind_data.function_type);
+
+    auto exec_start = std::chrono::high_resolution_clock::now();
+
+    std::vector<duckdb::Value> results;
+    switch (bind_data.function_type) {
+        case FunctionType::LLM_COMPLETE:
+            for (const auto& res: LlmComplete::Operation(context_columns, &bind_data.llm)) {
+                results.push_back(res.has_value() ? duckdb::Value(*res) : duckdb::Value(duckdb::LogicalType::VARCHAR));
+            }
+            break;
+        case FunctionType::LLM_FILTER:
+            for (const auto& res: LlmFilter::Operation(context_columns, &bind_data.llm)) {
+                results.push_back(res.has_value() ? duckdb::Value::BOOLEAN(*res) : duckdb::Value(duckdb::LogicalType::BOOLEAN));
+            }
+            break;
+        case FunctionType::LLM_EMBEDDING:
+            for (const auto& res: LlmEmbedding::Operation(context_columns, &bind_data.llm)) {
+                duckdb::vector<duckdb::Value> values(res.begin(), res.end());
+                results.push_back(duckdb::Value::LIST(duckdb::LogicalType::DOUBLE, std::move(values)));
+            }
+            break;
+        default:
+            throw std::runtime_error("Unsupported function type for pipelined execution");
+    }
+
+    auto exec_end = std::chrono::high_resolution_clock::now();
+    double exec_duration_ms = std::chrono::duration<double, std::milli>(exec_end - exec_start).count();
+    MetricsManager::AddExecutionTime(exec_duration_ms);
+    MetricsManager::ClearContext();
+
+    return results;
+}
+
+void LlmPipelined::Buffer(duckdb::ExecutionContext& context, LlmPipelinedLocalState& state,
+                          duckdb::DataChunk& input) {
+    // The input chunk is only valid during this call, so its rows are copied into chunks owned by the state
+    if (state.buffer.empty() || state.buffer.back()->size() + input.size() > STANDARD_VECTOR_SIZE) {
+        auto chunk = duckdb::make_uniq<duckdb::DataChunk>();
+        chunk->Initialize(duckdb::Allocator::Get(context.client), input.GetTypes());
+        state.buffer.push_back(std::move(chunk));
+    }
+    if (state.buffered_rows == 0) {
+        state.buffer_started = std::chrono::steady_clock::now();
+    }
+    state.buffer.back()->Append(input);
+    state.buffered_rows += input.size();
+}
+
+void LlmPipelined::Flush(duckdb::ExecutionContext& context, const LlmPipelinedBindData& bind_data,
+                         LlmPipelinedLocalState& state) {
+    LlmPipelinedLocalState::PendingBatch batch;
+    batch.chunks = std::move(state.buffer);
+    state.buffer.clear();
+    state.buffered_rows = 0;
+
+    auto context_columns = nlohmann::json::array();
+    for (auto& chunk: batch.chunks) {
+        AppendContextColumns(*chunk, bind_data, context_columns);
+    }
+    auto* db = context.client.db.get();
+    batch.results = std::async(std::launch::async, [db, &bind_data, context_columns = std::move(context_columns)]() {
+        return Operation(db, bind_data, context_columns);
+    });
+    state.pending.push_back(std::move(batch));
+}
+
+bool LlmPipelined::Emit(LlmPipelinedLocalState& state, duckdb::DataChunk& output) {
+    auto& batch = state.pending.front();
+    if (batch.results.valid()) {
+        batch.ready = batch.results.get();
+    }
+
+    auto& input = *batch.chunks[batch.next_chunk++];
+    for (duckdb::idx_t col = 0; col < input.ColumnCount(); col++) {
+        output.data[col].Reference(input.data[col]);
+    }
+    auto& result = output.data[input.ColumnCount()];
+    for (duckdb::idx_t row = 0; row < input.size(); row++) {
+        const auto index = batch.next_row + row;
+        result.SetValue(row, index < batch.ready.size() ? batch.ready[index] : duckdb::Value(result.GetType()));
+    }
+    output.SetCardinality(input.size());
+    batch.next_row += input.size();
+
+    if (batch.next_chunk < batch.chunks.size()) {
+        return true;
+    }
+    state.pending.pop_front();
+    return false;
+}
+
+duckdb::OperatorResultType LlmPipelined::Execute(duckdb::ExecutionContext& context, duckdb::TableFunctionInput& data,
+                                                 duckdb::DataChunk& input, duckdb::DataChunk& output) {
+    auto& bind_data = data.bind_data->Cast<LlmPipelinedBindData>();
+    auto& state = data.local_state->Cast<LlmPipelinedLocalState>();
+
+    if (!state.input_buffered && input.size() > 0) {
+        Buffer(context, state, input);
+        // The deadline is only checked when rows arrive; whatever is left is flushed in Finalize
+        const auto waited_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                       std::chrono::steady_clock::now() - state.buffer_started)
+                                       .count();
+        if (state.buffered_rows >= bind_data.batch_rows || waited_ms >= bind_data.flush_after_ms) {
+            Flush(context, bind_data, state);
+        }
+    }
+    // Only wait for the oldest batch once the look-ahead window is full
+    if (state.pending.size() > bind_data.lookahead && Emit(state, output)) {
+        state.input_buffered = true;
+        return duckdb::OperatorResultType::HAVE_MORE_OUTPUT;
+    }
+    state.input_buffered = false;
+    return duckdb::OperatorResultType::NEED_MORE_INPUT;
+}
+
+duckdb::OperatorFinalizeResultType LlmPipelined::Finalize(duckdb::ExecutionContext& context,
+                                                          duckdb::TableFunctionInput& data, duckdb::DataChunk& output) {
+    auto& bind_data = data.bind_data->Cast<LlmPipelinedBindData>();
+    auto& state = data.local_state->Cast<LlmPipelinedLocalState>();
+    if (!state.buffer.empty()) {
+        Flush(context, bind_data, state);
+    }
+    if (state.pending.empty()) {
+        return duckdb::OperatorFinalizeResultType::FINISHED;
+    }
+    Emit(state, output);
+    return state.pending.empty() ? duckdb::OperatorFinalizeResultType::FINISHED
+                                 : duckdb::OperatorFinalizeResultType::HAVE_MORE_OUTPUT;
+}
+
+}// namespace flock
@@ -0,0 +1,12 @@
+#include "flock/registry/registry.hpp"
+#include "flock/functions/table/llm_pipelined.hpp"
+
+namespace flock {
+
+void TableRegistry::RegisterLlmPipelined(duckdb::ExtensionLoader& loader) {
+    loader.RegisterFunction(LlmPipelined::GetFunction("llm_complete_pipelined", FunctionType::LLM_COMPLETE));
+    loader.RegisterFunction(LlmPipelined::GetFunction("llm_filter_pipelined", FunctionType::LLM_FILTER));
+    loader.RegisterFunction(LlmPipelined::GetFunction("llm_embedding_pipelined", FunctionType::LLM_EMBEDDING));
+}
+
+}// namespace flock
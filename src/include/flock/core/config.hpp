@@ -4,6 +4,7 @@
 #include "flock/core/common.hpp"
 #include "flock/registry/registry.hpp"
 #include <fmt/format.h>
+#include <mutex>
 
 namespace flock {
 
@@ -26,6 +27,10 @@ public:
     static std::string get_default_models_table_name();
     static std::string get_user_defined_models_table_name();
     static std::string get_prompts_table_name();
+    static std::string get_semantic_views_table_name();
+    static std::string get_semantic_view_results_table_name();
+    static std::string get_reduce_state_table_name();
+    static std::string get_checkpoint_table_name();
     static void AttachToGlobalStorage(duckdb::Connection& con, bool read_only = true);
     static void DetachFromGlobalStorage(duckdb::Connection& con);
 
@@ -50,10 +55,26 @@ public:
         void Wait(int milliseconds);
     };
 
+    // StorageAttachmentGuard for code that runs while a query executes, possibly on several worker threads.
+    // The flock_storage alias is shared by the whole database instance, so these attachments take turns.
+    class ExclusiveStorageGuard {
+    public:
+        ExclusiveStorageGuard(duckdb::Connection& con, bool read_only = true);
+
+    private:
+        static std::mutex& Mutex();
+
+        std::lock_guard<std::mutex> lock;
+        StorageAttachmentGuard guard;
+    };
+
 private:
     static void SetupGlobalStorageLocation();
     static void ConfigSchema(duckdb::Connection& con, std::string& schema_name);
     static void ConfigPromptTable(duckdb::Connection& con, std::string& schema_name, ConfigType type);
+    static void ConfigSemanticViewTables(duckdb::Connection& con, std::string& schema_name, ConfigType type);
+    static void ConfigReduceStateTable(duckdb::Connection& con, std::string& schema_name, ConfigType type);
+    static void ConfigCheckpointTable(duckdb::Connection& con, std::string& schema_name, ConfigType type);
     static void ConfigModelTable(duckdb::Connection& con, std::string& schema_name, ConfigType type);
     static void SetupDefaultModelsConfig(duckdb::Connection& con, std::string& schema_name);
     static void SetupUserDefinedModelsConfig(duckdb::Connection& con, std::string& schema_name);
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "flock/core/common.hpp"
+#include "flock/custom_parser/query_statements.hpp"
+#include "flock/custom_parser/tokenizer.hpp"
+
+#include "fmt/format.h"
+#include <nlohmann/json.hpp>
+
+namespace flock {
+
+// Specific semantic view statements
+class CreateSemanticViewStatement : public QueryStatement {
+public:
+    CreateSemanticViewStatement() { type = StatementType::CREATE_SEMANTIC_VIEW; }
+    std::string view_name;
+    std::string source_table;
+    std::string key_column;
+    // {"model": {...}, "prompt": {...}, "context_columns": ["col", ...], "output_column": "..."}
+    nlohmann::json definition;
+};
+
+class RefreshSemanticViewStatement : public QueryStatement {
+public:
+    RefreshSemanticViewStatement() { type = StatementType::REFRESH_SEMANTIC_VIEW; }
+    std::string view_name;
+};
+
+class DeleteSemanticViewStatement : public QueryStatement {
+public:
+    DeleteSemanticViewStatement() { type = StatementType::DELETE_SEMANTIC_VIEW; }
+    std::string view_name;
+};
+
+class GetSemanticViewStatement : public QueryStatement {
+public:
+    GetSemanticViewStatement() { type = StatementType::GET_SEMANTIC_VIEW; }
+    std::string view_name;
+};
+
+class GetAllSemanticViewStatement : public QueryStatement {
+public:
+    GetAllSemanticViewStatement() { type = StatementType::GET_ALL_SEMANTIC_VIEW; }
+};
+
+// A semantic view materializes llm_complete over a source table. Results are stored with a hash of
+// their inputs, so a refresh only calls the model for rows that are new or whose inputs changed.
+class SemanticViewParser {
+public:
+    static constexpr auto DEFAULT_OUTPUT_COLUMN = "llm_result";
+    static constexpr int64_t REFRESH_CHUNK_ROWS = 256;// Results committed per refresh statement
+
+    void Parse(const std::string& query, std::unique_ptr<QueryStatement>& statement);
+    std::string ToSQL(const QueryStatement& statement) const;
+
+    // Validate a view definition and fill in defaults
+    static nlohmann::json ValidateDefinition(const nlohmann::json& definition);
+    // Render a JSON object as a DuckDB struct literal, e.g. {'model_name': 'gpt-4o'}
+    static std::string JsonToStructLiteral(const nlohmann::json& value);
+
+private:
+    void ParseCreateSemanticView(Tokenizer& tokenizer, std::unique_ptr<QueryStatement>& statement);
+    void ParseRefreshSemanticView(Tokenizer& tokenizer, std::unique_ptr<QueryStatement>& statement);
+    void ParseDeleteSemanticView(Tokenizer& tokenizer, std::unique_ptr<QueryStatement>& statement);
+    void ParseGetSemanticView(Tokenizer& tokenizer, std::unique_ptr<QueryStatement>& statement);
+    // Consume 'SEMANTIC VIEW[S]' and return the upper-cased 'VIEW' or 'VIEWS' keyword
+    static std::string ExpectSemanticView(Tokenizer& tokenizer);
+};
+
+}// namespace flock
@@ -4,6 +4,7 @@
 #include "flock/core/config.hpp"
 #include "flock/custom_parser/query/model_parser.hpp"
 #include "flock/custom_parser/query/prompt_parser.hpp"
+#include "flock/custom_parser/query/semantic_view_parser.hpp"
 #include "flock/custom_parser/query_statements.hpp"
 #include "flock/custom_parser/tokenizer.hpp"
 
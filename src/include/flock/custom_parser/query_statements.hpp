@@ -18,6 +18,11 @@ enum class StatementType {
     UPDATE_PROMPT_SCOPE,
     GET_PROMPT,
     GET_ALL_PROMPT,
+    CREATE_SEMANTIC_VIEW,
+    REFRESH_SEMANTIC_VIEW,
+    DELETE_SEMANTIC_VIEW,
+    GET_SEMANTIC_VIEW,
+    GET_ALL_SEMANTIC_VIEW,
 };
 
 // Abstract base class for statements
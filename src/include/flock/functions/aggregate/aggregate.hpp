@@ -7,6 +7,8 @@
 #include "flock/model_manager/model.hpp"
 #include <nlohmann/json.hpp>
 #include <optional>
+#include <unordered_map>
+#include <vector>
 
 namespace flock {
 
@@ -89,25 +91,43 @@ public:
 
         auto state_map_p = reinterpret_cast<AggregateFunctionState**>(duckdb::FlatVector::GetData<duckdb::data_ptr_t>(states));
 
+        // Group the rows by state so each group gets one update with all of its rows, in input order
+        std::vector<AggregateFunctionState*> order;
+        std::unordered_map<AggregateFunctionState*, std::vector<idx_t>> rows_by_state;
         for (idx_t i = 0; i < count; i++) {
             auto state = state_map_p[i];
-            auto tuple = nlohmann::json::array();
-            auto idx = 0u;
+            if (!state) {
+                continue;
+            }
+            auto [it, inserted] = rows_by_state.try_emplace(state);
+            if (inserted) {
+                order.push_back(state);
+            }
+            it->second.push_back(i);
+        }
+
+        for (auto state: order) {
+            const auto& rows = rows_by_state[state];
+            if (rows.size() == count) {
+                state->Update(columns);
+                continue;
+            }
+
+            auto tuples = nlohmann::json::array();
             for (const auto& column: columns) {
-                tuple.push_back(nlohmann::json::object());
+                auto tuple = nlohmann::json::object();
                 for (const auto& item: column.items()) {
-                    if (item.key() == "data") {
-                        tuple[idx][item.key()].push_back(item.value()[i]);
-                    } else {
-                        tuple[idx][item.key()] = item.value();
+                    if (item.key() != "data") {
+                        tuple[item.key()] = item.value();
                     }
                 }
-                idx++;
-            }
-
-            if (state) {
-                state->Update(tuple);
+                auto& data = tuple["data"] = nlohmann::json::array();
+                for (const auto row: rows) {
+                    data.push_back(column["data"][row]);
+                }
+                tuples.push_back(std::move(tuple));
             }
+            state->Update(tuples);
         }
     }
 
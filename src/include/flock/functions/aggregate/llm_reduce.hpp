@@ -3,6 +3,8 @@
 #include "flock/functions/aggregate/aggregate.hpp"
 #include "flock/functions/llm_function_bind_data.hpp"
 
+#include <optional>
+
 namespace flock {
 
 class LlmReduce : public AggregateFunctionBase {
@@ -10,7 +12,36 @@ public:
     explicit LlmReduce() = default;
 
     nlohmann::json ReduceBatch(nlohmann::json& tuples, const AggregateFunctionType& function_type, const nlohmann::json& summary);
-    nlohmann::json ReduceLoop(const nlohmann::json& tuples, const AggregateFunctionType& function_type);
+    nlohmann::json ReduceLoop(const nlohmann::json& tuples, const AggregateFunctionType& function_type,
+                              const nlohmann::json& initial_summary = "");
+
+    // Incremental mode is enabled by a context column with this name; its values order the rows, and only rows
+    // that were not folded into the stored summary yet are sent to the model
+    static constexpr auto WATERMARK_COLUMN = "flock_watermark";
+    // Context column identifying the persisted state, typically the GROUP BY key. Required in incremental mode,
+    // and every row of a group must carry the same non-NULL value.
+    static constexpr auto STATE_KEY_COLUMN = "flock_state_key";
+
+    struct IncrementalInput {
+        std::string state_key;
+        std::vector<std::string> watermarks;// One per row, empty for NULL
+        nlohmann::json tuples;              // Context columns without the reserved ones
+    };
+
+    // Highest watermark folded into a summary. Rows at exactly that watermark may still arrive later, so the
+    // hashes of the ones already folded in are kept to tell them apart.
+    struct Watermark {
+        std::string value;
+        std::vector<std::string> boundary_rows;
+    };
+
+    static std::optional<IncrementalInput> SplitIncrementalColumns(const nlohmann::json& tuples);
+    // Keep the rows above the stored watermark and the rows at it that were not folded in yet,
+    // and report the watermark to store afterwards
+    static nlohmann::json SelectNewRows(const IncrementalInput& input, const Watermark& stored,
+                                        Watermark& max_watermark);
+    // Numeric comparison when both sides are numbers, lexicographic otherwise (e.g. ISO timestamps)
+    static int CompareWatermarks(const std::string& lhs, const std::string& rhs);
 
 public:
     static duckdb::unique_ptr<duckdb::FunctionData> Bind(
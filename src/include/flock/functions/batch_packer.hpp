@@ -0,0 +1,52 @@
+#pragma once
+
+#include "flock/core/common.hpp"
+#include "flock/model_manager/repository.hpp"
+#include "flock/prompt_manager/repository.hpp"
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+
+namespace flock {
+
+struct PackingBudget {
+    int max_rows = 0;                 // The model's batch_size, or less after output overflows
+    int64_t max_input_tokens = 0;     // Context window left for the tuples and the answers to them
+    int64_t max_output_tokens = 0;    // Completion budget of one request
+    int64_t output_tokens_per_row = 0;// Observed for completions once the model has answered, see OutputBudget
+};
+
+// Splits the rows of a chunk into requests by estimated token counts instead of a fixed row count. Rows are
+// packed shortest first, so each request holds rows of similar length, and a request is closed as soon as the
+// next row would overflow the context window or the output budget.
+class BatchPacker {
+public:
+    static constexpr int64_t DEFAULT_MAX_OUTPUT_TOKENS = 4096;
+    static constexpr int64_t PROMPT_OVERHEAD_TOKENS = 512;// Meta prompt and response format instructions
+    static constexpr int64_t CELL_OVERHEAD_TOKENS = 4;    // Tags or delimiters around each serialized value
+    static constexpr int64_t COMPLETE_OUTPUT_TOKENS_PER_ROW = 32;
+    static constexpr int64_t FILTER_OUTPUT_TOKENS_PER_ROW = 4;
+
+    // Tokens of a value for the given model, see TokenCounter; without a model about four characters per token
+    static int64_t EstimateTokens(const std::string& text, const std::string& model = "");
+    static std::vector<int64_t> EstimateRowTokens(const nlohmann::json& tuples, const std::string& model = "");
+
+    static int64_t ContextWindow(const ModelDetails& model_details);
+    static int64_t MaxOutputTokens(const ModelDetails& model_details);
+    static PackingBudget Budget(const ModelDetails& model_details, const std::string& user_prompt,
+                                ScalarFunctionType function_type);
+
+    // Batch sizes learned from output overflows, per model and function, for the rest of the process. A batch of
+    // rows that overflowed limits later batches to half of it; without an overflow max_rows is returned as is.
+    // Scalar functions whose model schema changes the item type, like the cascade's first pass, learn separately.
+    static int LearnedMaxRows(const ModelDetails& model_details, const std::string& function, int max_rows);
+    static void RecordOverflow(const ModelDetails& model_details, const std::string& function, int rows);
+    static int LearnedMaxRows(const ModelDetails& model_details, ScalarFunctionType function_type, int max_rows);
+    static void RecordOverflow(const ModelDetails& model_details, ScalarFunctionType function_type, int rows);
+    static void ClearLearnedMaxRows();
+
+    // Row indexes of each request; every row appears in exactly one request, in ascending order within it
+    static std::vector<std::vector<size_t>> Pack(const std::vector<int64_t>& row_tokens, const PackingBudget& budget);
+};
+
+}// namespace flock
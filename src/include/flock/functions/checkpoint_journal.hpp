@@ -0,0 +1,29 @@
+#pragma once
+
+#include "flock/core/common.hpp"
+#include "flock/prompt_manager/repository.hpp"
+#include <nlohmann/json.hpp>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace flock {
+
+// Durable per-row results of checkpointed LLM calls, stored in the global storage. Rows are identified by a
+// hash of their context column values and requests by a hash of the model, prompt and function, so re-running
+// the same query skips every row that already completed. Safe to call from several query threads at once.
+class CheckpointJournal {
+public:
+    static std::string RequestHash(const nlohmann::json& model_json, const std::string& prompt,
+                                   ScalarFunctionType function_type);
+    static std::string RowHash(const nlohmann::json& columns, size_t row);
+
+    // Journaled results for the given rows, keyed by row hash
+    static std::unordered_map<std::string, nlohmann::json> Load(const std::string& request_hash,
+                                                                const std::vector<std::string>& row_hashes);
+    // Durably record one batch of results; NULL results are skipped so those rows are retried
+    static void Append(const std::string& request_hash, const std::vector<std::string>& row_hashes,
+                       const nlohmann::json& results);
+};
+
+}// namespace flock
@@ -6,7 +6,11 @@
 
 namespace flock {
 
-nlohmann::json CastVectorOfStructsToJson(const duckdb::Vector& struct_vector, int size);
+// Convert a chunk of prompt structs into one JSON object; each context column carries its metadata once and the
+// data of every row as text (JSON null for NULL)
+nlohmann::json CastVectorOfStructsToJson(duckdb::Vector& struct_vector, int size);
+// Append every row of a vector as text, printed like Value::ToString, with NULL as JSON null
+void AppendVectorAsStrings(duckdb::Vector& vector, duckdb::idx_t count, nlohmann::json& data);
 nlohmann::json CastValueToJson(const duckdb::Value& value);
 
 }// namespace flock
@@ -2,12 +2,79 @@
 
 #include "flock/core/common.hpp"
 #include "flock/model_manager/model.hpp"
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <vector>
 
 namespace flock {
 
+// The response to a prompt without context columns. It does not depend on the rows, so it is requested once per
+// query and shared by every copy of the bind data.
+struct ConstantResponse {
+    std::mutex mutex;
+    std::optional<nlohmann::json> response;
+    duckdb::idx_t query_id = duckdb::DConstants::INVALID_INDEX;
+
+    // Forget the response of an earlier query, e.g. of a previous execution of the same prepared statement
+    void BeginQuery(const duckdb::idx_t active_query) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (query_id != active_query) {
+            query_id = active_query;
+            response.reset();
+        }
+    }
+};
+
+// State keys of the groups of an incremental llm_reduce. Every copy of the bind data shares them, so two groups with
+// the same key are caught even when DuckDB finalizes them in separate calls.
+struct ReduceStateClaims {
+    std::mutex mutex;
+    std::set<std::string> state_keys;
+    duckdb::idx_t query_id = duckdb::DConstants::INVALID_INDEX;
+
+    // Claim state_key for the active query, false when another group of that query already claimed it
+    bool Claim(const duckdb::idx_t active_query, const std::string& state_key) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (query_id != active_query) {
+            query_id = active_query;
+            state_keys.clear();
+        }
+        return state_keys.insert(state_key).second;
+    }
+};
+
+// What happens to rows whose request fails or whose response has no item for them
+enum class ErrorPolicy {
+    FAIL,    // The query fails
+    NULL_ROW,// The rows are NULL and counted in the metrics
+    RETRY,   // The rows are asked again one at a time, and are NULL when that fails too
+};
+
 struct LlmFunctionBindData : public duckdb::FunctionData {
     nlohmann::json model_json;// Store model JSON to create fresh Model instances per call
     std::string prompt;
+    bool checkpoint = false;// Journal per-row results in the global storage and skip journaled rows
+    // Escalation model of a cascade, null when the function does not cascade. The primary model answers with a
+    // confidence and rows below the threshold are sent on to the escalation model.
+    nlohmann::json cascade_model_json;
+    double cascade_threshold = DEFAULT_CASCADE_THRESHOLD;
+    // Result for rows whose context columns are all NULL or empty; such rows are never sent to the model. It is the
+    // configured text, or a JSON value of the result type when the result is typed.
+    std::optional<nlohmann::json> empty_value;
+    ErrorPolicy error_policy = ErrorPolicy::FAIL;
+    // Ask every row for a single yes/no token and read the answer from its log probabilities
+    bool logprobs = false;
+    // Labels of llm_classify, in the order of its ENUM result; the model answers with their indexes
+    std::vector<std::string> labels;
+    std::shared_ptr<ConstantResponse> constant_response = std::make_shared<ConstantResponse>();
+    std::shared_ptr<ReduceStateClaims> reduce_state_claims = std::make_shared<ReduceStateClaims>();
+    // Aggregates are finalized without a client context, so llm_reduce keeps it to tell executions apart
+    std::weak_ptr<duckdb::ClientContext> client_context;
+
+    static constexpr double DEFAULT_CASCADE_THRESHOLD = 0.8;
 
     LlmFunctionBindData() = default;
 
@@ -16,16 +83,34 @@ struct LlmFunctionBindData : public duckdb::FunctionData {
         return Model(model_json);
     }
 
+    bool HasCascade() const {
+        return !cascade_model_json.is_null();
+    }
+
     duckdb::unique_ptr<duckdb::FunctionData> Copy() const override {
         auto result = duckdb::make_uniq<LlmFunctionBindData>();
         result->model_json = model_json;
         result->prompt = prompt;
+        result->checkpoint = checkpoint;
+        result->cascade_model_json = cascade_model_json;
+        result->cascade_threshold = cascade_threshold;
+        result->empty_value = empty_value;
+        result->error_policy = error_policy;
+        result->logprobs = logprobs;
+        result->labels = labels;
+        result->constant_response = constant_response;
+        result->reduce_state_claims = reduce_state_claims;
+        result->client_context = client_context;
         return std::move(result);
     }
 
     bool Equals(const duckdb::FunctionData& other) const override {
         auto& other_bind = other.Cast<LlmFunctionBindData>();
-        return prompt == other_bind.prompt && model_json == other_bind.model_json;
+        return prompt == other_bind.prompt && model_json == other_bind.model_json &&
+               checkpoint == other_bind.checkpoint && cascade_model_json == other_bind.cascade_model_json &&
+               cascade_threshold == other_bind.cascade_threshold && empty_value == other_bind.empty_value &&
+               error_policy == other_bind.error_policy && logprobs == other_bind.logprobs &&
+               labels == other_bind.labels;
     }
 };
 
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "flock/functions/llm_function_bind_data.hpp"
+#include "flock/functions/scalar/scalar.hpp"
+
+namespace flock {
+
+// llm_classify(model, prompt, labels): the one label that fits each row, as an ENUM of the labels. The model is
+// constrained to the indexes of the labels, so every row costs a single short integer of output.
+class LlmClassify : public ScalarFunctionBase {
+public:
+    static duckdb::unique_ptr<duckdb::FunctionData> Bind(
+            duckdb::ClientContext& context,
+            duckdb::ScalarFunction& bound_function,
+            duckdb::vector<duckdb::unique_ptr<duckdb::Expression>>& arguments);
+    static void ValidateArguments(duckdb::DataChunk& args);
+    // Item schema that only admits the indexes of the labels
+    static nlohmann::json LabelSchema(size_t label_count);
+    // The prompt followed by the numbered labels
+    static std::string LabeledPrompt(const std::string& prompt, const std::vector<std::string>& labels);
+    // Index of the label a response names, by index or by label; nullopt when it names none
+    static std::optional<idx_t> ParseLabel(const nlohmann::json& response, const std::vector<std::string>& labels);
+    static std::vector<std::optional<idx_t>> Operation(duckdb::DataChunk& args, LlmFunctionBindData* bind_data);
+    // Same as above, with the context columns already converted to JSON
+    static std::vector<std::optional<idx_t>> Operation(const nlohmann::json& context_columns,
+                                                       const LlmFunctionBindData* bind_data);
+    static void Execute(duckdb::DataChunk& args, duckdb::ExpressionState& state, duckdb::Vector& result);
+};
+
+}// namespace flock
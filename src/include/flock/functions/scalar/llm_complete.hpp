@@ -12,7 +12,15 @@ public:
             duckdb::ScalarFunction& bound_function,
             duckdb::vector<duckdb::unique_ptr<duckdb::Expression>>& arguments);
     static void ValidateArguments(duckdb::DataChunk& args);
-    static std::vector<std::string> Operation(duckdb::DataChunk& args, LlmFunctionBindData* bind_data);
+    static std::string ResponseToString(const nlohmann::json& response);
+    static nlohmann::json ContextColumns(duckdb::DataChunk& args);
+    static std::vector<std::optional<std::string>> Operation(duckdb::DataChunk& args, LlmFunctionBindData* bind_data);
+    // Same as above, with the context columns already converted to JSON
+    static std::vector<std::optional<std::string>> Operation(const nlohmann::json& context_columns,
+                                                             const LlmFunctionBindData* bind_data);
+    // One response per row, nullopt for NULL rows, as the model returned it
+    static std::vector<std::optional<nlohmann::json>> Responses(const nlohmann::json& context_columns,
+                                                                const LlmFunctionBindData* bind_data);
     static void Execute(duckdb::DataChunk& args, duckdb::ExpressionState& state, duckdb::Vector& result);
 };
 
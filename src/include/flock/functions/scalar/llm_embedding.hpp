@@ -12,7 +12,9 @@ public:
             duckdb::ScalarFunction& bound_function,
             duckdb::vector<duckdb::unique_ptr<duckdb::Expression>>& arguments);
     static void ValidateArguments(duckdb::DataChunk& args);
-    static std::vector<duckdb::vector<duckdb::Value>> Operation(duckdb::DataChunk& args, LlmFunctionBindData* bind_data);
+    static std::vector<std::vector<double>> Operation(duckdb::DataChunk& args, LlmFunctionBindData* bind_data);
+    // Same as above, with the context columns already converted to JSON
+    static std::vector<std::vector<double>> Operation(const nlohmann::json& context_columns, const LlmFunctionBindData* bind_data);
     static void Execute(duckdb::DataChunk& args, duckdb::ExpressionState& state, duckdb::Vector& result);
 };
 
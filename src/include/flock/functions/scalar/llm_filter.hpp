@@ -7,13 +7,30 @@ namespace flock {
 
 class LlmFilter : public ScalarFunctionBase {
 public:
+    // With 'logprobs', rows whose probability of "yes" reaches this are kept
+    static constexpr double YES_THRESHOLD = 0.5;
+
     static duckdb::unique_ptr<duckdb::FunctionData> Bind(
             duckdb::ClientContext& context,
             duckdb::ScalarFunction& bound_function,
             duckdb::vector<duckdb::unique_ptr<duckdb::Expression>>& arguments);
     static void ValidateArguments(duckdb::DataChunk& args);
-    static std::vector<std::string> Operation(duckdb::DataChunk& args, LlmFunctionBindData* bind_data);
+    // A missing verdict, or anything that does not read as a boolean, is NULL, so a WHERE clause drops the row
+    static std::optional<bool> ParseVerdict(const nlohmann::json& response);
+    static std::vector<std::optional<bool>> Operation(duckdb::DataChunk& args, LlmFunctionBindData* bind_data);
+    // Same as above, with the context columns already converted to JSON
+    static std::vector<std::optional<bool>> Operation(const nlohmann::json& context_columns, const LlmFunctionBindData* bind_data);
     static void Execute(duckdb::DataChunk& args, duckdb::ExpressionState& state, duckdb::Vector& result);
+
+    // llm_filter_confidence: the probability of "yes" for every row, always read from log probabilities
+    static duckdb::unique_ptr<duckdb::FunctionData> ConfidenceBind(
+            duckdb::ClientContext& context,
+            duckdb::ScalarFunction& bound_function,
+            duckdb::vector<duckdb::unique_ptr<duckdb::Expression>>& arguments);
+    // NULL where the answer token was neither yes nor no, or the row failed under a tolerant error policy
+    static std::vector<std::optional<double>> ConfidenceOperation(const nlohmann::json& context_columns,
+                                                                  const LlmFunctionBindData* bind_data);
+    static void ConfidenceExecute(duckdb::DataChunk& args, duckdb::ExpressionState& state, duckdb::Vector& result);
 };
 
 }// namespace flock
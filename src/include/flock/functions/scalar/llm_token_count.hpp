@@ -0,0 +1,18 @@
+#pragma once
+
+#include "flock/functions/llm_function_bind_data.hpp"
+#include "flock/functions/scalar/scalar.hpp"
+
+namespace flock {
+
+// llm_token_count(model, text): tokens of text for the model, counted locally without calling the provider
+class LlmTokenCount : public ScalarFunctionBase {
+public:
+    static duckdb::unique_ptr<duckdb::FunctionData> Bind(
+            duckdb::ClientContext& context,
+            duckdb::ScalarFunction& bound_function,
+            duckdb::vector<duckdb::unique_ptr<duckdb::Expression>>& arguments);
+    static void Execute(duckdb::DataChunk& args, duckdb::ExpressionState& state, duckdb::Vector& result);
+};
+
+}// namespace flock
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <any>
+#include <functional>
 #include <optional>
 
 #include "flock/core/common.hpp"
@@ -43,13 +44,96 @@ public:
 
     static void ValidateArguments(duckdb::DataChunk& args);
     static std::vector<std::any> Operation(duckdb::DataChunk& args);
+    // Resolve a constant model struct, including per-call options such as 'checkpoint'
+    static void InitializeModelJson(const duckdb::Value& model_value, LlmFunctionBindData& bind_data);
+    // 'logprobs' works on single rows of an OpenAI or Ollama model only
+    static void ValidateLogprobs(const LlmFunctionBindData& bind_data);
     static void Execute(duckdb::DataChunk& args, duckdb::ExpressionState& state, duckdb::Vector& result);
 
+    // Render one batch and queue its completion request on the model without waiting for it
+    static void AddCompletion(nlohmann::json& tuples, const std::string& user_prompt,
+                              ScalarFunctionType function_type, Model& model);
     static nlohmann::json Complete(nlohmann::json& tuples, const std::string& user_prompt,
                                    ScalarFunctionType function_type, Model& model);
+    // The given rows of every column, in the given order
+    static nlohmann::json SelectRows(const nlohmann::json& tuples, const std::vector<size_t>& rows);
+    // Pad with NULLs or truncate so a batch yields exactly one response per row
+    static void FitResponseToBatch(nlohmann::json& response, size_t batch_rows);
+    // on_batch is called with the row indexes of each completed batch and their responses
+    using BatchCallback = std::function<void(const std::vector<size_t>& rows, const nlohmann::json& responses)>;
+    // Pack the rows into requests by estimated tokens, send them concurrently and return one response per row.
+    // Rows that fail under a tolerant error policy are null.
     static nlohmann::json BatchAndComplete(const nlohmann::json& tuples,
                                            const std::string& user_prompt_name, ScalarFunctionType function_type,
-                                           Model& model);
+                                           Model& model, ErrorPolicy error_policy = ErrorPolicy::FAIL,
+                                           const BatchCallback& on_batch = nullptr);
+    // Send the given batches concurrently and write their responses into responses. When a batch overflows the
+    // output budget, the items completed before the cut are kept and the rest of the batch runs again; without
+    // any completed item the batch is split in halves.
+    static void CompleteBatches(const nlohmann::json& tuples, const std::string& user_prompt,
+                                ScalarFunctionType function_type, Model& model,
+                                const std::vector<std::vector<size_t>>& batches, ErrorPolicy error_policy,
+                                const BatchCallback& on_batch, nlohmann::json& responses);
+    static std::vector<std::vector<size_t>> SplitInHalves(const std::vector<size_t>& rows);
+    static nlohmann::json BatchAndCompleteSequentially(const nlohmann::json& tuples, const std::string& user_prompt,
+                                                       ScalarFunctionType function_type, Model& model,
+                                                       const std::vector<std::vector<size_t>>& batches,
+                                                       ErrorPolicy error_policy = ErrorPolicy::FAIL,
+                                                       const BatchCallback& on_batch = nullptr);
+    // Like BatchAndComplete, but rows already in the checkpoint journal are not sent to the model. Batches of a
+    // round run concurrently, and each one is journaled as soon as that round has been collected.
+    static nlohmann::json BatchAndCompleteWithCheckpoint(const nlohmann::json& tuples, const std::string& user_prompt,
+                                                         ScalarFunctionType function_type, Model& model,
+                                                         const LlmFunctionBindData& bind_data);
+
+    // Whether a resolved model already carries a custom item schema in its model_parameters
+    static bool HasItemSchema(const nlohmann::json& model_json);
+    // Replace the item schema of a resolved model, under the model_parameters key its provider reads
+    static void SetItemSchema(nlohmann::json& model_json, const nlohmann::json& item_schema);
+    // The item schema of a resolved model, null when it has none
+    static nlohmann::ordered_json GetItemSchema(const nlohmann::ordered_json& model_json);
+    // DuckDB type of the values a JSON schema describes: objects with properties become STRUCTs, with fields in the
+    // order of the properties, and arrays LISTs. Anything without a plain type is JSON.
+    static duckdb::LogicalType SchemaToLogicalType(const nlohmann::ordered_json& schema);
+    // The empty value as a JSON value of a typed result, or a bind error when it is not one
+    static nlohmann::json TypedEmptyValue(const nlohmann::json& empty_value, const duckdb::LogicalType& type);
+    // Item schema of the primary model of a cascade: the answer together with a self-reported confidence
+    static nlohmann::json CascadeItemSchema(ScalarFunctionType function_type);
+    // Ask the primary model for every row, then send the rows answered below the confidence threshold to the
+    // escalation model in a second pass
+    static nlohmann::json BatchAndCompleteCascade(const nlohmann::json& tuples, const std::string& user_prompt,
+                                                  ScalarFunctionType function_type,
+                                                  const LlmFunctionBindData& bind_data);
+    // Ask every row alone for a single yes/no token and return the probability of "yes" for each row, null when
+    // the answer was neither
+    static nlohmann::json CompleteYesNo(const nlohmann::json& tuples, const std::string& user_prompt, Model& model,
+                                        ErrorPolicy error_policy = ErrorPolicy::FAIL);
+    // Complete every row the way the bind data asks for: journaled, cascaded or in plain batches. Rows left null
+    // by the error policy are counted as failed in the metrics.
+    static nlohmann::json CompleteRows(const nlohmann::json& tuples, const std::string& user_prompt,
+                                       ScalarFunctionType function_type, Model& model,
+                                       const LlmFunctionBindData& bind_data);
+
+    // Complete a prompt without context columns. The first call asks the model and every later call of the same
+    // bound function, from any thread, reuses that response.
+    static nlohmann::json CompleteWithoutContext(const std::string& prompt, OutputType output_type, Model& model,
+                                                 const LlmFunctionBindData& bind_data);
+    // Rows with any context; rows whose context columns are all NULL or empty strings have nothing to ask about
+    static std::vector<size_t> RowsWithContext(const nlohmann::json& tuples);
+    // CompleteRows over the rows with context only. Returns those rows and one response for each of them.
+    static std::pair<std::vector<size_t>, nlohmann::json> CompleteRowsWithContext(
+            const nlohmann::json& tuples, const std::string& user_prompt, ScalarFunctionType function_type,
+            Model& model, const LlmFunctionBindData& bind_data);
+
+    // Write results straight into the result vector; a single result answers every row and rows without a
+    // result are NULL
+    static void WriteStringResults(const std::vector<std::optional<std::string>>& results, duckdb::Vector& result,
+                                   idx_t count);
+    static void WriteListResults(const std::vector<std::vector<double>>& results, duckdb::Vector& result, idx_t count);
+    // Write JSON results into a vector of any type SchemaToLogicalType returns, straight into its child vectors.
+    // Values that do not fit the type are NULL.
+    static void WriteTypedResults(const std::vector<std::optional<nlohmann::json>>& results, duckdb::Vector& result,
+                                  idx_t count);
 
     static duckdb::unique_ptr<LlmFunctionBindData> ValidateAndInitializeBindData(
             duckdb::ClientContext& context,
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "duckdb/function/table_function.hpp"
+#include "flock/functions/llm_function_bind_data.hpp"
+#include "flock/metrics/types.hpp"
+#include <nlohmann/json.hpp>
+
+#include <chrono>
+#include <deque>
+#include <future>
+
+namespace flock {
+
+struct LlmPipelinedInfo : public duckdb::TableFunctionInfo {
+    explicit LlmPipelinedInfo(FunctionType function_type) : function_type(function_type) {}
+    FunctionType function_type;
+};
+
+struct LlmPipelinedBindData : public duckdb::TableFunctionData {
+    FunctionType function_type = FunctionType::UNKNOWN;
+    LlmFunctionBindData llm;
+    std::vector<std::string> context_column_names;
+    std::vector<duckdb::idx_t> context_column_indexes;
+    duckdb::idx_t lookahead = 0;
+    duckdb::idx_t batch_rows = 0;// Rows to buffer before a request is sent
+    int64_t flush_after_ms = 0;  // Send a partial batch once its oldest row has waited this long
+};
+
+struct LlmPipelinedLocalState : public duckdb::LocalTableFunctionState {
+    struct PendingBatch {
+        std::vector<duckdb::unique_ptr<duckdb::DataChunk>> chunks;
+        std::future<std::vector<duckdb::Value>> results;
+        std::vector<duckdb::Value> ready;
+        size_t next_chunk = 0;
+        duckdb::idx_t next_row = 0;
+    };
+    // Rows held back until a full batch is buffered or the flush deadline passes
+    std::vector<duckdb::unique_ptr<duckdb::DataChunk>> buffer;
+    duckdb::idx_t buffered_rows = 0;
+    std::chrono::steady_clock::time_point buffer_started;
+    // Destroying a pending future waits for its request, so no worker outlives the operator
+    std::deque<PendingBatch> pending;
+    // Set while output is still being emitted for an input that was already buffered
+    bool input_buffered = false;
+};
+
+// Table in-out variants of llm_complete, llm_filter and llm_embedding. Input rows are buffered across chunks until
+// a full batch is collected, so the small chunks left by a selective filter still make full requests. Each batch is
+// handed to a worker thread and its rows are only emitted once more than `lookahead` batches are in flight, so
+// scanning, prompt rendering and the provider requests of consecutive batches overlap.
+class LlmPipelined {
+public:
+    static constexpr duckdb::idx_t DEFAULT_LOOKAHEAD = 2;
+    static constexpr int64_t DEFAULT_FLUSH_AFTER_MS = 1000;
+    static constexpr auto RESULT_COLUMN = "result";
+
+    static duckdb::TableFunction GetFunction(const std::string& name, FunctionType function_type);
+
+    static duckdb::unique_ptr<duckdb::FunctionData> Bind(duckdb::ClientContext& context,
+                                                         duckdb::TableFunctionBindInput& input,
+                                                         duckdb::vector<duckdb::LogicalType>& return_types,
+                                                         duckdb::vector<std::string>& names);
+    static duckdb::unique_ptr<duckdb::LocalTableFunctionState> InitLocal(duckdb::ExecutionContext& context,
+                                                                         duckdb::TableFunctionInitInput& input,
+                                                                         duckdb::GlobalTableFunctionState* global_state);
+    static duckdb::OperatorResultType Execute(duckdb::ExecutionContext& context, duckdb::TableFunctionInput& data,
+                                              duckdb::DataChunk& input, duckdb::DataChunk& output);
+    static duckdb::OperatorFinalizeResultType Finalize(duckdb::ExecutionContext& context,
+                                                       duckdb::TableFunctionInput& data, duckdb::DataChunk& output);
+
+    // Append the context columns of a chunk in the layout CastVectorOfStructsToJson produces
+    static void AppendContextColumns(duckdb::DataChunk& chunk, const LlmPipelinedBindData& bind_data,
+                                     nlohmann::json& context_columns);
+    // Run the scalar operation for one batch, on whatever thread calls it
+    static std::vector<duckdb::Value> Operation(duckdb::DatabaseInstance* db, const LlmPipelinedBindData& bind_data,
+                                                const nlohmann::json& context_columns);
+
+private:
+    static void Buffer(duckdb::ExecutionContext& context, LlmPipelinedLocalState& state, duckdb::DataChunk& input);
+    static void Flush(duckdb::ExecutionContext& context, const LlmPipelinedBindData& bind_data,
+                      LlmPipelinedLocalState& state);
+    // Emit the next chunk of the oldest batch; returns true while that batch has more chunks left
+    static bool Emit(LlmPipelinedLocalState& state, duckdb::DataChunk& output);
+};
+
+}// namespace flock
@@ -69,6 +69,23 @@ public:
         metrics.output_tokens += output;
     }
 
+    // Add input tokens served from the provider's prompt cache (accumulative)
+    void UpdateCachedTokens(const StateId& state_id, FunctionType type, int64_t cached_input) {
+        GetThreadMetrics(state_id).GetMetrics(type).cached_input_tokens += cached_input;
+    }
+
+    // Add the rows each stage of a cascade answered (accumulative)
+    void UpdateCascadeRows(const StateId& state_id, FunctionType type, int64_t primary, int64_t escalated) {
+        auto& metrics = GetThreadMetrics(state_id).GetMetrics(type);
+        metrics.cascade_primary_rows += primary;
+        metrics.cascade_escalated_rows += escalated;
+    }
+
+    // Add the rows the error policy set to NULL (accumulative)
+    void UpdateFailedRows(const StateId& state_id, FunctionType type, int64_t failed) {
+        GetThreadMetrics(state_id).GetMetrics(type).failed_rows += failed;
+    }
+
     // Increment API call counter
     void IncrementApiCalls(const StateId& state_id, FunctionType type) {
         GetThreadMetrics(state_id).GetMetrics(type).api_calls++;
@@ -129,6 +146,10 @@ public:
                         auto& merged = merged_metrics[key];
                         merged.input_tokens += metrics.input_tokens;
                         merged.output_tokens += metrics.output_tokens;
+                        merged.cached_input_tokens += metrics.cached_input_tokens;
+                        merged.cascade_primary_rows += metrics.cascade_primary_rows;
+                        merged.cascade_escalated_rows += metrics.cascade_escalated_rows;
+                        merged.failed_rows += metrics.failed_rows;
                         merged.api_calls += metrics.api_calls;
                         merged.api_duration_us += metrics.api_duration_us;
                         merged.execution_time_us += metrics.execution_time_us;
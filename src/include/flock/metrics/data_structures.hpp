@@ -16,6 +16,10 @@ struct FunctionMetricsData {
     std::string provider;
     int64_t input_tokens = 0;
     int64_t output_tokens = 0;
+    int64_t cached_input_tokens = 0;
+    int64_t cascade_primary_rows = 0;  // Rows answered by the primary model of a cascade
+    int64_t cascade_escalated_rows = 0;// Rows sent on to the escalation model
+    int64_t failed_rows = 0;           // Rows set to NULL by the error policy after their request failed
     int64_t api_calls = 0;
     int64_t api_duration_us = 0;
     int64_t execution_time_us = 0;
@@ -42,10 +46,17 @@ struct FunctionMetricsData {
                 {"input_tokens", input_tokens},
                 {"output_tokens", output_tokens},
                 {"total_tokens", total_tokens()},
+                {"cached_input_tokens", cached_input_tokens},
                 {"api_calls", api_calls},
                 {"api_duration_ms", api_duration_ms()},
                 {"execution_time_ms", execution_time_ms()}};
 
+        if (cascade_primary_rows != 0 || cascade_escalated_rows != 0) {
+            result["cascade"] = {{"primary_rows", cascade_primary_rows}, {"escalated_rows", cascade_escalated_rows}};
+        }
+        if (failed_rows != 0) {
+            result["failed_rows"] = failed_rows;
+        }
         if (!model_name.empty()) {
             result["model_name"] = model_name;
         }
@@ -60,7 +71,7 @@ struct FunctionMetricsData {
 // Stores metrics for all function types in a single state
 class ThreadMetrics {
 public:
-    static constexpr size_t NUM_FUNCTION_TYPES = 8;
+    static constexpr size_t NUM_FUNCTION_TYPES = 9;
 
     void Reset() noexcept {
         for (auto& func_metrics: by_function_) {
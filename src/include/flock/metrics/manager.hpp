@@ -66,6 +66,30 @@ public:
         }
     }
 
+    // Record input tokens served from the provider's prompt cache (accumulative)
+    static void UpdateCachedTokens(int64_t cached_input) {
+        if (current_db_ != nullptr && current_state_id_ != nullptr) {
+            auto& manager = GetForDatabase(current_db_);
+            manager.BaseMetricsManager<const void*>::UpdateCachedTokens(current_state_id_, current_function_type_, cached_input);
+        }
+    }
+
+    // Record the rows answered by each stage of a cascade (accumulative)
+    static void UpdateCascadeRows(int64_t primary, int64_t escalated) {
+        if (current_db_ != nullptr && current_state_id_ != nullptr) {
+            auto& manager = GetForDatabase(current_db_);
+            manager.BaseMetricsManager<const void*>::UpdateCascadeRows(current_state_id_, current_function_type_, primary, escalated);
+        }
+    }
+
+    // Record the rows the error policy set to NULL (accumulative)
+    static void UpdateFailedRows(int64_t failed) {
+        if (current_db_ != nullptr && current_state_id_ != nullptr) {
+            auto& manager = GetForDatabase(current_db_);
+            manager.BaseMetricsManager<const void*>::UpdateFailedRows(current_state_id_, current_function_type_, failed);
+        }
+    }
+
     // Increment API call counter
     static void IncrementApiCalls() {
         if (current_db_ != nullptr && current_state_id_ != nullptr) {
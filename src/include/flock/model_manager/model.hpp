@@ -17,18 +17,17 @@
 
 namespace flock {
 
-enum class ExecutionMode {
-    SYNC,
-    ASYNC
-};
-
 class Model {
 public:
+    // Requests in flight at once for a model in latency mode, where every request carries a single tuple
+    static constexpr long LATENCY_MAX_CONCURRENT_REQUESTS = 64;
+
     explicit Model(const nlohmann::json& model_json);
     explicit Model() = default;
     void AddCompletionRequest(const std::string& prompt, const int num_output_tuples, OutputType output_type = OutputType::STRING, const nlohmann::json& media_data = nlohmann::json::object());
     void AddEmbeddingRequest(const std::vector<std::string>& inputs);
     void AddTranscriptionRequest(const nlohmann::json& audio_files);
+    void AddYesNoRequest(const std::string& prompt, const nlohmann::json& media_data = nlohmann::json::object());
     std::vector<nlohmann::json> CollectCompletions(const std::string& contentType = "application/json");
     std::vector<nlohmann::json> CollectEmbeddings(const std::string& contentType = "application/json");
     std::vector<nlohmann::json> CollectTranscriptions(const std::string& contentType = "multipart/form-data");
@@ -37,6 +36,8 @@ public:
 
     // Static helper method for binders to resolve model details to JSON
     static nlohmann::json ResolveModelDetailsToJson(const nlohmann::json& user_model_json);
+    // The model parameters as the user or the model catalog wrote them, with object properties in their order
+    static nlohmann::ordered_json ResolveModelParameters(const nlohmann::json& user_model_json);
 
     // Factory function type for creating mock providers
     using MockProviderFactory = std::function<std::shared_ptr<IProvider>()>;
@@ -65,7 +66,7 @@ private:
     inline static MockProviderFactory mock_provider_factory_ = nullptr;
     void ConstructProvider();
     void LoadModelDetails(const nlohmann::json& model_json);
-    static std::tuple<std::string, std::string, nlohmann::basic_json<>> GetQueriedModel(const std::string& model_name);
+    static std::tuple<std::string, std::string, nlohmann::ordered_json> GetQueriedModel(const std::string& model_name);
     std::string GetSecret(const std::string& secret_name);
 };
 
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "flock/core/common.hpp"
+#include "flock/model_manager/providers/provider.hpp"
+#include "flock/model_manager/repository.hpp"
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <string>
+
+namespace flock {
+
+// Output token budgets for completion requests whose model parameters set none. A budget covers the JSON envelope
+// and every item: a few tokens for booleans and integers, and for other items twice the largest size per item
+// observed for the model so far in this process.
+class OutputBudget {
+public:
+    static constexpr int64_t ENVELOPE_TOKENS = 16;// {"items": [...]}
+    static constexpr int64_t BOOL_ITEM_TOKENS = 3;
+    static constexpr int64_t INTEGER_ITEM_TOKENS = 6;
+    static constexpr int64_t MIN_ITEM_TOKENS = 16;
+
+    // nullopt when the user set a limit, the model reasons before it answers, or nothing was observed yet
+    static std::optional<int64_t> MaxTokens(const ModelDetails& model_details, OutputType output_type, int num_items);
+    // Tokens one item of the output type is expected to take, observed or fixed; nullopt when unknown
+    static std::optional<int64_t> ItemTokens(const std::string& model, OutputType output_type);
+    // Type of the items a request returns: the custom schema's when the model parameters set one, else output_type
+    static OutputType RequestItemType(const nlohmann::json& model_parameters, OutputType output_type);
+    // Record the output tokens of a completion response, per item of its "items"
+    static void Observe(const std::string& model, const nlohmann::json& result, int64_t output_tokens);
+    static void Clear();
+
+    static bool SetsOutputLimit(const nlohmann::json& model_parameters);
+    // Reasoning tokens count against the output limit, so a budget for the answer alone would cut them short
+    static bool IsReasoningModel(const std::string& model);
+};
+
+}// namespace flock
@@ -12,8 +12,13 @@ public:
     }
 
     void AddCompletionRequest(const std::string& prompt, const int num_output_tuples, OutputType output_type, const nlohmann::json& media_data) override;
+    void AddYesNoRequest(const std::string& prompt, const nlohmann::json& media_data) override;
     void AddEmbeddingRequest(const std::vector<std::string>& inputs) override;
     void AddTranscriptionRequest(const nlohmann::json& audio_files) override;
+
+private:
+    // The user message, with the image columns attached as base64
+    nlohmann::json BuildMessage(const std::string& prompt, const nlohmann::json& media_data);
 };
 
 }// namespace flock
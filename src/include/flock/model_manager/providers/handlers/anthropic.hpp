@@ -89,6 +89,17 @@ protected:
         }
     }
 
+    std::string ExtractCompletionText(const nlohmann::json& response) const override {
+        if (response.contains("content") && response["content"].is_array()) {
+            for (const auto& block: response["content"]) {
+                if (block.value("type", "") == "text" && block.contains("text") && block["text"].is_string()) {
+                    return block["text"].get<std::string>();
+                }
+            }
+        }
+        return {};
+    }
+
     nlohmann::json ExtractCompletionOutput(const nlohmann::json& response) const override {
         if (!response.contains("content") || !response["content"].is_array() || response["content"].empty()) {
             return {};
@@ -133,19 +144,26 @@ protected:
         throw std::runtime_error("Anthropic does not support audio transcription.");
     }
 
-    std::pair<int64_t, int64_t> ExtractTokenUsage(const nlohmann::json& response) const override {
-        int64_t input_tokens = 0;
-        int64_t output_tokens = 0;
+    TokenUsage ExtractTokenUsage(const nlohmann::json& response) const override {
+        TokenUsage token_usage;
         if (response.contains("usage") && response["usage"].is_object()) {
             const auto& usage = response["usage"];
             if (usage.contains("input_tokens") && usage["input_tokens"].is_number()) {
-                input_tokens = usage["input_tokens"].get<int64_t>();
+                token_usage.input_tokens = usage["input_tokens"].get<int64_t>();
             }
             if (usage.contains("output_tokens") && usage["output_tokens"].is_number()) {
-                output_tokens = usage["output_tokens"].get<int64_t>();
+                token_usage.output_tokens = usage["output_tokens"].get<int64_t>();
+            }
+            // input_tokens excludes tokens written to or read from the prompt cache
+            if (usage.contains("cache_creation_input_tokens") && usage["cache_creation_input_tokens"].is_number()) {
+                token_usage.input_tokens += usage["cache_creation_input_tokens"].get<int64_t>();
+            }
+            if (usage.contains("cache_read_input_tokens") && usage["cache_read_input_tokens"].is_number()) {
+                token_usage.cached_input_tokens = usage["cache_read_input_tokens"].get<int64_t>();
+                token_usage.input_tokens += token_usage.cached_input_tokens;
             }
         }
-        return {input_tokens, output_tokens};
+        return token_usage;
     }
 };
 
@@ -3,9 +3,15 @@
 #include "flock/core/common.hpp"
 #include "flock/metrics/manager.hpp"
 #include "flock/model_manager/providers/handlers/handler.hpp"
+#include "flock/model_manager/output_budget.hpp"
+#include "flock/model_manager/tokenizer.hpp"
+#include "flock/model_manager/truncated_output.hpp"
 #include "session.hpp"
+#include <cctype>
+#include <cmath>
 #include <cstdio>
 #include <curl/curl.h>
+#include <exception>
 #include <map>
 #include <nlohmann/json.hpp>
 #include <string>
@@ -15,26 +21,96 @@ namespace flock {
 
 class BaseModelProviderHandler : public IModelProviderHandler {
 public:
+    // Upper bound on transfers in flight at once; curl queues the remaining requests of a batch
+    static constexpr long DEFAULT_MAX_CONCURRENT_REQUESTS = 16;
+
     explicit BaseModelProviderHandler(bool throw_exception)
         : _throw_exception(throw_exception) {}
     virtual ~BaseModelProviderHandler() = default;
 
+    // Text of a chat request (system prompt and message text parts) for counting tokens locally. Images and other
+    // media are base64 payloads whose token cost depends on the provider, so they are left out of the count.
+    static std::string RequestText(const nlohmann::json& request) {
+        std::string text;
+        auto append_content = [&text](const nlohmann::json& content) {
+            if (content.is_string()) {
+                text += content.get<std::string>();
+                text += "\n";
+            } else if (content.is_array()) {
+                for (const auto& part: content) {
+                    if (part.is_object() && part.contains("text") && part["text"].is_string()) {
+                        text += part["text"].get<std::string>();
+                        text += "\n";
+                    }
+                }
+            }
+        };
+        if (request.contains("system")) {
+            append_content(request["system"]);
+        }
+        if (request.contains("prompt")) {
+            append_content(request["prompt"]);
+        }
+        if (request.contains("messages") && request["messages"].is_array()) {
+            for (const auto& message: request["messages"]) {
+                if (message.is_object() && message.contains("content")) {
+                    append_content(message["content"]);
+                }
+            }
+        }
+        return text;
+    }
+
+    // Probability of "yes" among the yes/no alternatives of an answer token, renormalized over the two; null when
+    // neither answer is among the alternatives
+    static nlohmann::json YesProbability(const nlohmann::json& top_logprobs) {
+        double yes = 0.0;
+        double no = 0.0;
+        for (const auto& alternative: top_logprobs) {
+            if (!alternative.contains("token") || !alternative["token"].is_string() ||
+                !alternative.contains("logprob") || !alternative["logprob"].is_number()) {
+                continue;
+            }
+            std::string token;
+            for (const auto c: alternative["token"].get<std::string>()) {
+                if (!std::isspace(static_cast<unsigned char>(c))) {
+                    token += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+                }
+            }
+            const auto probability = std::exp(alternative["logprob"].get<double>());
+            if (token == "yes" || token == "true") {
+                yes += probability;
+            } else if (token == "no" || token == "false") {
+                no += probability;
+            }
+        }
+        if (yes + no == 0.0) {
+            return nullptr;
+        }
+        return yes / (yes + no);
+    }
+
+    void SetMaxConcurrentRequests(long max_concurrent_requests) override {
+        _max_concurrent_requests = std::max(max_concurrent_requests, 1L);
+    }
+
     void AddRequest(const nlohmann::json& json, RequestType type = RequestType::Completion) override {
         _request_batch.push_back(json);
         _request_types.push_back(type);
     }
 
     std::vector<nlohmann::json> CollectCompletions(const std::string& contentType = "application/json") override {
+        // Take the queued requests first so a failed batch is not resent with the next one
+        auto request_batch = TakeRequestBatch();
         std::vector<nlohmann::json> completions;
-        if (!_request_batch.empty()) completions = ExecuteBatch(_request_batch, true, contentType, RequestType::Completion);
-        _request_batch.clear();
+        if (!request_batch.empty()) completions = ExecuteBatch(request_batch, true, contentType, RequestType::Completion);
         return completions;
     }
 
     std::vector<nlohmann::json> CollectEmbeddings(const std::string& contentType = "application/json") override {
+        auto request_batch = TakeRequestBatch();
         std::vector<nlohmann::json> embeddings;
-        if (!_request_batch.empty()) embeddings = ExecuteBatch(_request_batch, true, contentType, RequestType::Embedding);
-        _request_batch.clear();
+        if (!request_batch.empty()) embeddings = ExecuteBatch(request_batch, true, contentType, RequestType::Embedding);
         return embeddings;
     }
 
@@ -72,11 +148,13 @@ protected:
             CURL* easy = nullptr;
             std::string payload;
             curl_mime* mime_form = nullptr;
+            struct curl_slist* headers = nullptr;
             std::string temp_file_path;
             bool is_temp_file;
         };
         std::vector<CurlRequestData> requests(jsons.size());
         CURLM* multi_handle = curl_multi_init();
+        curl_multi_setopt(multi_handle, CURLMOPT_MAX_TOTAL_CONNECTIONS, _max_concurrent_requests);
 
         // Determine URL based on request type
         std::string url;
@@ -141,6 +219,7 @@ protected:
                     headers = curl_slist_append(headers, h.c_str());
                 }
                 curl_easy_setopt(requests[i].easy, CURLOPT_HTTPHEADER, headers);
+                requests[i].headers = headers;
             } else {
                 // Handle JSON requests (completions/embeddings)
                 requests[i].payload = jsons[i].dump();
@@ -150,6 +229,7 @@ protected:
                     headers = curl_slist_append(headers, h.c_str());
                 }
                 curl_easy_setopt(requests[i].easy, CURLOPT_HTTPHEADER, headers);
+                requests[i].headers = headers;
                 curl_easy_setopt(requests[i].easy, CURLOPT_POST, 1L);
                 curl_easy_setopt(requests[i].easy, CURLOPT_POSTFIELDS, requests[i].payload.c_str());
             }
@@ -180,7 +260,12 @@ protected:
 
         int64_t batch_input_tokens = 0;
         int64_t batch_output_tokens = 0;
+        int64_t batch_cached_input_tokens = 0;
 
+        // Every response is read and every handle released even when some fail, so the others are kept and counted
+        std::string first_error;
+        std::vector<size_t> failed;
+        std::vector<size_t> overflowed;
         std::vector<nlohmann::json> results(jsons.size());
         for (size_t i = 0; i < requests.size(); ++i) {
             // Clean up temp files for transcriptions
@@ -190,29 +275,59 @@ protected:
 
             curl_easy_getinfo(requests[i].easy, CURLINFO_RESPONSE_CODE, NULL);
 
-            if (isJson(requests[i].response)) {
-                try {
-                    nlohmann::json parsed = nlohmann::json::parse(requests[i].response);
-                    checkResponse(parsed, request_type);
-
-                    // Extract token usage for completions/embeddings
-                    if (!is_transcription) {
-                        auto [input_tokens, output_tokens] = ExtractTokenUsage(parsed);
-                        batch_input_tokens += input_tokens;
-                        batch_output_tokens += output_tokens;
-                    }
-
-                    // Let provider extract output based on request type
+            try {
+                if (isJson(requests[i].response)) {
                     try {
-                        results[i] = ExtractOutput(parsed, request_type);
+                        nlohmann::json parsed = nlohmann::json::parse(requests[i].response);
+                        bool truncated = false;
+                        try {
+                            checkResponse(parsed, request_type);
+                        } catch (const ExceededMaxOutputTokensError&) {
+                            // Callers retry the rest of the request; the items completed before the cut are kept
+                            truncated = true;
+                            overflowed.push_back(i);
+                            results[i] = {{"items", ParseTruncatedItems(ExtractCompletionText(parsed))}};
+                        }
+
+                        // Let provider extract output based on request type
+                        if (!truncated) {
+                            try {
+                                results[i] = ExtractOutput(parsed, request_type);
+                            } catch (const std::exception& e) {
+                                trigger_error(std::string("Output extraction error: ") + e.what());
+                            }
+                        }
+
+                        // Extract token usage for completions/embeddings
+                        if (!is_transcription) {
+                            auto usage = ExtractTokenUsage(parsed);
+                            // Count completions locally when the provider does not report usage
+                            if (usage.input_tokens == 0 && usage.output_tokens == 0 &&
+                                request_type == RequestType::Completion) {
+                                const auto model = jsons[i].value("model", std::string());
+                                usage.input_tokens = TokenCounter::Count(model, RequestText(jsons[i]));
+                                usage.output_tokens = TokenCounter::Count(model, results[i].dump());
+                            }
+                            if (request_type == RequestType::Completion && !truncated) {
+                                OutputBudget::Observe(jsons[i].value("model", std::string()), results[i],
+                                                      usage.output_tokens);
+                            }
+                            batch_input_tokens += usage.input_tokens;
+                            batch_output_tokens += usage.output_tokens;
+                            batch_cached_input_tokens += usage.cached_input_tokens;
+                        }
                     } catch (const std::exception& e) {
-                        trigger_error(std::string("Output extraction error: ") + e.what());
+                        trigger_error(std::string("Response processing error: ") + e.what());
                     }
-                } catch (const std::exception& e) {
-                    trigger_error(std::string("Response processing error: ") + e.what());
+                } else {
+                    trigger_error("Invalid JSON response: " + requests[i].response);
                 }
-            } else {
-                trigger_error("Invalid JSON response: " + requests[i].response);
+            } catch (const std::exception& e) {
+                if (failed.empty()) {
+                    first_error = e.what();
+                }
+                failed.push_back(i);
+                results[i] = nullptr;
             }
 
             // Clean up mime form for transcriptions
@@ -221,10 +336,12 @@ protected:
             }
             curl_multi_remove_handle(multi_handle, requests[i].easy);
             curl_easy_cleanup(requests[i].easy);
+            curl_slist_free_all(requests[i].headers);
         }
 
         if (!is_transcription) {
             MetricsManager::UpdateTokens(batch_input_tokens, batch_output_tokens);
+            MetricsManager::UpdateCachedTokens(batch_cached_input_tokens);
         }
         MetricsManager::AddApiDuration(api_duration_ms);
         for (size_t i = 0; i < jsons.size(); ++i) {
@@ -232,6 +349,12 @@ protected:
         }
 
         curl_multi_cleanup(multi_handle);
+        if (!failed.empty()) {
+            throw FailedRequestsError(first_error, std::move(failed), std::move(results), std::move(overflowed));
+        }
+        if (!overflowed.empty()) {
+            throw ExceededMaxOutputTokensError(std::move(overflowed), std::move(results));
+        }
         return results;
     }
 
@@ -240,6 +363,7 @@ protected:
 
 protected:
     bool _throw_exception;
+    long _max_concurrent_requests = DEFAULT_MAX_CONCURRENT_REQUESTS;
     std::vector<nlohmann::json> _request_batch;
     std::vector<RequestType> _request_types;
 
@@ -250,6 +374,8 @@ protected:
     virtual std::vector<std::string> getExtraHeaders() const { return {}; }
     virtual void checkProviderSpecificResponse(const nlohmann::json&, RequestType request_type) {}
     virtual nlohmann::json ExtractCompletionOutput(const nlohmann::json&) const { return {}; }
+    // Raw text of a completion, read leniently when the response was cut off
+    virtual std::string ExtractCompletionText(const nlohmann::json&) const { return {}; }
     virtual nlohmann::json ExtractEmbeddingVector(const nlohmann::json&) const { return {}; }
     virtual nlohmann::json ExtractTranscriptionOutput(const nlohmann::json&) const = 0;
 
@@ -263,7 +389,14 @@ protected:
             return ExtractTranscriptionOutput(parsed);
         }
     }
-    virtual std::pair<int64_t, int64_t> ExtractTokenUsage(const nlohmann::json& response) const = 0;
+    virtual TokenUsage ExtractTokenUsage(const nlohmann::json& response) const = 0;
+
+    std::vector<nlohmann::json> TakeRequestBatch() {
+        auto request_batch = std::move(_request_batch);
+        _request_batch.clear();
+        _request_types.clear();
+        return request_batch;
+    }
 
     void trigger_error(const std::string& msg) {
         if (_throw_exception) {
@@ -2,9 +2,49 @@
 
 #include "flock/core/common.hpp"
 #include <nlohmann/json.hpp>
+#include <vector>
 
 namespace flock {
 
+// Token counts reported by a provider for a single response
+struct TokenUsage {
+    int64_t input_tokens = 0;
+    int64_t output_tokens = 0;
+    // Input tokens served from the provider's prompt-prefix cache (subset of input_tokens)
+    int64_t cached_input_tokens = 0;
+};
+
+class ExceededMaxOutputTokensError : public std::exception {
+public:
+    ExceededMaxOutputTokensError() = default;
+    ExceededMaxOutputTokensError(std::vector<size_t> overflowed, std::vector<nlohmann::json> results)
+        : overflowed(std::move(overflowed)), results(std::move(results)) {}
+
+    const char* what() const noexcept override {
+        return "The response exceeded the max_output_tokens length; increase your max_output_tokens parameter.";
+    }
+
+    // Raised for a collected set of requests: the indexes of the requests that overflowed and the results of the
+    // others. Both are empty when the overflowing request is unknown.
+    std::vector<size_t> overflowed;
+    std::vector<nlohmann::json> results;
+};
+
+// Raised for a collected set of requests when some of them failed: the indexes of the failed requests and the
+// results of the others, whose usage is counted already. Requests that overflowed are listed as for
+// ExceededMaxOutputTokensError. The message is the one of the first failure.
+class FailedRequestsError : public std::runtime_error {
+public:
+    FailedRequestsError(const std::string& message, std::vector<size_t> failed, std::vector<nlohmann::json> results,
+                        std::vector<size_t> overflowed = {})
+        : std::runtime_error(message), failed(std::move(failed)), overflowed(std::move(overflowed)),
+          results(std::move(results)) {}
+
+    std::vector<size_t> failed;
+    std::vector<size_t> overflowed;
+    std::vector<nlohmann::json> results;
+};
+
 class IModelProviderHandler {
 public:
     enum class RequestType { Completion,
@@ -12,6 +52,8 @@ public:
                              Transcription };
 
     virtual ~IModelProviderHandler() = default;
+    // Upper bound on requests in flight at once, for handlers that run requests concurrently
+    virtual void SetMaxConcurrentRequests(long max_concurrent_requests) {}
     // AddRequest: type distinguishes between completion, embedding, and transcription (default: Completion)
     virtual void AddRequest(const nlohmann::json& json, RequestType type = RequestType::Completion) = 0;
 
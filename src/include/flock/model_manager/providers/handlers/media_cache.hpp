@@ -0,0 +1,319 @@
+#pragma once
+
+#include "flock/core/common.hpp"
+#include "flock/core/config.hpp"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <list>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace flock {
+
+// Bounded in-memory (LRU) and on-disk cache of base64-encoded media, keyed by the source URL or file path.
+// Local files are validated by size and mtime; URL entries keep their ETag/Last-Modified for conditional GETs.
+// mutex_ only guards the in-memory tier; disk reads and writes happen outside it, and files are written to a
+// temporary name and renamed so concurrent readers never see a partial file.
+class MediaCache {
+public:
+    static constexpr size_t DEFAULT_MEMORY_LIMIT_BYTES = 256ull << 20;
+    static constexpr size_t DEFAULT_DISK_LIMIT_BYTES = 1ull << 30;
+    // URL entries are served without revalidation for this long after their last check
+    static constexpr int64_t URL_FRESHNESS_SECONDS = 300;
+
+    struct Entry {
+        std::string base64_content;
+        std::string file_validator;// "<size>:<mtime>" for local files
+        std::string etag;
+        std::string last_modified;
+        int64_t validated_at = 0;// Unix seconds of the last successful (re)validation
+    };
+
+    MediaCache(std::filesystem::path cache_dir, size_t memory_limit_bytes = DEFAULT_MEMORY_LIMIT_BYTES,
+               size_t disk_limit_bytes = DEFAULT_DISK_LIMIT_BYTES)
+        : cache_dir_(std::move(cache_dir)), memory_limit_bytes_(memory_limit_bytes), disk_limit_bytes_(disk_limit_bytes) {}
+
+    static MediaCache& Instance() {
+        static MediaCache instance(Config::get_global_storage_path().parent_path() / "media_cache");
+        return instance;
+    }
+
+    static int64_t Now() {
+        return std::chrono::duration_cast<std::chrono::seconds>(
+                       std::chrono::system_clock::now().time_since_epoch())
+                .count();
+    }
+
+    // Size and modification time of a local file, empty if it cannot be stat'ed
+    static std::string GetFileValidator(const std::string& file_path) {
+        std::error_code ec;
+        auto size = std::filesystem::file_size(file_path, ec);
+        if (ec) {
+            return "";
+        }
+        auto mtime = std::filesystem::last_write_time(file_path, ec);
+        if (ec) {
+            return "";
+        }
+        return std::to_string(size) + ":" + std::to_string(mtime.time_since_epoch().count());
+    }
+
+    // Look up an entry in memory, falling back to disk (disk hits are promoted into memory)
+    std::optional<Entry> Get(const std::string& source) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = entries_.find(source);
+            if (it != entries_.end()) {
+                lru_.splice(lru_.begin(), lru_, it->second.second);
+                return it->second.first;
+            }
+        }
+
+        auto entry = ReadFromDisk(source);
+        if (entry.has_value()) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            InsertInMemory(source, *entry);
+        }
+        return entry;
+    }
+
+    // Store an entry in memory and, when persist is set, on disk
+    void Put(const std::string& source, const Entry& entry, bool persist = true) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            InsertInMemory(source, entry);
+        }
+        if (persist) {
+            WriteToDisk(source, entry, true);
+        }
+    }
+
+    // Record a successful revalidation (e.g. HTTP 304) without rewriting the cached content
+    void MarkValidated(const std::string& source, int64_t validated_at) {
+        Entry entry;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = entries_.find(source);
+            if (it == entries_.end()) {
+                return;
+            }
+            it->second.first.validated_at = validated_at;
+            entry = it->second.first;
+        }
+        WriteToDisk(source, entry, false);
+    }
+
+    void Clear() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::lock_guard<std::mutex> disk_lock(disk_mutex_);
+        entries_.clear();
+        lru_.clear();
+        memory_bytes_ = 0;
+        disk_bytes_ = 0;
+        std::error_code ec;
+        std::filesystem::remove_all(cache_dir_, ec);
+    }
+
+    size_t MemoryBytes() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return memory_bytes_;
+    }
+
+    // Running total of cached content on disk, as tracked by this instance
+    uintmax_t DiskBytes() const {
+        std::lock_guard<std::mutex> lock(disk_mutex_);
+        return disk_bytes_.value_or(0);
+    }
+
+private:
+    using LruList = std::list<std::string>;
+
+    std::filesystem::path cache_dir_;
+    size_t memory_limit_bytes_;
+    size_t disk_limit_bytes_;
+
+    mutable std::mutex mutex_;
+    LruList lru_;
+    std::unordered_map<std::string, std::pair<Entry, LruList::iterator>> entries_;
+    size_t memory_bytes_ = 0;
+
+    // Guards the disk byte count and eviction, never held while writing entries
+    mutable std::mutex disk_mutex_;
+    std::optional<uintmax_t> disk_bytes_;// unknown until the directory is first scanned
+
+    static std::string HashKey(const std::string& source) {
+        // FNV-1a, good enough for file names; the source is stored alongside to detect collisions
+        uint64_t hash = 14695981039346656037ull;
+        for (unsigned char c: source) {
+            hash ^= c;
+            hash *= 1099511628211ull;
+        }
+        std::ostringstream oss;
+        oss << std::hex << hash;
+        return oss.str();
+    }
+
+    void InsertInMemory(const std::string& source, const Entry& entry) {
+        auto it = entries_.find(source);
+        if (it != entries_.end()) {
+            memory_bytes_ -= it->second.first.base64_content.size();
+            lru_.erase(it->second.second);
+            entries_.erase(it);
+        }
+        if (entry.base64_content.size() > memory_limit_bytes_) {
+            return;
+        }
+
+        lru_.push_front(source);
+        entries_.emplace(source, std::make_pair(entry, lru_.begin()));
+        memory_bytes_ += entry.base64_content.size();
+
+        while (memory_bytes_ > memory_limit_bytes_ && !lru_.empty()) {
+            auto victim = entries_.find(lru_.back());
+            memory_bytes_ -= victim->second.first.base64_content.size();
+            entries_.erase(victim);
+            lru_.pop_back();
+        }
+    }
+
+    std::optional<Entry> ReadFromDisk(const std::string& source) const {
+        auto key = HashKey(source);
+        std::ifstream meta_file(cache_dir_ / (key + ".json"));
+        std::ifstream data_file(cache_dir_ / (key + ".b64"), std::ios::binary);
+        if (!meta_file || !data_file) {
+            return std::nullopt;
+        }
+
+        nlohmann::json meta;
+        try {
+            meta_file >> meta;
+        } catch (...) {
+            return std::nullopt;
+        }
+        if (meta.value("source", "") != source) {
+            return std::nullopt;
+        }
+
+        Entry entry;
+        entry.etag = meta.value("etag", "");
+        entry.last_modified = meta.value("last_modified", "");
+        entry.file_validator = meta.value("file_validator", "");
+        entry.validated_at = meta.value("validated_at", static_cast<int64_t>(0));
+        std::ostringstream content;
+        content << data_file.rdbuf();
+        entry.base64_content = content.str();
+        if (entry.base64_content.empty()) {
+            return std::nullopt;
+        }
+        return entry;
+    }
+
+    // Write to a per-thread temporary name and rename over the target, so the file appears atomically
+    static bool WriteFileAtomically(const std::filesystem::path& path, const std::string& content) {
+        auto temp_path = path;
+        temp_path += "." + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id())) + ".tmp";
+        {
+            std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+            file << content;
+            if (!file) {
+                std::error_code ec;
+                std::filesystem::remove(temp_path, ec);
+                return false;
+            }
+        }
+        std::error_code ec;
+        std::filesystem::rename(temp_path, path, ec);
+        if (ec) {
+            std::filesystem::remove(temp_path, ec);
+            return false;
+        }
+        return true;
+    }
+
+    void WriteToDisk(const std::string& source, const Entry& entry, bool write_content) {
+        std::error_code ec;
+        std::filesystem::create_directories(cache_dir_, ec);
+        if (ec) {
+            return;
+        }
+
+        auto key = HashKey(source);
+        auto data_path = cache_dir_ / (key + ".b64");
+        if (write_content) {
+            auto replaced_size = std::filesystem::file_size(data_path, ec);
+            if (ec) {
+                replaced_size = 0;
+            }
+            if (!WriteFileAtomically(data_path, entry.base64_content)) {
+                return;
+            }
+            AddDiskBytes(entry.base64_content.size(), replaced_size);
+        }
+        nlohmann::json meta = {{"source", source},
+                               {"etag", entry.etag},
+                               {"last_modified", entry.last_modified},
+                               {"file_validator", entry.file_validator},
+                               {"validated_at", entry.validated_at}};
+        WriteFileAtomically(cache_dir_ / (key + ".json"), meta.dump());
+    }
+
+    // Update the running byte count and only rescan the directory once it goes over budget
+    void AddDiskBytes(uintmax_t written, uintmax_t replaced) {
+        std::lock_guard<std::mutex> lock(disk_mutex_);
+        if (!disk_bytes_.has_value()) {
+            disk_bytes_ = EnforceDiskLimit();
+            return;
+        }
+        auto total = *disk_bytes_ + written;
+        disk_bytes_ = total > replaced ? total - replaced : 0;
+        if (*disk_bytes_ > disk_limit_bytes_) {
+            disk_bytes_ = EnforceDiskLimit();
+        }
+    }
+
+    // Evict the least recently written entries until the cache directory fits its budget, returning the new total
+    uintmax_t EnforceDiskLimit() {
+        struct CachedFile {
+            std::filesystem::path path;
+            std::filesystem::file_time_type mtime;
+            uintmax_t size;
+        };
+        std::vector<CachedFile> files;
+        uintmax_t total_size = 0;
+        std::error_code ec;
+        for (const auto& dir_entry: std::filesystem::directory_iterator(cache_dir_, ec)) {
+            if (!dir_entry.is_regular_file(ec) || dir_entry.path().extension() != ".b64") {
+                continue;
+            }
+            auto size = dir_entry.file_size(ec);
+            files.push_back({dir_entry.path(), dir_entry.last_write_time(ec), size});
+            total_size += size;
+        }
+        if (total_size <= disk_limit_bytes_) {
+            return total_size;
+        }
+
+        std::sort(files.begin(), files.end(), [](const CachedFile& a, const CachedFile& b) { return a.mtime < b.mtime; });
+        for (const auto& file: files) {
+            if (total_size <= disk_limit_bytes_) {
+                break;
+            }
+            auto meta_path = file.path;
+            meta_path.replace_extension(".json");
+            std::filesystem::remove(file.path, ec);
+            std::filesystem::remove(meta_path, ec);
+            total_size -= file.size;
+        }
+        return total_size;
+    }
+};
+
+}// namespace flock
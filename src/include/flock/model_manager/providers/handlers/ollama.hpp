@@ -36,7 +36,12 @@ protected:
         }
         bool is_completion = (request_type == RequestType::Completion);
         if (is_completion) {
-            if (response.contains("done_reason") && response["done_reason"] != "stop") {
+            // A yes/no request is cut off at its single token on purpose
+            const auto cut_off = response.contains("done_reason") && response["done_reason"] == "length";
+            if (cut_off && !HasLogprobs(response)) {
+                throw ExceededMaxOutputTokensError();
+            }
+            if (!cut_off && response.contains("done_reason") && response["done_reason"] != "stop") {
                 throw std::runtime_error("The request was refused due to some internal error with Ollama API");
             }
             if (response.contains("done") && !response["done"].is_null() && !response["done"].get<bool>()) {
@@ -49,7 +54,25 @@ protected:
         }
     }
 
+    std::string ExtractCompletionText(const nlohmann::json& response) const override {
+        if (response.contains("message") && response["message"].is_object()) {
+            const auto& message = response["message"];
+            if (message.contains("content") && message["content"].is_string()) {
+                return message["content"].get<std::string>();
+            }
+        }
+        return {};
+    }
+
+    static bool HasLogprobs(const nlohmann::json& response) {
+        return response.contains("logprobs") && response["logprobs"].is_array() && !response["logprobs"].empty();
+    }
+
     nlohmann::json ExtractCompletionOutput(const nlohmann::json& response) const override {
+        if (HasLogprobs(response)) {
+            const auto& token = response["logprobs"][0];
+            return {{"items", {YesProbability(token.value("top_logprobs", nlohmann::json::array()))}}};
+        }
         if (response.contains("message") && response["message"].is_object()) {
             const auto& message = response["message"];
             if (message.contains("content")) {
@@ -96,16 +119,15 @@ protected:
         return {};
     }
 
-    std::pair<int64_t, int64_t> ExtractTokenUsage(const nlohmann::json& response) const override {
-        int64_t input_tokens = 0;
-        int64_t output_tokens = 0;
+    TokenUsage ExtractTokenUsage(const nlohmann::json& response) const override {
+        TokenUsage token_usage;
         if (response.contains("prompt_eval_count") && response["prompt_eval_count"].is_number()) {
-            input_tokens = response["prompt_eval_count"].get<int64_t>();
+            token_usage.input_tokens = response["prompt_eval_count"].get<int64_t>();
         }
         if (response.contains("eval_count") && response["eval_count"].is_number()) {
-            output_tokens = response["eval_count"].get<int64_t>();
+            token_usage.output_tokens = response["eval_count"].get<int64_t>();
         }
-        return {input_tokens, output_tokens};
+        return token_usage;
     }
 
 
@@ -62,7 +62,11 @@ protected:
                 const auto& choice = response["choices"][0];
                 if (choice.contains("finish_reason") && !choice["finish_reason"].is_null()) {
                     std::string finish_reason = choice["finish_reason"].get<std::string>();
-                    if (finish_reason != "stop" && finish_reason != "length") {
+                    // A yes/no request is cut off at its single token on purpose
+                    if (finish_reason == "length" && !HasLogprobs(choice)) {
+                        throw ExceededMaxOutputTokensError();
+                    }
+                    if (finish_reason != "stop") {
                         throw std::runtime_error("OpenAI API did not finish successfully. finish_reason: " + finish_reason);
                     }
                 }
@@ -73,9 +77,29 @@ protected:
             }
         }
     }
+    std::string ExtractCompletionText(const nlohmann::json& response) const override {
+        if (response.contains("choices") && response["choices"].is_array() && !response["choices"].empty()) {
+            const auto& message = response["choices"][0].value("message", nlohmann::json::object());
+            if (message.contains("content") && message["content"].is_string()) {
+                return message["content"].get<std::string>();
+            }
+        }
+        return {};
+    }
+
+    static bool HasLogprobs(const nlohmann::json& choice) {
+        return choice.contains("logprobs") && choice["logprobs"].is_object() &&
+               choice["logprobs"].contains("content") && choice["logprobs"]["content"].is_array() &&
+               !choice["logprobs"]["content"].empty();
+    }
+
     nlohmann::json ExtractCompletionOutput(const nlohmann::json& response) const override {
         if (response.contains("choices") && response["choices"].is_array() && !response["choices"].empty()) {
             const auto& choice = response["choices"][0];
+            if (HasLogprobs(choice)) {
+                const auto& token = choice["logprobs"]["content"][0];
+                return {{"items", {YesProbability(token.value("top_logprobs", nlohmann::json::array()))}}};
+            }
             if (choice.contains("message") && choice["message"].contains("content")) {
                 return nlohmann::json::parse(choice["message"]["content"].get<std::string>());
             }
@@ -94,19 +118,25 @@ protected:
         }
     }
 
-    std::pair<int64_t, int64_t> ExtractTokenUsage(const nlohmann::json& response) const override {
-        int64_t input_tokens = 0;
-        int64_t output_tokens = 0;
+    TokenUsage ExtractTokenUsage(const nlohmann::json& response) const override {
+        TokenUsage token_usage;
         if (response.contains("usage") && response["usage"].is_object()) {
             const auto& usage = response["usage"];
             if (usage.contains("prompt_tokens") && usage["prompt_tokens"].is_number()) {
-                input_tokens = usage["prompt_tokens"].get<int64_t>();
+                token_usage.input_tokens = usage["prompt_tokens"].get<int64_t>();
             }
             if (usage.contains("completion_tokens") && usage["completion_tokens"].is_number()) {
-                output_tokens = usage["completion_tokens"].get<int64_t>();
+                token_usage.output_tokens = usage["completion_tokens"].get<int64_t>();
+            }
+            // Automatic prefix caching reports the reused part of prompt_tokens here
+            if (usage.contains("prompt_tokens_details") && usage["prompt_tokens_details"].is_object()) {
+                const auto& details = usage["prompt_tokens_details"];
+                if (details.contains("cached_tokens") && details["cached_tokens"].is_number()) {
+                    token_usage.cached_input_tokens = details["cached_tokens"].get<int64_t>();
+                }
             }
         }
-        return {input_tokens, output_tokens};
+        return token_usage;
     }
 
 
@@ -2,6 +2,9 @@
 
 #include "flock/core/common.hpp"
 #include "flock/core/config.hpp"
+#include "flock/model_manager/providers/handlers/media_cache.hpp"
+#include <algorithm>
+#include <cctype>
 #include <cstdio>
 #include <curl/curl.h>
 #include <filesystem>
@@ -73,6 +76,11 @@ public:
         return file_size > 0;
     }
 
+    // Validate downloaded content the same way ValidateFile checks files on disk
+    static bool ValidateContent(const std::string& content) {
+        return !content.empty();
+    }
+
     // Download file from URL to temporary location
     // Supports http:// and https:// URLs
     static std::string DownloadFileToTemp(const std::string& url) {
@@ -112,6 +120,73 @@ public:
         return temp_filename;
     }
 
+    // Result of an in-memory HTTP GET, including the validators needed for later conditional requests
+    struct FetchResult {
+        long status = 0;
+        std::string body;
+        std::string etag;
+        std::string last_modified;
+    };
+
+    // Download a URL into memory; when a validator is given the request is conditional and may return 304
+    static FetchResult FetchUrl(const std::string& url, const std::string& etag = "", const std::string& last_modified = "") {
+        FetchResult result;
+        CURL* curl = curl_easy_init();
+        if (!curl) {
+            return result;
+        }
+
+        struct curl_slist* headers = nullptr;
+        if (!etag.empty()) {
+            headers = curl_slist_append(headers, ("If-None-Match: " + etag).c_str());
+        }
+        if (!last_modified.empty()) {
+            headers = curl_slist_append(headers, ("If-Modified-Since: " + last_modified).c_str());
+        }
+
+        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+        curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+        if (headers != nullptr) {
+            curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+        }
+        curl_easy_setopt(
+                curl, CURLOPT_WRITEFUNCTION, +[](char* ptr, size_t size, size_t nmemb, void* userdata) -> size_t {
+                    static_cast<std::string*>(userdata)->append(ptr, size * nmemb);
+                    return size * nmemb; });
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &result.body);
+        curl_easy_setopt(
+                curl, CURLOPT_HEADERFUNCTION, +[](char* buffer, size_t size, size_t nitems, void* userdata) -> size_t {
+                    auto* fetch_result = static_cast<FetchResult*>(userdata);
+                    std::string line(buffer, size * nitems);
+                    auto colon = line.find(':');
+                    if (colon != std::string::npos) {
+                        auto name = line.substr(0, colon);
+                        std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return std::tolower(c); });
+                        auto value = line.substr(colon + 1);
+                        value.erase(0, value.find_first_not_of(" \t"));
+                        value.erase(value.find_last_not_of(" \t\r\n") + 1);
+                        if (name == "etag") {
+                            fetch_result->etag = value;
+                        } else if (name == "last-modified") {
+                            fetch_result->last_modified = value;
+                        }
+                    }
+                    return size * nitems; });
+        curl_easy_setopt(curl, CURLOPT_HEADERDATA, &result);
+
+        CURLcode res = curl_easy_perform(curl);
+        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &result.status);
+        if (headers != nullptr) {
+            curl_slist_free_all(headers);
+        }
+        curl_easy_cleanup(curl);
+
+        if (res != CURLE_OK) {
+            result.status = 0;
+        }
+        return result;
+    }
+
     // Helper struct to return file path and temp file flag
     struct FilePathResult {
         std::string file_path;
@@ -171,24 +246,29 @@ public:
             return "";
         }
 
+        return EncodeBase64(buffer.data(), bytes_read);
+    }
+
+    // Base64-encode a byte buffer
+    static std::string EncodeBase64(const unsigned char* data, size_t size) {
         // Base64 encoding table
         static const char base64_chars[] =
                 "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
 
         std::string result;
-        result.reserve(((file_size + 2) / 3) * 4);
+        result.reserve(((size + 2) / 3) * 4);
 
-        for (size_t i = 0; i < bytes_read; i += 3) {
-            unsigned int octet_a = buffer[i];
-            unsigned int octet_b = (i + 1 < bytes_read) ? buffer[i + 1] : 0;
-            unsigned int octet_c = (i + 2 < bytes_read) ? buffer[i + 2] : 0;
+        for (size_t i = 0; i < size; i += 3) {
+            unsigned int octet_a = data[i];
+            unsigned int octet_b = (i + 1 < size) ? data[i + 1] : 0;
+            unsigned int octet_c = (i + 2 < size) ? data[i + 2] : 0;
 
             unsigned int triple = (octet_a << 16) + (octet_b << 8) + octet_c;
 
             result.push_back(base64_chars[(triple >> 18) & 0x3F]);
             result.push_back(base64_chars[(triple >> 12) & 0x3F]);
-            result.push_back((i + 1 < bytes_read) ? base64_chars[(triple >> 6) & 0x3F] : '=');
-            result.push_back((i + 2 < bytes_read) ? base64_chars[triple & 0x3F] : '=');
+            result.push_back((i + 1 < size) ? base64_chars[(triple >> 6) & 0x3F] : '=');
+            result.push_back((i + 2 < size) ? base64_chars[triple & 0x3F] : '=');
         }
 
         return result;
@@ -202,46 +282,67 @@ public:
     };
 
     // Resolve file path or URL, read contents and convert to base64
-    // If input is URL, downloads to temp file first
-    // Returns base64 content and temp file info for cleanup
+    // Results are served from MediaCache: local files are re-read only when their size or mtime changes,
+    // URLs are revalidated with a conditional GET once their cached copy is older than URL_FRESHNESS_SECONDS
     // Throws std::runtime_error if file cannot be processed
     static Base64Result ResolveFileToBase64(const std::string& file_path_or_url) {
         Base64Result result;
         result.is_temp_file = false;
 
-        std::string file_path;
-        if (IsUrl(file_path_or_url)) {
-            file_path = DownloadFileToTemp(file_path_or_url);
-            if (file_path.empty()) {
-                throw std::runtime_error("Failed to download file: " + file_path_or_url);
+        auto& cache = MediaCache::Instance();
+        auto cached = cache.Get(file_path_or_url);
+
+        if (!IsUrl(file_path_or_url)) {
+            auto validator = MediaCache::GetFileValidator(file_path_or_url);
+            if (validator.empty() || !ValidateFile(file_path_or_url)) {
+                throw std::runtime_error("Invalid file: " + file_path_or_url);
+            }
+            if (cached.has_value() && cached->file_validator == validator) {
+                result.base64_content = std::move(cached->base64_content);
+                return result;
             }
-            result.is_temp_file = true;
-            result.temp_file_path = file_path;
-        } else {
-            file_path = file_path_or_url;
-        }
 
-        if (!ValidateFile(file_path)) {
-            if (result.is_temp_file) {
-                std::remove(file_path.c_str());
+            result.base64_content = ReadFileToBase64(file_path_or_url);
+            if (result.base64_content.empty()) {
+                throw std::runtime_error("Failed to read file: " + file_path_or_url);
             }
-            throw std::runtime_error("Invalid file: " + file_path_or_url);
+            MediaCache::Entry entry;
+            entry.base64_content = result.base64_content;
+            entry.file_validator = validator;
+            entry.validated_at = MediaCache::Now();
+            // The file is already on disk, keep only the encoded copy in memory
+            cache.Put(file_path_or_url, entry, false);
+            return result;
         }
 
-        result.base64_content = ReadFileToBase64(file_path);
-        if (result.base64_content.empty()) {
-            if (result.is_temp_file) {
-                std::remove(file_path.c_str());
-            }
-            throw std::runtime_error("Failed to read file: " + file_path_or_url);
+        auto now = MediaCache::Now();
+        if (cached.has_value() && now - cached->validated_at < MediaCache::URL_FRESHNESS_SECONDS) {
+            result.base64_content = std::move(cached->base64_content);
+            return result;
         }
 
-        // Cleanup temp file after reading
-        if (result.is_temp_file) {
-            std::remove(file_path.c_str());
-            result.temp_file_path.clear();
+        auto fetched = cached.has_value() ? FetchUrl(file_path_or_url, cached->etag, cached->last_modified)
+                                          : FetchUrl(file_path_or_url);
+        if (fetched.status == 304 && cached.has_value()) {
+            cache.MarkValidated(file_path_or_url, now);
+            result.base64_content = std::move(cached->base64_content);
+            return result;
+        }
+        if (fetched.status != 200) {
+            throw std::runtime_error("Failed to download file: " + file_path_or_url);
         }
+        if (!ValidateContent(fetched.body)) {
+            throw std::runtime_error("Invalid file: " + file_path_or_url);
+        }
+
+        MediaCache::Entry entry;
+        entry.base64_content = EncodeBase64(reinterpret_cast<const unsigned char*>(fetched.body.data()), fetched.body.size());
+        entry.etag = fetched.etag;
+        entry.last_modified = fetched.last_modified;
+        entry.validated_at = now;
+        cache.Put(file_path_or_url, entry);
 
+        result.base64_content = std::move(entry.base64_content);
         return result;
     }
 };
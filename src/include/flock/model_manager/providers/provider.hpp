@@ -21,6 +21,9 @@ enum class OutputType {
 
 class IProvider {
 public:
+    // Alternatives returned for the single answer token of a yes/no request
+    static constexpr int YES_NO_TOP_LOGPROBS = 5;
+
     ModelDetails model_details_;
     std::unique_ptr<IModelProviderHandler> model_handler_;
 
@@ -30,6 +33,11 @@ public:
     virtual void AddCompletionRequest(const std::string& prompt, const int num_output_tuples, OutputType output_type, const nlohmann::json& media_data) = 0;
     virtual void AddEmbeddingRequest(const std::vector<std::string>& inputs) = 0;
     virtual void AddTranscriptionRequest(const nlohmann::json& audio_files) = 0;
+    // One-token yes/no completion whose result is {"items": [probability of yes]}
+    virtual void AddYesNoRequest(const std::string& prompt, const nlohmann::json& media_data) {
+        throw std::runtime_error(duckdb_fmt::format("Provider '{}' does not return log probabilities",
+                                                    model_details_.provider_name));
+    }
 
     virtual std::vector<nlohmann::json> CollectCompletions(const std::string& contentType = "application/json") {
         return model_handler_->CollectCompletions(contentType);
@@ -57,11 +65,4 @@ public:
     }
 };
 
-class ExceededMaxOutputTokensError : public std::exception {
-public:
-    const char* what() const noexcept override {
-        return "The response exceeded the max_output_tokens length; increase your max_output_tokens parameter.";
-    }
-};
-
 }// namespace flock
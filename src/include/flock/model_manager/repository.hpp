@@ -8,6 +8,28 @@
 
 namespace flock {
 
+// How rows are spread over requests: THROUGHPUT packs many tuples into each prompt, LATENCY sends every tuple as
+// its own request and runs more of them at once
+enum class ExecutionMode {
+    THROUGHPUT,
+    LATENCY
+};
+
+inline ExecutionMode ParseExecutionMode(std::string mode) {
+    std::transform(mode.begin(), mode.end(), mode.begin(), [](unsigned char c) { return std::tolower(c); });
+    if (mode == "throughput") {
+        return ExecutionMode::THROUGHPUT;
+    }
+    if (mode == "latency") {
+        return ExecutionMode::LATENCY;
+    }
+    throw std::invalid_argument("Expected 'execution_mode' to be 'throughput' or 'latency', got '" + mode + "'");
+}
+
+inline std::string ExecutionModeToString(ExecutionMode mode) {
+    return mode == ExecutionMode::LATENCY ? "latency" : "throughput";
+}
+
 struct ModelDetails {
     std::string provider_name;
     std::string model_name;
@@ -16,6 +38,7 @@ struct ModelDetails {
     std::string tuple_format;
     int batch_size;
     nlohmann::json model_parameters;
+    ExecutionMode execution_mode = ExecutionMode::THROUGHPUT;
 };
 
 const std::string OLLAMA = "ollama";
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "flock/core/common.hpp"
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace flock {
+
+// Byte-level BPE tokenizer over a tiktoken rank file ("<base64 token> <rank>" per line). All token bytes live in
+// one buffer and the rank table points into it, so encoding only allocates the merge boundaries of each piece.
+class BpeTokenizer {
+public:
+    static std::shared_ptr<const BpeTokenizer> LoadFromFile(const std::filesystem::path& path);
+    // Build from ranks directly, e.g. for tests
+    static std::shared_ptr<const BpeTokenizer> FromRanks(const std::vector<std::pair<std::string, uint32_t>>& ranks);
+
+    std::vector<uint32_t> Encode(std::string_view text) const;
+    size_t Count(std::string_view text) const;
+
+    // Split text the way the cl100k pre-tokenization pattern does; letters are approximated as ASCII letters and
+    // any non-ASCII code point
+    static std::vector<std::string_view> SplitPieces(std::string_view text);
+
+private:
+    // Merge one piece and call on_token with the rank of every resulting token
+    template<typename OnToken>
+    void MergePiece(std::string_view piece, OnToken&& on_token) const;
+
+    std::string token_bytes_;
+    std::unordered_map<std::string_view, uint32_t> ranks_;
+};
+
+// Token counts by model. OpenAI models use their own encoding; other providers are approximated with cl100k.
+// Rank files are read from the tokenizer directory and when none is available counting falls back to about four
+// characters per token.
+class TokenCounter {
+public:
+    static constexpr auto CL100K_BASE = "cl100k_base";
+    static constexpr auto O200K_BASE = "o200k_base";
+
+    static std::string EncodingForModel(const std::string& model);
+    // $FLOCK_TOKENIZER_DIR, or ~/.duckdb/flock_storage/tokenizers
+    static std::filesystem::path TokenizerDirectory();
+    // Loaded once per encoding from <directory>/<encoding>.tiktoken; nullptr when the file is missing
+    static std::shared_ptr<const BpeTokenizer> ForModel(const std::string& model);
+    static int64_t Count(const std::string& model, std::string_view text);
+    static int64_t Approximate(std::string_view text);
+    // Forget loaded tokenizers, e.g. after the tokenizer directory changed
+    static void ClearCache();
+};
+
+}// namespace flock
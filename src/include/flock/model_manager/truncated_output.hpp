@@ -0,0 +1,13 @@
+#pragma once
+
+#include "flock/core/common.hpp"
+#include <nlohmann/json.hpp>
+#include <string_view>
+
+namespace flock {
+
+// The items of a structured output that was cut off at the output token limit. Reads `{"items": [...` up to the
+// last item that is complete and valid JSON; the cut item and anything after it are dropped.
+nlohmann::json ParseTruncatedItems(std::string_view text);
+
+}// namespace flock
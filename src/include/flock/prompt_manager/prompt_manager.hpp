@@ -48,6 +48,9 @@ public:
 
     // Helper function to transcribe audio column and create transcription text column
     static nlohmann::json TranscribeAudioColumn(const nlohmann::json& audio_column);
+    // Transcribe all uncached audio of a chunk up front so per-batch rendering only hits the transcript cache
+    static void PrefetchTranscriptions(const nlohmann::json& columns);
+    static void ClearTranscriptionCache();
 
 public:
     template<typename FunctionType>
@@ -75,13 +78,16 @@ public:
             }
         }
 
-        // Create media_data as an object with only image array (audio is now in tabular_data)
+        // Create media_data with the image array (audio is now in tabular_data) and the prompt prefix length
         nlohmann::json media_data;
         media_data["image"] = image_data;
         media_data["audio"] = nlohmann::json::array();// Empty - audio is now in tabular_data
 
         auto prompt = PromptManager::GetTemplate(option);
         prompt = PromptManager::ReplaceSection(prompt, PromptSection::USER_PROMPT, user_prompt);
+        // Everything before the table header is the same for every batch. Its length is taken before the tuples are
+        // filled in, so row values that contain the header cannot move it, and providers can cache that prefix.
+        media_data[PROMPT_PREFIX_LENGTH] = prompt.rfind(TUPLES_SECTION_HEADER);
         if (!tabular_data.empty()) {
             auto tuples = PromptManager::ConstructInputTuples(tabular_data, tuple_format);
             prompt = PromptManager::ReplaceSection(prompt, PromptSection::TUPLES, tuples);
@@ -16,7 +16,9 @@ enum class AggregateFunctionType { REDUCE,
                                    RERANK };
 
 enum class ScalarFunctionType { COMPLETE,
-                                FILTER };
+                                FILTER,
+                                YES_NO,
+                                CLASSIFY };
 
 enum class TupleFormat { XML,
                          JSON,
@@ -29,8 +31,14 @@ inline std::unordered_map<std::string, TupleFormat> TUPLE_FORMAT = {
 
 TupleFormat stringToTupleFormat(const std::string& format);
 
-constexpr auto META_PROMPT =
-        "# System Setup\n"
+// Everything before this header is identical for every batch of a query, so the table data is kept
+// last and providers can cache the rendered prefix.
+constexpr auto TUPLES_SECTION_HEADER = "## Table Data\n";
+// Key of the rendered media data that holds the length of that prefix
+constexpr auto PROMPT_PREFIX_LENGTH = "prompt_prefix_length";
+
+inline const std::string META_PROMPT =
+        std::string("# System Setup\n"
         "You are **FlockMTL**, a semantic analysis tool for DBMS that can process both **text and image-derived data**.\n"
         "Your task is to reason over a structured dataset where **some columns originate from text and others come from external sources** like images or separate dictionaries.\n"
         "\n"
@@ -51,12 +59,6 @@ constexpr auto META_PROMPT =
         "{{USER_PROMPT}}\n"
         "```\n"
         "\n"
-        "## Table Data\n"
-        "```\n"
-        "{{TUPLES}}\n"
-        "```\n"
-        "*Some columns may be embedded as text; others may reference external images—treat them all equally.*\n"
-        "\n"
         "## Instructions\n"
         "```\n"
         "{{INSTRUCTIONS}}\n"
@@ -69,7 +71,13 @@ constexpr auto META_PROMPT =
         "```\n"
         "{{RESPONSE_FORMAT}}\n"
         "```\n"
-        "Ensure your results follow this format exactly, with **no extra commentary**.\n";
+        "Ensure your results follow this format exactly, with **no extra commentary**.\n"
+        "\n") +
+        TUPLES_SECTION_HEADER +
+        "```\n"
+        "{{TUPLES}}\n"
+        "```\n"
+        "*Some columns may be embedded as text; others may reference external images—treat them all equally.*\n";
 
 
 class INSTRUCTIONS {
@@ -104,6 +112,15 @@ public:
             "Return 'true' if the row meets the criteria, and 'false' otherwise. "
             "Ensure that each row is evaluated independently and that no row is skipped.";
 
+    static constexpr auto CLASSIFY =
+            "For each row in the provided table, choose the one label of the user's prompt that fits the row best "
+            "and return the number of that label. "
+            "Ensure that each row is classified independently and that no row is skipped.";
+
+    static constexpr auto YES_NO =
+            "Answer with the single word 'yes' if the row satisfies the user's prompt and 'no' otherwise, "
+            "with nothing before or after it.";
+
     // Aggregate Functions
     static constexpr auto REDUCE =
             "Analyze each row in the provided table to extract the most pertinent information related to the user's prompt. "
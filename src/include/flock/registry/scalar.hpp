@@ -12,6 +12,8 @@ private:
     static void RegisterLlmComplete(duckdb::ExtensionLoader& loader);
     static void RegisterLlmEmbedding(duckdb::ExtensionLoader& loader);
     static void RegisterLlmFilter(duckdb::ExtensionLoader& loader);
+    static void RegisterLlmClassify(duckdb::ExtensionLoader& loader);
+    static void RegisterLlmTokenCount(duckdb::ExtensionLoader& loader);
     static void RegisterFusionRRF(duckdb::ExtensionLoader& loader);
     static void RegisterFusionCombANZ(duckdb::ExtensionLoader& loader);
     static void RegisterFusionCombMED(duckdb::ExtensionLoader& loader);
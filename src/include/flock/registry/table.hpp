@@ -0,0 +1,15 @@
+#pragma once
+
+#include "flock/core/common.hpp"
+
+namespace flock {
+
+class TableRegistry {
+public:
+    static void Register(duckdb::ExtensionLoader& loader);
+
+private:
+    static void RegisterLlmPipelined(duckdb::ExtensionLoader& loader);
+};
+
+}// namespace flock
@@ -69,6 +69,7 @@ void MetricsManager::MergeAggregateMetrics(duckdb::DatabaseInstance* db,
     // Get and merge metrics from all processed states
     int64_t total_input_tokens = 0;
     int64_t total_output_tokens = 0;
+    int64_t total_cached_input_tokens = 0;
     int64_t total_api_calls = 0;
     int64_t total_api_duration_us = 0;
     int64_t total_execution_time_us = 0;
@@ -82,6 +83,7 @@ void MetricsManager::MergeAggregateMetrics(duckdb::DatabaseInstance* db,
         if (!metrics.IsEmpty()) {
             total_input_tokens += metrics.input_tokens;
             total_output_tokens += metrics.output_tokens;
+            total_cached_input_tokens += metrics.cached_input_tokens;
             total_api_calls += metrics.api_calls;
             total_api_duration_us += metrics.api_duration_us;
             total_execution_time_us += metrics.execution_time_us;
@@ -101,6 +103,7 @@ void MetricsManager::MergeAggregateMetrics(duckdb::DatabaseInstance* db,
     // Set the aggregated values directly
     merged_metrics.input_tokens = total_input_tokens;
     merged_metrics.output_tokens = total_output_tokens;
+    merged_metrics.cached_input_tokens = total_cached_input_tokens;
     merged_metrics.api_calls = total_api_calls;
     merged_metrics.api_duration_us = total_api_duration_us;
     merged_metrics.execution_time_us = total_execution_time_us;
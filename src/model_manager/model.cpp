@@ -39,6 +39,9 @@ void Model::LoadModelDetails(const nlohmann::json& model_json) {
         model_details_.secret = model_json["secret"].get<std::unordered_map<std::string, std::string>>();
         model_details_.tuple_format = model_json.at("tuple_format").get<std::string>();
         model_details_.batch_size = model_json.at("batch_size").get<int>();
+        if (model_json.contains("execution_mode")) {
+            model_details_.execution_mode = ParseExecutionMode(model_json.at("execution_mode").get<std::string>());
+        }
 
         if (model_json.contains("model_parameters")) {
             auto& mp = model_json.at("model_parameters");
@@ -89,10 +92,16 @@ void Model::LoadModelDetails(const nlohmann::json& model_json) {
         } else {
             model_details_.batch_size = 2048;
         }
+
+        if (model_json.contains("execution_mode")) {
+            model_details_.execution_mode = ParseExecutionMode(model_json.at("execution_mode").get<std::string>());
+        } else if (db_model_args.contains("execution_mode")) {
+            model_details_.execution_mode = ParseExecutionMode(db_model_args.at("execution_mode").get<std::string>());
+        }
     }
 }
 
-std::tuple<std::string, std::string, nlohmann::basic_json<>> Model::GetQueriedModel(const std::string& model_name) {
+std::tuple<std::string, std::string, nlohmann::ordered_json> Model::GetQueriedModel(const std::string& model_name) {
     const std::string query =
             duckdb_fmt::format(" SELECT model, provider_name, model_args "
                                " FROM flock_storage.flock_config.FLOCKMTL_MODEL_USER_DEFINED_INTERNAL_TABLE"
@@ -121,7 +130,7 @@ std::tuple<std::string, std::string, nlohmann::basic_json<>> Model::GetQueriedMo
 
     auto model = query_result->GetValue(0, 0).ToString();
     auto provider_name = query_result->GetValue(1, 0).ToString();
-    auto model_args = nlohmann::json::parse(query_result->GetValue(2, 0).ToString());
+    auto model_args = nlohmann::ordered_json::parse(query_result->GetValue(2, 0).ToString());
 
     return {model, provider_name, model_args};
 }
@@ -152,6 +161,10 @@ void Model::ConstructProvider() {
         default:
             throw std::invalid_argument(duckdb_fmt::format("Unsupported provider: {}", model_details_.provider_name));
     }
+
+    if (model_details_.execution_mode == ExecutionMode::LATENCY) {
+        provider_->model_handler_->SetMaxConcurrentRequests(LATENCY_MAX_CONCURRENT_REQUESTS);
+    }
 }
 
 ModelDetails Model::GetModelDetails() { return model_details_; }
@@ -167,6 +180,9 @@ nlohmann::json Model::GetModelDetailsAsJson() const {
     if (!model_details_.model_parameters.empty()) {
         result["model_parameters"] = model_details_.model_parameters;
     }
+    if (model_details_.execution_mode != ExecutionMode::THROUGHPUT) {
+        result["execution_mode"] = ExecutionModeToString(model_details_.execution_mode);
+    }
     return result;
 }
 
@@ -181,6 +197,18 @@ nlohmann::json Model::ResolveModelDetailsToJson(const nlohmann::json& user_model
     return resolved_json;
 }
 
+nlohmann::ordered_json Model::ResolveModelParameters(const nlohmann::json& user_model_json) {
+    if (user_model_json.contains("model_parameters")) {
+        const auto& mp = user_model_json["model_parameters"];
+        return mp.is_string() ? nlohmann::ordered_json::parse(mp.get<std::string>()) : nlohmann::ordered_json(mp);
+    }
+    if (!user_model_json.contains("model_name")) {
+        return nlohmann::ordered_json::object();
+    }
+    auto model_args = std::get<2>(GetQueriedModel(user_model_json["model_name"].get<std::string>()));
+    return model_args.contains("model_parameters") ? model_args["model_parameters"] : nlohmann::ordered_json::object();
+}
+
 void Model::AddCompletionRequest(const std::string& prompt, const int num_output_tuples, OutputType output_type, const nlohmann::json& media_data) {
     provider_->AddCompletionRequest(prompt, num_output_tuples, output_type, media_data);
 }
@@ -193,6 +221,10 @@ void Model::AddTranscriptionRequest(const nlohmann::json& audio_files) {
     provider_->AddTranscriptionRequest(audio_files);
 }
 
+void Model::AddYesNoRequest(const std::string& prompt, const nlohmann::json& media_data) {
+    provider_->AddYesNoRequest(prompt, media_data);
+}
+
 std::vector<nlohmann::json> Model::CollectCompletions(const std::string& contentType) {
     return provider_->CollectCompletions(contentType);
 }
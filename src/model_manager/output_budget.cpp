@@ -0,0 +1,121 @@
+#include "flock/model_manager/output_budget.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <mutex>
+#include <unordered_map>
+
+namespace flock {
+
+namespace {
+
+std::mutex observed_mutex;
+// Largest output tokens per item seen in one response, by model and output type
+std::unordered_map<std::string, int64_t> observed_item_tokens;
+
+std::string ObservedKey(const std::string& model, const OutputType output_type) {
+    return model + "/" + IProvider::GetOutputTypeString(output_type);
+}
+
+OutputType ItemOutputType(const nlohmann::json& item) {
+    if (item.is_boolean()) {
+        return OutputType::BOOL;
+    }
+    if (item.is_number_integer()) {
+        return OutputType::INTEGER;
+    }
+    return item.is_string() ? OutputType::STRING : OutputType::OBJECT;
+}
+
+bool HasItemSchema(const nlohmann::json& model_parameters) {
+    return model_parameters.contains("response_format") || model_parameters.contains("output_format") ||
+           model_parameters.contains("format");
+}
+
+// Type of the items of a custom schema; anything but a plain boolean or integer counts as an object
+OutputType ItemSchemaType(const nlohmann::json& model_parameters) {
+    nlohmann::json schema;
+    if (model_parameters.contains("response_format")) {
+        schema = model_parameters["response_format"].value("json_schema", nlohmann::json::object()).value("schema", nlohmann::json());
+    } else if (model_parameters.contains("output_format")) {
+        schema = model_parameters["output_format"].value("schema", nlohmann::json());
+    } else {
+        schema = model_parameters["format"];
+    }
+    const auto type = schema.is_object() ? schema.value("type", nlohmann::json()) : nlohmann::json();
+    if (type == "integer") {
+        return OutputType::INTEGER;
+    }
+    return type == "boolean" ? OutputType::BOOL : OutputType::OBJECT;
+}
+
+}// namespace
+
+bool OutputBudget::SetsOutputLimit(const nlohmann::json& model_parameters) {
+    for (const auto* key: {"max_completion_tokens", "max_output_tokens", "max_tokens", "thinking"}) {
+        if (model_parameters.contains(key)) {
+            return true;
+        }
+    }
+    return model_parameters.contains("options") && model_parameters["options"].contains("num_predict");
+}
+
+bool OutputBudget::IsReasoningModel(const std::string& model) {
+    const auto name = duckdb::StringUtil::Lower(model);
+    const auto is_o_series = name.size() > 1 && name[0] == 'o' && std::isdigit(static_cast<unsigned char>(name[1]));
+    return is_o_series || name.rfind("gpt-5", 0) == 0 || name.find("deepseek-r1") != std::string::npos ||
+           name.find("qwq") != std::string::npos;
+}
+
+OutputType OutputBudget::RequestItemType(const nlohmann::json& model_parameters, const OutputType output_type) {
+    // Items of a custom schema take its type, whatever the function asks for
+    return HasItemSchema(model_parameters) ? ItemSchemaType(model_parameters) : output_type;
+}
+
+std::optional<int64_t> OutputBudget::ItemTokens(const std::string& model, const OutputType output_type) {
+    switch (output_type) {
+        case OutputType::BOOL:
+            return BOOL_ITEM_TOKENS;
+        case OutputType::INTEGER:
+            return INTEGER_ITEM_TOKENS;
+        default: {
+            std::lock_guard<std::mutex> lock(observed_mutex);
+            const auto it = observed_item_tokens.find(ObservedKey(model, output_type));
+            if (it == observed_item_tokens.end()) {
+                return std::nullopt;
+            }
+            return std::max(2 * it->second, MIN_ITEM_TOKENS);
+        }
+    }
+}
+
+std::optional<int64_t> OutputBudget::MaxTokens(const ModelDetails& model_details, OutputType output_type,
+                                               const int num_items) {
+    if (SetsOutputLimit(model_details.model_parameters) || IsReasoningModel(model_details.model)) {
+        return std::nullopt;
+    }
+    const auto item_tokens = ItemTokens(model_details.model, RequestItemType(model_details.model_parameters, output_type));
+    if (!item_tokens) {
+        return std::nullopt;
+    }
+    return ENVELOPE_TOKENS + std::max(num_items, 1) * *item_tokens;
+}
+
+void OutputBudget::Observe(const std::string& model, const nlohmann::json& result, const int64_t output_tokens) {
+    if (output_tokens <= 0 || !result.is_object() || !result.contains("items") || !result["items"].is_array() ||
+        result["items"].empty()) {
+        return;
+    }
+    const auto& items = result["items"];
+    const auto item_tokens = output_tokens / static_cast<int64_t>(items.size()) + 1;
+    std::lock_guard<std::mutex> lock(observed_mutex);
+    auto& observed = observed_item_tokens[ObservedKey(model, ItemOutputType(items[0]))];
+    observed = std::max(observed, item_tokens);
+}
+
+void OutputBudget::Clear() {
+    std::lock_guard<std::mutex> lock(observed_mutex);
+    observed_item_tokens.clear();
+}
+
+}// namespace flock
@@ -1,5 +1,7 @@
 #include "flock/model_manager/providers/adapters/anthropic.hpp"
+#include "flock/model_manager/output_budget.hpp"
 #include "flock/model_manager/providers/handlers/url_handler.hpp"
+#include "flock/prompt_manager/repository.hpp"
 #include <fmt/format.h>
 
 namespace flock {
@@ -18,7 +20,18 @@ static bool SupportsOutputFormat(const std::string& model) {
 void AnthropicProvider::AddCompletionRequest(const std::string& prompt, const int num_output_tuples, OutputType output_type, const nlohmann::json& media_data) {
 
     auto message_content = nlohmann::json::array();
-    message_content.push_back({{"type", "text"}, {"text", prompt}});
+    // Mark the batch-invariant prefix as a cache breakpoint so later batches of the same query reuse it. Its length
+    // comes from the renderer, since the user prompt and the rows may both contain the table header.
+    size_t tuples_pos = std::string::npos;
+    if (media_data.contains(PROMPT_PREFIX_LENGTH) && media_data[PROMPT_PREFIX_LENGTH].is_number_unsigned()) {
+        tuples_pos = media_data[PROMPT_PREFIX_LENGTH].get<size_t>();
+    }
+    if (tuples_pos != std::string::npos && tuples_pos > 0 && tuples_pos < prompt.size()) {
+        message_content.push_back({{"type", "text"}, {"text", prompt.substr(0, tuples_pos)}, {"cache_control", {{"type", "ephemeral"}}}});
+        message_content.push_back({{"type", "text"}, {"text", prompt.substr(tuples_pos)}});
+    } else {
+        message_content.push_back({{"type", "text"}, {"text", prompt}});
+    }
 
     // Process image columns - supports URLs, file paths, and base64
     if (media_data.contains("image") && !media_data["image"].empty() && media_data["image"].is_array()) {
@@ -67,9 +80,9 @@ void AnthropicProvider::AddCompletionRequest(const std::string& prompt, const in
         request_payload.update(model_details_.model_parameters);
     }
 
-    // Anthropic API requires max_tokens; use fallback when not specified
+    // Anthropic API requires max_tokens; use the output budget, or a fallback, when not specified
     if (!request_payload.contains("max_tokens")) {
-        request_payload["max_tokens"] = 4096;
+        request_payload["max_tokens"] = OutputBudget::MaxTokens(model_details_, output_type, num_output_tuples).value_or(4096);
     }
 
     // Build the schema for structured output
@@ -1,5 +1,6 @@
 #include "flock/model_manager/providers/adapters/azure.hpp"
 #include "flock/model_manager/model.hpp"
+#include "flock/model_manager/output_budget.hpp"
 #include "flock/model_manager/providers/handlers/url_handler.hpp"
 
 namespace flock {
@@ -71,6 +72,10 @@ void AzureProvider::AddCompletionRequest(const std::string& prompt, const int nu
         request_payload.update(model_details_.model_parameters);
     }
 
+    if (const auto max_tokens = OutputBudget::MaxTokens(model_details_, output_type, num_output_tuples)) {
+        request_payload["max_tokens"] = *max_tokens;
+    }
+
     if (model_details_.model_parameters.contains("response_format")) {
         auto schema = model_details_.model_parameters["response_format"]["json_schema"]["schema"];
         auto strict = model_details_.model_parameters["response_format"]["strict"];
@@ -1,10 +1,11 @@
 #include "flock/model_manager/providers/adapters/ollama.hpp"
+#include "flock/model_manager/output_budget.hpp"
 #include "flock/model_manager/providers/handlers/url_handler.hpp"
 #include "flock/model_manager/providers/provider.hpp"
 
 namespace flock {
 
-void OllamaProvider::AddCompletionRequest(const std::string& prompt, const int num_output_tuples, OutputType output_type, const nlohmann::json& media_data) {
+nlohmann::json OllamaProvider::BuildMessage(const std::string& prompt, const nlohmann::json& media_data) {
     // Build message for chat API
     nlohmann::json message = {{"role", "user"}, {"content", prompt}};
 
@@ -37,6 +38,12 @@ void OllamaProvider::AddCompletionRequest(const std::string& prompt, const int n
         message["images"] = images;
     }
 
+    return message;
+}
+
+void OllamaProvider::AddCompletionRequest(const std::string& prompt, const int num_output_tuples, OutputType output_type, const nlohmann::json& media_data) {
+    auto message = BuildMessage(prompt, media_data);
+
     nlohmann::json request_payload = {{"model", model_details_.model},
                                       {"messages", nlohmann::json::array({message})},
                                       {"stream", false}};
@@ -45,6 +52,10 @@ void OllamaProvider::AddCompletionRequest(const std::string& prompt, const int n
         request_payload.update(model_details_.model_parameters);
     }
 
+    if (const auto max_tokens = OutputBudget::MaxTokens(model_details_, output_type, num_output_tuples)) {
+        request_payload["options"]["num_predict"] = *max_tokens;
+    }
+
     if (model_details_.model_parameters.contains("format")) {
         auto schema = model_details_.model_parameters["format"];
         request_payload["format"] = {
@@ -61,6 +72,28 @@ void OllamaProvider::AddCompletionRequest(const std::string& prompt, const int n
     model_handler_->AddRequest(request_payload);
 }
 
+void OllamaProvider::AddYesNoRequest(const std::string& prompt, const nlohmann::json& media_data) {
+    if (OutputBudget::IsReasoningModel(model_details_.model)) {
+        throw std::runtime_error(duckdb_fmt::format("Reasoning model '{}' cannot answer in a single token",
+                                                    model_details_.model));
+    }
+    nlohmann::json request_payload = {{"model", model_details_.model},
+                                      {"messages", nlohmann::json::array({BuildMessage(prompt, media_data)})},
+                                      {"stream", false}};
+
+    if (!model_details_.model_parameters.empty()) {
+        request_payload.update(model_details_.model_parameters);
+    }
+
+    // One token and the likeliest alternatives to it; a response format would only get in the way
+    request_payload.erase("format");
+    request_payload["options"]["num_predict"] = 1;
+    request_payload["logprobs"] = true;
+    request_payload["top_logprobs"] = YES_NO_TOP_LOGPROBS;
+
+    model_handler_->AddRequest(request_payload);
+}
+
 void OllamaProvider::AddEmbeddingRequest(const std::vector<std::string>& inputs) {
     for (const auto& input: inputs) {
         nlohmann::json request_payload = {
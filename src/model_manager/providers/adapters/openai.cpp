@@ -1,11 +1,12 @@
 #include "flock/model_manager/providers/adapters/openai.hpp"
 #include "flock/model_manager/model.hpp"
+#include "flock/model_manager/output_budget.hpp"
 #include "flock/model_manager/providers/handlers/url_handler.hpp"
 #include <fmt/format.h>
 
 namespace flock {
 
-void OpenAIProvider::AddCompletionRequest(const std::string& prompt, const int num_output_tuples, OutputType output_type, const nlohmann::json& media_data) {
+nlohmann::json OpenAIProvider::BuildMessageContent(const std::string& prompt, const nlohmann::json& media_data) {
     auto message_content = nlohmann::json::array();
 
     message_content.push_back({{"type", "text"}, {"text", prompt}});
@@ -64,6 +65,12 @@ void OpenAIProvider::AddCompletionRequest(const std::string& prompt, const int n
         }
     }
 
+    return message_content;
+}
+
+void OpenAIProvider::AddCompletionRequest(const std::string& prompt, const int num_output_tuples, OutputType output_type, const nlohmann::json& media_data) {
+    auto message_content = BuildMessageContent(prompt, media_data);
+
     nlohmann::json request_payload = {{"model", model_details_.model},
                                       {"messages", {{{"role", "user"}, {"content", message_content}}}}};
 
@@ -71,6 +78,10 @@ void OpenAIProvider::AddCompletionRequest(const std::string& prompt, const int n
         request_payload.update(model_details_.model_parameters);
     }
 
+    if (const auto max_tokens = OutputBudget::MaxTokens(model_details_, output_type, num_output_tuples)) {
+        request_payload["max_completion_tokens"] = *max_tokens;
+    }
+
     if (model_details_.model_parameters.contains("response_format")) {
         auto schema = model_details_.model_parameters["response_format"]["json_schema"]["schema"];
         auto strict = model_details_.model_parameters["response_format"]["strict"];
@@ -93,6 +104,28 @@ void OpenAIProvider::AddCompletionRequest(const std::string& prompt, const int n
     model_handler_->AddRequest(request_payload);
 }
 
+void OpenAIProvider::AddYesNoRequest(const std::string& prompt, const nlohmann::json& media_data) {
+    if (OutputBudget::IsReasoningModel(model_details_.model)) {
+        throw std::runtime_error(duckdb_fmt::format("Reasoning model '{}' cannot answer in a single token",
+                                                    model_details_.model));
+    }
+    nlohmann::json request_payload = {{"model", model_details_.model},
+                                      {"messages", {{{"role", "user"}, {"content", BuildMessageContent(prompt, media_data)}}}}};
+
+    if (!model_details_.model_parameters.empty()) {
+        request_payload.update(model_details_.model_parameters);
+    }
+
+    // One token and the likeliest alternatives to it; a response format would only get in the way
+    request_payload.erase("response_format");
+    request_payload.erase("max_tokens");
+    request_payload["max_completion_tokens"] = 1;
+    request_payload["logprobs"] = true;
+    request_payload["top_logprobs"] = YES_NO_TOP_LOGPROBS;
+
+    model_handler_->AddRequest(request_payload);
+}
+
 void OpenAIProvider::AddEmbeddingRequest(const std::vector<std::string>& inputs) {
     nlohmann::json request_payload = {
             {"model", model_details_.model},
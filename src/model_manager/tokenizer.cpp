@@ -0,0 +1,341 @@
+#include "flock/model_manager/tokenizer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <mutex>
+
+namespace flock {
+
+namespace {
+
+constexpr uint32_t NO_RANK = std::numeric_limits<uint32_t>::max();
+
+std::string DecodeBase64(std::string_view input) {
+    static const auto table = [] {
+        std::array<int8_t, 256> t{};
+        t.fill(-1);
+        const std::string alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        for (size_t i = 0; i < alphabet.size(); i++) {
+            t[static_cast<unsigned char>(alphabet[i])] = static_cast<int8_t>(i);
+        }
+        return t;
+    }();
+
+    std::string output;
+    uint32_t buffer = 0;
+    int bits = 0;
+    for (const auto c: input) {
+        const auto value = table[static_cast<unsigned char>(c)];
+        if (value < 0) {
+            continue;// Padding
+        }
+        buffer = (buffer << 6) | static_cast<uint32_t>(value);
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            output.push_back(static_cast<char>((buffer >> bits) & 0xFF));
+        }
+    }
+    return output;
+}
+
+// Code point at pos and its length in bytes; invalid sequences are read as a single byte
+std::pair<uint32_t, size_t> DecodeUtf8(std::string_view text, size_t pos) {
+    const auto lead = static_cast<unsigned char>(text[pos]);
+    size_t length = lead < 0x80 ? 1 : (lead >> 5) == 0x6 ? 2 : (lead >> 4) == 0xE ? 3 : (lead >> 3) == 0x1E ? 4 : 1;
+    if (pos + length > text.size()) {
+        length = 1;
+    }
+    uint32_t code_point = length == 1 ? lead : lead & (0x7F >> length);
+    for (size_t i = 1; i < length; i++) {
+        code_point = (code_point << 6) | (static_cast<unsigned char>(text[pos + i]) & 0x3F);
+    }
+    return {code_point, length};
+}
+
+bool IsNewline(uint32_t c) { return c == '\r' || c == '\n'; }
+
+bool IsSpace(uint32_t c) {
+    return c == ' ' || (c >= '\t' && c <= '\r') || c == 0x85 || c == 0xA0 || (c >= 0x2000 && c <= 0x200A) ||
+           c == 0x2028 || c == 0x2029 || c == 0x3000;
+}
+
+bool IsDigit(uint32_t c) { return c >= '0' && c <= '9'; }
+
+bool IsLetter(uint32_t c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= 0x80 && !IsSpace(c));
+}
+
+}// namespace
+
+std::shared_ptr<const BpeTokenizer> BpeTokenizer::LoadFromFile(const std::filesystem::path& path) {
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("Could not open tokenizer file: " + path.string());
+    }
+
+    std::vector<std::pair<std::string, uint32_t>> ranks;
+    std::string line;
+    while (std::getline(file, line)) {
+        const auto separator = line.find(' ');
+        if (separator == std::string::npos) {
+            continue;
+        }
+        ranks.emplace_back(DecodeBase64(std::string_view(line).substr(0, separator)),
+                           static_cast<uint32_t>(std::stoul(line.substr(separator + 1))));
+    }
+    return FromRanks(ranks);
+}
+
+std::shared_ptr<const BpeTokenizer> BpeTokenizer::FromRanks(const std::vector<std::pair<std::string, uint32_t>>& ranks) {
+    auto tokenizer = std::make_shared<BpeTokenizer>();
+    size_t total_size = 0;
+    for (const auto& [token, rank]: ranks) {
+        total_size += token.size();
+    }
+    // Reserve up front so the views below stay valid
+    tokenizer->token_bytes_.reserve(total_size);
+    tokenizer->ranks_.reserve(ranks.size());
+
+    size_t offset = 0;
+    for (const auto& [token, rank]: ranks) {
+        tokenizer->token_bytes_.append(token);
+        tokenizer->ranks_.emplace(std::string_view(tokenizer->token_bytes_).substr(offset, token.size()), rank);
+        offset += token.size();
+    }
+    return tokenizer;
+}
+
+std::vector<std::string_view> BpeTokenizer::SplitPieces(std::string_view text) {
+    std::vector<std::string_view> pieces;
+    size_t pos = 0;
+
+    auto code_point_at = [&](size_t at) { return at < text.size() ? DecodeUtf8(text, at) : std::pair<uint32_t, size_t>(0, 0); };
+    auto consume_while = [&](size_t at, auto&& predicate) {
+        while (at < text.size()) {
+            auto [c, length] = DecodeUtf8(text, at);
+            if (!predicate(c)) {
+                break;
+            }
+            at += length;
+        }
+        return at;
+    };
+
+    while (pos < text.size()) {
+        auto [c, length] = DecodeUtf8(text, pos);
+        size_t end = pos + length;
+
+        if (c == '\'') {
+            // 's|'t|'re|'ve|'m|'ll|'d
+            auto lower = [&](size_t at) { return at < text.size() ? static_cast<char>(std::tolower(text[at])) : '\0'; };
+            const char first = lower(pos + 1), second = lower(pos + 2);
+            if ((first == 'r' && second == 'e') || (first == 'v' && second == 'e') || (first == 'l' && second == 'l')) {
+                pieces.push_back(text.substr(pos, 3));
+                pos += 3;
+                continue;
+            }
+            if (first == 's' || first == 't' || first == 'm' || first == 'd') {
+                pieces.push_back(text.substr(pos, 2));
+                pos += 2;
+                continue;
+            }
+        }
+
+        if (IsLetter(c)) {
+            // \p{L}+
+            end = consume_while(end, IsLetter);
+        } else if (!IsNewline(c) && !IsDigit(c) && IsLetter(code_point_at(end).first)) {
+            // [^\r\n\p{L}\p{N}]\p{L}+
+            end = consume_while(end, IsLetter);
+        } else if (IsDigit(c)) {
+            // \p{N}{1,3}
+            for (int digits = 1; digits < 3 && end < text.size() && IsDigit(static_cast<unsigned char>(text[end])); digits++) {
+                end++;
+            }
+        } else if ((c == ' ' && end < text.size() && !IsSpace(code_point_at(end).first) &&
+                    !IsLetter(code_point_at(end).first) && !IsDigit(code_point_at(end).first)) ||
+                   (!IsSpace(c) && !IsLetter(c) && !IsDigit(c))) {
+            // ' ?[^\s\p{L}\p{N}]+[\r\n]*'
+            if (c == ' ') {
+                end += code_point_at(end).second;
+            }
+            end = consume_while(end, [](uint32_t p) { return !IsSpace(p) && !IsLetter(p) && !IsDigit(p); });
+            end = consume_while(end, IsNewline);
+        } else {
+            // \s*[\r\n]+ | \s+(?!\S) | \s+
+            const auto run_end = consume_while(pos, IsSpace);
+            size_t last_newline_end = 0;
+            size_t last_start = pos;
+            for (size_t at = pos; at < run_end;) {
+                auto [p, p_length] = DecodeUtf8(text, at);
+                if (IsNewline(p)) {
+                    last_newline_end = at + p_length;
+                }
+                last_start = at;
+                at += p_length;
+            }
+            if (last_newline_end > 0) {
+                end = last_newline_end;
+            } else if (run_end == text.size() || last_start == pos) {
+                end = run_end;
+            } else {
+                // Leave the last space to prefix the following word
+                end = last_start;
+            }
+        }
+
+        pieces.push_back(text.substr(pos, end - pos));
+        pos = end;
+    }
+    return pieces;
+}
+
+template<typename OnToken>
+void BpeTokenizer::MergePiece(std::string_view piece, OnToken&& on_token) const {
+    if (auto it = ranks_.find(piece); it != ranks_.end()) {
+        on_token(it->second);
+        return;
+    }
+
+    auto rank_of = [&](size_t start, size_t end) {
+        auto it = ranks_.find(piece.substr(start, end - start));
+        return it == ranks_.end() ? NO_RANK : it->second;
+    };
+
+    // Boundaries of the current tokens and the rank of merging each token with its successor
+    std::vector<std::pair<size_t, uint32_t>> parts;
+    parts.reserve(piece.size() + 1);
+    for (size_t i = 0; i <= piece.size(); i++) {
+        parts.emplace_back(i, i + 2 <= piece.size() ? rank_of(i, i + 2) : NO_RANK);
+    }
+
+    while (parts.size() > 2) {
+        size_t best = 0;
+        uint32_t best_rank = NO_RANK;
+        for (size_t i = 0; i + 1 < parts.size(); i++) {
+            if (parts[i].second < best_rank) {
+                best_rank = parts[i].second;
+                best = i;
+            }
+        }
+        if (best_rank == NO_RANK) {
+            break;
+        }
+
+        parts[best].second = best + 3 < parts.size() ? rank_of(parts[best].first, parts[best + 3].first) : NO_RANK;
+        if (best > 0) {
+            parts[best - 1].second = rank_of(parts[best - 1].first, parts[best + 2].first);
+        }
+        parts.erase(parts.begin() + static_cast<std::ptrdiff_t>(best + 1));
+    }
+
+    for (size_t i = 0; i + 1 < parts.size(); i++) {
+        on_token(rank_of(parts[i].first, parts[i + 1].first));
+    }
+}
+
+std::vector<uint32_t> BpeTokenizer::Encode(std::string_view text) const {
+    std::vector<uint32_t> tokens;
+    for (const auto& piece: SplitPieces(text)) {
+        MergePiece(piece, [&](uint32_t rank) {
+            if (rank == NO_RANK) {
+                throw std::runtime_error("Tokenizer vocabulary does not cover every byte of the input");
+            }
+            tokens.push_back(rank);
+        });
+    }
+    return tokens;
+}
+
+size_t BpeTokenizer::Count(std::string_view text) const {
+    size_t count = 0;
+    for (const auto& piece: SplitPieces(text)) {
+        MergePiece(piece, [&](uint32_t) { count++; });
+    }
+    return count;
+}
+
+namespace {
+
+std::mutex tokenizer_cache_mutex;
+std::unordered_map<std::string, std::shared_ptr<const BpeTokenizer>> tokenizer_cache;
+
+}// namespace
+
+std::string TokenCounter::EncodingForModel(const std::string& model) {
+    const auto name = duckdb::StringUtil::Lower(model);
+    for (const auto* prefix: {"gpt-4o", "chatgpt-4o", "gpt-4.1", "gpt-4.5", "gpt-5", "o1", "o3", "o4"}) {
+        if (duckdb::StringUtil::StartsWith(name, prefix)) {
+            return O200K_BASE;
+        }
+    }
+    for (const auto* prefix: {"gpt-4", "gpt-3.5", "text-embedding-3", "text-embedding-ada"}) {
+        if (duckdb::StringUtil::StartsWith(name, prefix)) {
+            return CL100K_BASE;
+        }
+    }
+    return "";
+}
+
+std::filesystem::path TokenCounter::TokenizerDirectory() {
+    if (const char* directory = getenv("FLOCK_TOKENIZER_DIR")) {
+        return directory;
+    }
+#ifdef _WIN32
+    const char* homeDir = getenv("USERPROFILE");
+#else
+    const char* homeDir = getenv("HOME");
+#endif
+    if (homeDir == nullptr) {
+        return {};
+    }
+    return std::filesystem::path(homeDir) / ".duckdb" / "flock_storage" / "tokenizers";
+}
+
+std::shared_ptr<const BpeTokenizer> TokenCounter::ForModel(const std::string& model) {
+    if (model.empty()) {
+        return nullptr;
+    }
+    auto encoding = EncodingForModel(model);
+    if (encoding.empty()) {
+        encoding = CL100K_BASE;
+    }
+
+    std::lock_guard<std::mutex> lock(tokenizer_cache_mutex);
+    auto it = tokenizer_cache.find(encoding);
+    if (it != tokenizer_cache.end()) {
+        return it->second;
+    }
+
+    // A missing file is cached too, so the disk is only probed once per encoding
+    std::shared_ptr<const BpeTokenizer> tokenizer;
+    const auto path = TokenizerDirectory() / (encoding + ".tiktoken");
+    std::error_code ec;
+    if (std::filesystem::exists(path, ec)) {
+        tokenizer = BpeTokenizer::LoadFromFile(path);
+    }
+    tokenizer_cache[encoding] = tokenizer;
+    return tokenizer;
+}
+
+int64_t TokenCounter::Count(const std::string& model, std::string_view text) {
+    if (const auto tokenizer = ForModel(model)) {
+        return static_cast<int64_t>(tokenizer->Count(text));
+    }
+    return Approximate(text);
+}
+
+int64_t TokenCounter::Approximate(std::string_view text) {
+    return static_cast<int64_t>((text.size() + 3) / 4);
+}
+
+void TokenCounter::ClearCache() {
+    std::lock_guard<std::mutex> lock(tokenizer_cache_mutex);
+    tokenizer_cache.clear();
+}
+
+}// namespace flock
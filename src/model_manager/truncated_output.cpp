@@ -0,0 +1,62 @@
+#include "flock/model_manager/truncated_output.hpp"
+
+namespace flock {
+
+nlohmann::json ParseTruncatedItems(std::string_view text) {
+    auto items = nlohmann::json::array();
+
+    const auto key = text.find("\"items\"");
+    if (key == std::string_view::npos) {
+        return items;
+    }
+    const auto colon = text.find_first_not_of(" \t\r\n", key + 7);
+    if (colon == std::string_view::npos || text[colon] != ':') {
+        return items;
+    }
+    const auto open = text.find_first_not_of(" \t\r\n", colon + 1);
+    if (open == std::string_view::npos || text[open] != '[') {
+        return items;
+    }
+
+    // Scan the array, cutting an item at every comma or closing bracket that is not nested or inside a string
+    auto item_start = open + 1;
+    int depth = 0;
+    bool in_string = false;
+    bool escaped = false;
+    for (auto i = item_start; i < text.size(); i++) {
+        const auto c = text[i];
+        if (in_string) {
+            if (escaped) {
+                escaped = false;
+            } else if (c == '\\') {
+                escaped = true;
+            } else if (c == '"') {
+                in_string = false;
+            }
+            continue;
+        }
+        if (c == '"') {
+            in_string = true;
+        } else if (c == '[' || c == '{') {
+            depth++;
+        } else if ((c == ']' || c == '}') && depth > 0) {
+            depth--;
+        } else if ((c == ',' || c == ']') && depth == 0) {
+            const auto item = text.substr(item_start, i - item_start);
+            if (item.find_first_not_of(" \t\r\n") != std::string_view::npos) {
+                auto parsed = nlohmann::json::parse(item.begin(), item.end(), nullptr, false);
+                if (parsed.is_discarded()) {
+                    break;
+                }
+                items.push_back(std::move(parsed));
+            }
+            if (c == ']') {
+                break;
+            }
+            item_start = i + 1;
+        }
+    }
+    return items;
+}
+
+}// namespace flock
@@ -1,4 +1,12 @@
 #include "flock/prompt_manager/prompt_manager.hpp"
+#include "flock/model_manager/providers/handlers/url_handler.hpp"
+
+#include <deque>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <set>
+#include <unordered_map>
 
 namespace flock {
 template<>
@@ -242,24 +250,165 @@ PromptDetails PromptManager::CreatePromptDetails(const nlohmann::json& prompt_de
     return prompt_details;
 }
 
-nlohmann::json PromptManager::TranscribeAudioColumn(const nlohmann::json& audio_column) {
-    auto transcription_model_name = audio_column["transcription_model"].get<std::string>();
+namespace {
+
+// Bounded process-wide cache of transcripts keyed by transcription model and audio file identity
+class TranscriptCache {
+public:
+    static constexpr size_t MAX_ENTRIES = 16384;
+
+    static TranscriptCache& Instance() {
+        static TranscriptCache instance;
+        return instance;
+    }
+
+    bool Get(const std::string& key, nlohmann::json& transcript) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(key);
+        if (it == entries_.end()) {
+            return false;
+        }
+        transcript = it->second;
+        return true;
+    }
+
+    void Put(const std::string& key, const nlohmann::json& transcript) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (entries_.find(key) == entries_.end()) {
+            insertion_order_.push_back(key);
+        }
+        entries_[key] = transcript;
+        while (entries_.size() > MAX_ENTRIES && !insertion_order_.empty()) {
+            entries_.erase(insertion_order_.front());
+            insertion_order_.pop_front();
+        }
+    }
+
+    void Clear() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries_.clear();
+        insertion_order_.clear();
+    }
 
-    // Look up the transcription model
-    nlohmann::json transcription_model_json;
-    transcription_model_json["model_name"] = transcription_model_name;
-    Model transcription_model(transcription_model_json);
+private:
+    std::mutex mutex_;
+    std::unordered_map<std::string, nlohmann::json> entries_;
+    std::deque<std::string> insertion_order_;
+};
 
-    // Add transcription requests to batch
-    transcription_model.AddTranscriptionRequest(audio_column["data"]);
+std::string AudioFileToString(const nlohmann::json& audio_file) {
+    return audio_file.is_string() ? audio_file.get<std::string>() : audio_file.dump();
+}
 
-    // Collect transcriptions
-    auto transcription_results = transcription_model.CollectTranscriptions();
+// Local files are identified by their absolute path, size and mtime, so building a key never reads the file
+// and an edited file is transcribed again; remote files are identified by their URL
+std::string AudioFileIdentity(const std::string& audio_file) {
+    if (URLHandler::IsUrl(audio_file)) {
+        return audio_file;
+    }
+    auto validator = MediaCache::GetFileValidator(audio_file);
+    if (validator.empty()) {
+        return audio_file;
+    }
+    std::error_code ec;
+    auto path = std::filesystem::absolute(audio_file, ec);
+    return (ec ? audio_file : path.lexically_normal().string()) + "@" + validator;
+}
+
+std::string TranscriptCacheKey(const std::string& model_name, const std::string& audio_file) {
+    return model_name + "\n" + AudioFileIdentity(audio_file);
+}
 
-    // Convert vector<nlohmann::json> to nlohmann::json array
+// Transcribe every audio file of the given columns that is not cached yet. Files are deduplicated and all
+// requests for the same transcription model are submitted together, so the handler runs them concurrently
+// (bounded by its connection limit). Returns the cache keys per column and row ("" for NULL entries).
+std::vector<std::vector<std::string>> TranscribeMissing(const std::vector<const nlohmann::json*>& audio_columns) {
+    auto& cache = TranscriptCache::Instance();
+    std::vector<std::vector<std::string>> keys(audio_columns.size());
+
+    struct PendingFiles {
+        nlohmann::json files = nlohmann::json::array();
+        std::vector<std::string> keys;
+        std::set<std::string> seen;
+    };
+    std::map<std::string, PendingFiles> pending_by_model;
+
+    for (size_t c = 0; c < audio_columns.size(); c++) {
+        const auto& column = *audio_columns[c];
+        auto model_name = column["transcription_model"].get<std::string>();
+        for (const auto& audio_file: column["data"]) {
+            if (audio_file.is_null()) {
+                keys[c].emplace_back();
+                continue;
+            }
+            auto file = AudioFileToString(audio_file);
+            auto key = TranscriptCacheKey(model_name, file);
+            keys[c].push_back(key);
+
+            nlohmann::json cached;
+            auto& pending = pending_by_model[model_name];
+            if (!cache.Get(key, cached) && pending.seen.insert(key).second) {
+                pending.files.push_back(file);
+                pending.keys.push_back(key);
+            }
+        }
+    }
+
+    for (auto& [model_name, pending]: pending_by_model) {
+        if (pending.files.empty()) {
+            continue;
+        }
+        nlohmann::json transcription_model_json;
+        transcription_model_json["model_name"] = model_name;
+        Model transcription_model(transcription_model_json);
+
+        transcription_model.AddTranscriptionRequest(pending.files);
+        auto transcription_results = transcription_model.CollectTranscriptions();
+
+        for (size_t i = 0; i < transcription_results.size() && i < pending.keys.size(); i++) {
+            cache.Put(pending.keys[i], transcription_results[i]);
+        }
+    }
+
+    return keys;
+}
+
+bool IsTranscribableAudioColumn(const nlohmann::json& column) {
+    return column.contains("type") && column["type"].is_string() && column["type"].get<std::string>() == "audio" &&
+           column.contains("transcription_model") && column.contains("data") && column["data"].is_array();
+}
+
+}// namespace
+
+void PromptManager::PrefetchTranscriptions(const nlohmann::json& columns) {
+    std::vector<const nlohmann::json*> audio_columns;
+    for (const auto& column: columns) {
+        if (IsTranscribableAudioColumn(column)) {
+            audio_columns.push_back(&column);
+        }
+    }
+    if (!audio_columns.empty()) {
+        TranscribeMissing(audio_columns);
+    }
+}
+
+void PromptManager::ClearTranscriptionCache() {
+    TranscriptCache::Instance().Clear();
+}
+
+nlohmann::json PromptManager::TranscribeAudioColumn(const nlohmann::json& audio_column) {
+    auto keys = TranscribeMissing({&audio_column})[0];
+
+    // Convert cached transcripts back into a row-aligned array
+    auto& cache = TranscriptCache::Instance();
     nlohmann::json transcriptions = nlohmann::json::array();
-    for (const auto& result: transcription_results) {
-        transcriptions.push_back(result);
+    for (const auto& key: keys) {
+        nlohmann::json transcript;
+        if (key.empty() || !cache.Get(key, transcript)) {
+            transcriptions.push_back(nullptr);
+        } else {
+            transcriptions.push_back(transcript);
+        }
     }
 
     // Create transcription column with proper naming
@@ -21,6 +21,10 @@ std::string RESPONSE_FORMAT::Get(const ScalarFunctionType option) {
             return RESPONSE_FORMAT::COMPLETE;
         case ScalarFunctionType::FILTER:
             return RESPONSE_FORMAT::FILTER;
+        case ScalarFunctionType::YES_NO:
+            return RESPONSE_FORMAT::YES_NO;
+        case ScalarFunctionType::CLASSIFY:
+            return RESPONSE_FORMAT::CLASSIFY;
         default:
             return "";
     }
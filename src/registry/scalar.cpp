@@ -6,6 +6,8 @@ void ScalarRegistry::Register(duckdb::ExtensionLoader& loader) {
     RegisterLlmComplete(loader);
     RegisterLlmEmbedding(loader);
     RegisterLlmFilter(loader);
+    RegisterLlmClassify(loader);
+    RegisterLlmTokenCount(loader);
     RegisterFusionRRF(loader);
     RegisterFusionCombANZ(loader);
     RegisterFusionCombMED(loader);
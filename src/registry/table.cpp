@@ -0,0 +1,9 @@
+#include "flock/registry/table.hpp"
+
+namespace flock {
+
+void TableRegistry::Register(duckdb::ExtensionLoader& loader) {
+    RegisterLlmPipelined(loader);
+}
+
+}// namespace flock
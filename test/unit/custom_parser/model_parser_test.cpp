@@ -260,6 +260,17 @@ TEST(ModelParserTest, ParseCreateModelWithInvalidArgs) {
     EXPECT_THROW(parser.Parse("CREATE MODEL ('test_model', 'model_data', 'provider', {\"invalid_key\": \"value\"})", statement), std::runtime_error);
 }
 
+TEST(ModelParserTest, ParseCreateModelWithExecutionMode) {
+    std::unique_ptr<QueryStatement> statement;
+    ModelParser parser;
+    EXPECT_NO_THROW(parser.Parse("CREATE MODEL ('test_model', 'model_data', 'provider', {\"execution_mode\": \"Latency\"})", statement));
+    const auto create_stmt = dynamic_cast<CreateModelStatement*>(statement.get());
+    ASSERT_NE(create_stmt, nullptr);
+    EXPECT_EQ(create_stmt->model_args["execution_mode"], "latency");
+
+    EXPECT_THROW(parser.Parse("CREATE MODEL ('test_model', 'model_data', 'provider', {\"execution_mode\": \"eager\"})", statement), std::runtime_error);
+}
+
 TEST(ModelParserTest, ParseCreateModelWithInvalidArgsWithComment) {
     std::unique_ptr<QueryStatement> statement;
     ModelParser parser;
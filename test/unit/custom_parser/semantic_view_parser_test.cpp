@@ -0,0 +1,271 @@
+#include "../functions/mock_provider.hpp"
+#include "flock/core/config.hpp"
+#include "flock/custom_parser/query/semantic_view_parser.hpp"
+#include "flock/custom_parser/tokenizer.hpp"
+#include "flock/model_manager/model.hpp"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include <memory>
+
+using namespace flock;
+
+/**************************************************
+ *              Create Semantic View              *
+ **************************************************/
+
+TEST(SemanticViewParserTest, ParseCreateSemanticView) {
+    std::unique_ptr<QueryStatement> statement;
+    SemanticViewParser parser;
+    EXPECT_NO_THROW(parser.Parse("CREATE SEMANTIC VIEW ('review_sentiment', 'reviews', 'id', "
+                                 "{\"model\": {\"model_name\": \"gpt-4o\"}, "
+                                 "\"prompt\": {\"prompt\": \"Classify the sentiment\"}, "
+                                 "\"context_columns\": [\"review\"]});",
+                                 statement));
+    ASSERT_NE(statement, nullptr);
+    auto create_stmt = dynamic_cast<CreateSemanticViewStatement*>(statement.get());
+    ASSERT_NE(create_stmt, nullptr);
+    EXPECT_EQ(create_stmt->view_name, "review_sentiment");
+    EXPECT_EQ(create_stmt->source_table, "reviews");
+    EXPECT_EQ(create_stmt->key_column, "id");
+    EXPECT_EQ(create_stmt->definition["model"]["model_name"], "gpt-4o");
+    EXPECT_EQ(create_stmt->definition["output_column"], SemanticViewParser::DEFAULT_OUTPUT_COLUMN);
+}
+
+TEST(SemanticViewParserTest, ParseCreateSemanticViewWithOutputColumn) {
+    std::unique_ptr<QueryStatement> statement;
+    SemanticViewParser parser;
+    EXPECT_NO_THROW(parser.Parse("CREATE SEMANTIC VIEW ('product_tags', 'products', 'sku', "
+                                 "{\"model\": {\"model_name\": \"gpt-4o\"}, "
+                                 "\"prompt\": {\"prompt_name\": \"tagging\"}, "
+                                 "\"context_columns\": [\"title\", {\"name\": \"photo\", \"type\": \"image\"}], "
+                                 "\"output_column\": \"tags\"})",
+                                 statement));
+    auto create_stmt = dynamic_cast<CreateSemanticViewStatement*>(statement.get());
+    ASSERT_NE(create_stmt, nullptr);
+    EXPECT_EQ(create_stmt->definition["context_columns"].size(), 2);
+    EXPECT_EQ(create_stmt->definition["output_column"], "tags");
+}
+
+TEST(SemanticViewParserTest, ParseCreateSemanticViewInvalidDefinition) {
+    std::unique_ptr<QueryStatement> statement;
+    SemanticViewParser parser;
+    // Missing context columns
+    EXPECT_THROW(parser.Parse("CREATE SEMANTIC VIEW ('v', 'reviews', 'id', "
+                              "{\"model\": {\"model_name\": \"gpt-4o\"}, \"prompt\": {\"prompt\": \"p\"}})",
+                              statement),
+                 std::runtime_error);
+    // Unknown parameter
+    EXPECT_THROW(parser.Parse("CREATE SEMANTIC VIEW ('v', 'reviews', 'id', "
+                              "{\"model\": {\"model_name\": \"gpt-4o\"}, \"prompt\": {\"prompt\": \"p\"}, "
+                              "\"context_columns\": [\"review\"], \"schedule\": \"daily\"})",
+                              statement),
+                 std::runtime_error);
+    // Missing key column
+    EXPECT_THROW(parser.Parse("CREATE SEMANTIC VIEW ('v', 'reviews', "
+                              "{\"model\": {\"model_name\": \"gpt-4o\"}, \"prompt\": {\"prompt\": \"p\"}, "
+                              "\"context_columns\": [\"review\"]})",
+                              statement),
+                 std::runtime_error);
+}
+
+/**************************************************
+ *        Refresh / Delete / Get Semantic View    *
+ **************************************************/
+
+TEST(SemanticViewParserTest, ParseRefreshSemanticView) {
+    std::unique_ptr<QueryStatement> statement;
+    SemanticViewParser parser;
+    EXPECT_NO_THROW(parser.Parse("REFRESH SEMANTIC VIEW 'review_sentiment';", statement));
+    auto refresh_stmt = dynamic_cast<RefreshSemanticViewStatement*>(statement.get());
+    ASSERT_NE(refresh_stmt, nullptr);
+    EXPECT_EQ(refresh_stmt->view_name, "review_sentiment");
+}
+
+TEST(SemanticViewParserTest, ParseDeleteSemanticView) {
+    std::unique_ptr<QueryStatement> statement;
+    SemanticViewParser parser;
+    EXPECT_NO_THROW(parser.Parse("DELETE SEMANTIC VIEW 'review_sentiment'", statement));
+    auto delete_stmt = dynamic_cast<DeleteSemanticViewStatement*>(statement.get());
+    ASSERT_NE(delete_stmt, nullptr);
+    EXPECT_EQ(delete_stmt->view_name, "review_sentiment");
+}
+
+TEST(SemanticViewParserTest, ParseGetSemanticViews) {
+    std::unique_ptr<QueryStatement> statement;
+    SemanticViewParser parser;
+    EXPECT_NO_THROW(parser.Parse("GET SEMANTIC VIEW 'review_sentiment'", statement));
+    auto get_stmt = dynamic_cast<GetSemanticViewStatement*>(statement.get());
+    ASSERT_NE(get_stmt, nullptr);
+    EXPECT_EQ(get_stmt->view_name, "review_sentiment");
+
+    EXPECT_NO_THROW(parser.Parse("GET SEMANTIC VIEWS;", statement));
+    EXPECT_NE(dynamic_cast<GetAllSemanticViewStatement*>(statement.get()), nullptr);
+
+    EXPECT_THROW(parser.Parse("GET SEMANTIC VIEW;", statement), std::runtime_error);
+    EXPECT_THROW(parser.Parse("REFRESH SEMANTIC 'review_sentiment'", statement), std::runtime_error);
+}
+
+TEST(SemanticViewParserTest, JsonToStructLiteral) {
+    auto model = nlohmann::json::parse(R"({"model_name": "gpt-4o", "batch_size": 8, "tuple_format": "it's"})");
+    EXPECT_EQ(SemanticViewParser::JsonToStructLiteral(model),
+              "{'batch_size': 8, 'model_name': 'gpt-4o', 'tuple_format': 'it''s'}");
+}
+
+/**************************************************
+ *            Semantic View Refresh               *
+ **************************************************/
+
+class SemanticViewRefreshTest : public ::testing::Test {
+protected:
+    static constexpr const char* CREATE_VIEW =
+            "CREATE SEMANTIC VIEW ('sv_refresh_test', 'sv_reviews', 'id', "
+            "{\"model\": {\"model_name\": \"gpt-4o\"}, "
+            "\"prompt\": {\"prompt\": \"Classify the sentiment\"}, "
+            "\"context_columns\": [\"review\"]});";
+
+    void SetUp() override {
+        auto con = Config::GetConnection();
+        con.Query(" CREATE SECRET ("
+                  "       TYPE OPENAI,"
+                  "    API_KEY 'your-api-key');");
+        con.Query(" CREATE OR REPLACE TABLE sv_reviews AS "
+                  " SELECT * FROM (VALUES (1, 'great'), (2, 'fine'), (3, 'awful')) AS t(id, review); ");
+
+        mock_provider = std::make_shared<MockProvider>(ModelDetails{});
+        Model::SetMockProvider(mock_provider);
+    }
+
+    void TearDown() override {
+        Run("DELETE SEMANTIC VIEW 'sv_refresh_test';");
+        Config::GetConnection().Query("DROP TABLE IF EXISTS sv_reviews;");
+        Model::ResetMockProvider();
+        mock_provider = nullptr;
+    }
+
+    // Parse and run a semantic view statement, returning the result of its status query
+    static duckdb::unique_ptr<duckdb::MaterializedQueryResult> Run(const std::string& sql) {
+        std::unique_ptr<QueryStatement> statement;
+        SemanticViewParser parser;
+        parser.Parse(sql, statement);
+        auto result = Config::GetConnection().Query(parser.ToSQL(*statement));
+        EXPECT_FALSE(result->HasError()) << result->GetError();
+        return result;
+    }
+
+    static int64_t MaterializedRows() {
+        auto result = Config::GetConnection().Query(
+                "SELECT COUNT(*) FROM flock_config." + Config::get_semantic_view_results_table_name() +
+                " WHERE view_name = 'sv_refresh_test';");
+        return result->GetValue(0, 0).GetValue<int64_t>();
+    }
+
+    void ExpectCompletion(int rows, const nlohmann::json& items) {
+        EXPECT_CALL(*mock_provider, AddCompletionRequest(::testing::_, rows, ::testing::_, ::testing::_))
+                .Times(1);
+        EXPECT_CALL(*mock_provider, CollectCompletions(::testing::_))
+                .WillOnce(::testing::Return(std::vector<nlohmann::json>{{{"items", items}}}))
+                .RetiresOnSaturation();
+    }
+
+    std::shared_ptr<MockProvider> mock_provider;
+};
+
+TEST_F(SemanticViewRefreshTest, RefreshRecomputesOnlyChangedRows) {
+    ::testing::InSequence sequence;
+    ExpectCompletion(3, {"positive", "neutral", "negative"});
+    ExpectCompletion(1, {"negative"});
+
+    auto created = Run(CREATE_VIEW);
+    EXPECT_EQ(created->GetValue(1, 0).GetValue<int64_t>(), 3);
+
+    Config::GetConnection().Query("UPDATE sv_reviews SET review = 'terrible' WHERE id = 2;");
+    auto refreshed = Run("REFRESH SEMANTIC VIEW 'sv_refresh_test';");
+    EXPECT_EQ(refreshed->GetValue(1, 0).GetValue<int64_t>(), 1);
+    EXPECT_EQ(refreshed->GetValue(2, 0).GetValue<int64_t>(), 0);
+
+    auto rows = Config::GetConnection().Query("SELECT llm_result FROM sv_refresh_test ORDER BY id;");
+    ASSERT_EQ(rows->RowCount(), 3);
+    EXPECT_EQ(rows->GetValue(0, 0).ToString(), "positive");
+    EXPECT_EQ(rows->GetValue(0, 1).ToString(), "negative");
+    EXPECT_EQ(rows->GetValue(0, 2).ToString(), "negative");
+}
+
+TEST_F(SemanticViewRefreshTest, RefreshRemovesDeletedKeys) {
+    ExpectCompletion(3, {"positive", "neutral", "negative"});
+    Run(CREATE_VIEW);
+
+    // Nothing changed for the remaining rows, so the model is not called again
+    Config::GetConnection().Query("DELETE FROM sv_reviews WHERE id = 3;");
+    auto refreshed = Run("REFRESH SEMANTIC VIEW 'sv_refresh_test';");
+    EXPECT_EQ(refreshed->GetValue(1, 0).GetValue<int64_t>(), 0);
+    EXPECT_EQ(refreshed->GetValue(2, 0).GetValue<int64_t>(), 1);
+    EXPECT_EQ(MaterializedRows(), 2);
+}
+
+TEST_F(SemanticViewRefreshTest, CreateWithDuplicateKeysLeavesNothingBehind) {
+    Config::GetConnection().Query("INSERT INTO sv_reviews VALUES (2, 'again');");
+
+    std::unique_ptr<QueryStatement> statement;
+    SemanticViewParser parser;
+    parser.Parse(CREATE_VIEW, statement);
+    try {
+        parser.ToSQL(*statement);
+        FAIL() << "Expected duplicate keys to be rejected";
+    } catch (const std::runtime_error& e) {
+        EXPECT_NE(std::string(e.what()).find("unique values in key column 'id'"), std::string::npos) << e.what();
+    }
+
+    auto views = Config::GetConnection().Query(
+            "SELECT COUNT(*) FROM flock_config." + Config::get_semantic_views_table_name() +
+            " WHERE view_name = 'sv_refresh_test';");
+    EXPECT_EQ(views->GetValue(0, 0).GetValue<int64_t>(), 0);
+    EXPECT_TRUE(Config::GetConnection().Query("SELECT * FROM sv_refresh_test;")->HasError());
+
+    // Once the keys are fixed the same statement succeeds instead of reporting that the view already exists
+    Config::GetConnection().Query("DELETE FROM sv_reviews WHERE review = 'again';");
+    ExpectCompletion(3, {"positive", "neutral", "negative"});
+    Run(CREATE_VIEW);
+    EXPECT_EQ(MaterializedRows(), 3);
+}
+
+TEST_F(SemanticViewRefreshTest, FailedFirstRefreshCanBeResumed) {
+    EXPECT_CALL(*mock_provider, AddCompletionRequest(::testing::_, 3, ::testing::_, ::testing::_)).Times(1);
+    EXPECT_CALL(*mock_provider, CollectCompletions(::testing::_))
+            .WillOnce(::testing::Throw(std::runtime_error("Rate limit exceeded")))
+            .RetiresOnSaturation();
+
+    std::unique_ptr<QueryStatement> statement;
+    SemanticViewParser parser;
+    parser.Parse(CREATE_VIEW, statement);
+    try {
+        parser.ToSQL(*statement);
+        FAIL() << "Expected the first refresh to fail";
+    } catch (const std::runtime_error& e) {
+        EXPECT_NE(std::string(e.what()).find("REFRESH SEMANTIC VIEW 'sv_refresh_test'"), std::string::npos) << e.what();
+    }
+
+    // The definition and the view are kept, so the refresh picks up the rows that are still missing
+    EXPECT_EQ(MaterializedRows(), 0);
+    ExpectCompletion(3, {"positive", "neutral", "negative"});
+    auto refreshed = Run("REFRESH SEMANTIC VIEW 'sv_refresh_test';");
+    EXPECT_EQ(refreshed->GetValue(1, 0).GetValue<int64_t>(), 3);
+    EXPECT_EQ(MaterializedRows(), 3);
+}
+
+TEST_F(SemanticViewRefreshTest, CreateDoesNotReplaceAnExistingView) {
+    auto con = Config::GetConnection();
+    con.Query("CREATE OR REPLACE VIEW sv_refresh_test AS SELECT 42 AS answer;");
+
+    std::unique_ptr<QueryStatement> statement;
+    SemanticViewParser parser;
+    parser.Parse(CREATE_VIEW, statement);
+    EXPECT_THROW(parser.ToSQL(*statement), std::runtime_error);
+
+    auto answer = con.Query("SELECT answer FROM sv_refresh_test;");
+    ASSERT_FALSE(answer->HasError()) << answer->GetError();
+    EXPECT_EQ(answer->GetValue(0, 0).GetValue<int32_t>(), 42);
+    auto views = con.Query("SELECT COUNT(*) FROM flock_config." + Config::get_semantic_views_table_name() +
+                           " WHERE view_name = 'sv_refresh_test';");
+    EXPECT_EQ(views->GetValue(0, 0).GetValue<int64_t>(), 0);
+    con.Query("DROP VIEW sv_refresh_test;");
+}
@@ -41,6 +41,7 @@ protected:
             // instance calls this factory, so we can track expectations
             return mock_provider;
         });
+        PromptManager::ClearTranscriptionCache();
     }
 
     void TearDown() override {
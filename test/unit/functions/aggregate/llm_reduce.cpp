@@ -225,4 +225,156 @@ TEST_F(LLMReduceTest, AudioTranscriptionOllamaError) {
     ASSERT_TRUE(results->HasError());
 }
 
+// Test incremental mode helpers: reserved columns are split off and only rows above the watermark are kept
+TEST_F(LLMReduceTest, IncrementalSelectsRowsAboveWatermark) {
+    const auto tuples = nlohmann::json::parse(R"([
+        {"name": "message", "data": ["a", "b", "c", "d"]},
+        {"name": "flock_watermark", "data": ["8", "9", "10", "NULL"]},
+        {"name": "flock_state_key", "data": ["service-a", "service-a", "service-a", "service-a"]}
+    ])");
+
+    auto incremental = LlmReduce::SplitIncrementalColumns(tuples);
+    ASSERT_TRUE(incremental.has_value());
+    EXPECT_EQ(incremental->state_key, "service-a");
+    ASSERT_EQ(incremental->tuples.size(), 1);
+
+    // No row at watermark 9 was folded in yet, so "b" is kept along with the rows above it
+    LlmReduce::Watermark max_watermark;
+    auto new_tuples = LlmReduce::SelectNewRows(*incremental, {"9", {}}, max_watermark);
+    EXPECT_EQ(new_tuples[0]["data"], nlohmann::json::parse(R"(["b", "c"])"));
+    EXPECT_EQ(max_watermark.value, "10");
+    EXPECT_EQ(max_watermark.boundary_rows.size(), 1);
+
+    EXPECT_FALSE(LlmReduce::SplitIncrementalColumns(nlohmann::json::parse(R"([{"data": ["a"]}])")).has_value());
+    EXPECT_LT(LlmReduce::CompareWatermarks("2024-01-02 00:00:00", "2024-01-10 00:00:00"), 0);
+}
+
+// Test that rows arriving late at the stored watermark are folded in once, and earlier rows are not repeated
+TEST_F(LLMReduceTest, IncrementalKeepsLateRowsAtWatermark) {
+    auto first = LlmReduce::SplitIncrementalColumns(nlohmann::json::parse(R"([
+        {"name": "message", "data": ["a", "b"]},
+        {"name": "flock_watermark", "data": ["1", "2"]},
+        {"name": "flock_state_key", "data": ["k", "k"]}
+    ])"));
+    LlmReduce::Watermark stored;
+    LlmReduce::SelectNewRows(*first, {}, stored);
+    EXPECT_EQ(stored.value, "2");
+
+    auto second = LlmReduce::SplitIncrementalColumns(nlohmann::json::parse(R"([
+        {"name": "message", "data": ["a", "b", "late"]},
+        {"name": "flock_watermark", "data": ["1", "2", "2"]},
+        {"name": "flock_state_key", "data": ["k", "k", "k"]}
+    ])"));
+    LlmReduce::Watermark max_watermark;
+    auto new_tuples = LlmReduce::SelectNewRows(*second, stored, max_watermark);
+    EXPECT_EQ(new_tuples[0]["data"], nlohmann::json::parse(R"(["late"])"));
+    EXPECT_EQ(max_watermark.value, "2");
+    EXPECT_EQ(max_watermark.boundary_rows.size(), 2);
+
+    EXPECT_TRUE(LlmReduce::SelectNewRows(*second, max_watermark, stored)[0]["data"].empty());
+}
+
+// Test that the state key is required and must be the same for every row of a group
+TEST_F(LLMReduceTest, IncrementalRequiresOneStateKeyPerGroup) {
+    EXPECT_THROW(LlmReduce::SplitIncrementalColumns(nlohmann::json::parse(R"([
+        {"name": "message", "data": ["a"]},
+        {"name": "flock_watermark", "data": ["1"]}
+    ])")),
+                 std::runtime_error);
+    EXPECT_THROW(LlmReduce::SplitIncrementalColumns(nlohmann::json::parse(R"([
+        {"name": "message", "data": ["a", "b"]},
+        {"name": "flock_watermark", "data": ["1", "2"]},
+        {"name": "flock_state_key", "data": ["service-a", "service-b"]}
+    ])")),
+                 std::runtime_error);
+    EXPECT_THROW(LlmReduce::SplitIncrementalColumns(nlohmann::json::parse(R"([
+        {"name": "message", "data": ["a"]},
+        {"name": "flock_watermark", "data": ["1"]},
+        {"name": "flock_state_key", "data": [null]}
+    ])")),
+                 std::runtime_error);
+}
+
+// Test that state keys are claimed across every copy of the bind data and released by the next query
+TEST_F(LLMReduceTest, IncrementalStateKeysAreClaimedPerQuery) {
+    LlmFunctionBindData bind_data;
+    auto copy = bind_data.Copy();
+    auto& copied = copy->Cast<LlmFunctionBindData>();
+
+    // Groups finalized through different copies of the bind data still see each other's keys
+    EXPECT_TRUE(bind_data.reduce_state_claims->Claim(1, "service-a"));
+    EXPECT_FALSE(copied.reduce_state_claims->Claim(1, "service-a"));
+    EXPECT_TRUE(copied.reduce_state_claims->Claim(1, "service-b"));
+
+    // A later execution of the same plan starts over
+    EXPECT_TRUE(copied.reduce_state_claims->Claim(2, "service-a"));
+}
+
+// Test that two groups sharing a state key fail the query instead of overwriting each other's summary
+TEST_F(LLMReduceTest, IncrementalRejectsStateKeySharedByGroups) {
+    auto con = Config::GetConnection();
+    const std::string state_key = "llm_reduce_shared_key_unit_test";
+    auto clear_state = [&con, &state_key]() {
+        Config::StorageAttachmentGuard guard(con, false);
+        con.Query("DELETE FROM flock_storage.flock_config." + Config::get_reduce_state_table_name() +
+                  " WHERE state_key = '" + state_key + "';");
+    };
+    clear_state();
+
+    EXPECT_CALL(*mock_provider, AddCompletionRequest(::testing::_, ::testing::_, ::testing::_, ::testing::_))
+            .Times(::testing::AnyNumber());
+    EXPECT_CALL(*mock_provider, CollectCompletions(::testing::_))
+            .WillRepeatedly(::testing::Return(std::vector<nlohmann::json>{GetExpectedJsonResponse()}));
+
+    auto results = con.Query(
+            "SELECT service, llm_reduce("
+            "{'model_name': 'gpt-4o'}, "
+            "{'prompt': 'Summarize the log messages', 'context_columns': ["
+            "{'data': message}, "
+            "{'data': id, 'name': 'flock_watermark'}, "
+            "{'data': '" + state_key + "', 'name': 'flock_state_key'}]}"
+            ") AS summary FROM VALUES (1, 'a', 'service started'), (2, 'b', 'request served') "
+            "AS logs(id, service, message) GROUP BY service;");
+    ASSERT_TRUE(results->HasError());
+    EXPECT_NE(results->GetError().find("in more than one group"), std::string::npos) << results->GetError();
+
+    clear_state();
+}
+
+// Test incremental mode end to end: a second run without new rows reuses the stored summary
+TEST_F(LLMReduceTest, IncrementalReusesStoredSummary) {
+    auto con = Config::GetConnection();
+    const std::string state_key = "llm_reduce_incremental_unit_test";
+    auto clear_state = [&con, &state_key]() {
+        Config::StorageAttachmentGuard guard(con, false);
+        con.Query("DELETE FROM flock_storage.flock_config." + Config::get_reduce_state_table_name() +
+                  " WHERE state_key = '" + state_key + "';");
+    };
+    clear_state();
+
+    EXPECT_CALL(*mock_provider, AddCompletionRequest(::testing::_, ::testing::_, ::testing::_, ::testing::_))
+            .Times(1);
+    EXPECT_CALL(*mock_provider, CollectCompletions(::testing::_))
+            .WillOnce(::testing::Return(std::vector<nlohmann::json>{GetExpectedJsonResponse()}));
+
+    const auto query =
+            "SELECT llm_reduce("
+            "{'model_name': 'gpt-4o'}, "
+            "{'prompt': 'Summarize the log messages', 'context_columns': ["
+            "{'data': message}, "
+            "{'data': id, 'name': 'flock_watermark'}, "
+            "{'data': '" + state_key + "', 'name': 'flock_state_key'}]}"
+            ") AS summary FROM VALUES (1, 'service started'), (2, 'request served') AS logs(id, message);";
+
+    auto results = con.Query(query);
+    ASSERT_FALSE(results->HasError()) << "Query failed: " << results->GetError();
+    ASSERT_EQ(results->GetValue(0, 0).GetValue<std::string>(), GetExpectedResponse());
+
+    results = con.Query(query);
+    ASSERT_FALSE(results->HasError()) << "Query failed: " << results->GetError();
+    ASSERT_EQ(results->GetValue(0, 0).GetValue<std::string>(), GetExpectedResponse());
+
+    clear_state();
+}
+
 }// namespace flock
@@ -0,0 +1,151 @@
+#include "flock/functions/batch_packer.hpp"
+#include "flock/model_manager/output_budget.hpp"
+#include <gtest/gtest.h>
+
+namespace flock {
+
+static PackingBudget MakeBudget(int max_rows, int64_t max_input_tokens, int64_t max_output_tokens,
+                                int64_t output_tokens_per_row) {
+    PackingBudget budget;
+    budget.max_rows = max_rows;
+    budget.max_input_tokens = max_input_tokens;
+    budget.max_output_tokens = max_output_tokens;
+    budget.output_tokens_per_row = output_tokens_per_row;
+    return budget;
+}
+
+TEST(BatchPackerTest, EstimateRowTokensSumsColumns) {
+    const nlohmann::json tuples = {{{"name", "a"}, {"data", {"abcd", "abcdefgh"}}},
+                                   {{"name", "b"}, {"data", {"", "abcd"}}}};
+    const auto row_tokens = BatchPacker::EstimateRowTokens(tuples);
+    ASSERT_EQ(row_tokens.size(), 2);
+    EXPECT_EQ(row_tokens[0], 2 * BatchPacker::CELL_OVERHEAD_TOKENS + 1);
+    EXPECT_EQ(row_tokens[1], 2 * BatchPacker::CELL_OVERHEAD_TOKENS + 3);
+}
+
+TEST(BatchPackerTest, PackRespectsRowAndTokenLimits) {
+    const std::vector<int64_t> row_tokens(10, 10);
+
+    auto batches = BatchPacker::Pack(row_tokens, MakeBudget(4, 1000, 1000, 1));
+    ASSERT_EQ(batches.size(), 3);
+    EXPECT_EQ(batches[0], (std::vector<size_t>{0, 1, 2, 3}));
+    EXPECT_EQ(batches[2], (std::vector<size_t>{8, 9}));
+
+    // Input budget of 33 tokens fits three rows and their answers
+    batches = BatchPacker::Pack(row_tokens, MakeBudget(100, 33, 1000, 1));
+    EXPECT_EQ(batches.size(), 4);
+
+    // Output budget of 10 tokens at 5 per row fits two rows
+    batches = BatchPacker::Pack(row_tokens, MakeBudget(100, 1000, 10, 5));
+    EXPECT_EQ(batches.size(), 5);
+}
+
+TEST(BatchPackerTest, PackGroupsSimilarLengthsAndCoversEveryRow) {
+    const std::vector<int64_t> row_tokens = {100, 1, 100, 1, 100, 1};
+    const auto batches = BatchPacker::Pack(row_tokens, MakeBudget(3, 1000, 1000, 1));
+    ASSERT_EQ(batches.size(), 2);
+    EXPECT_EQ(batches[0], (std::vector<size_t>{1, 3, 5}));
+    EXPECT_EQ(batches[1], (std::vector<size_t>{0, 2, 4}));
+}
+
+TEST(BatchPackerTest, OversizedRowGetsItsOwnBatch) {
+    const std::vector<int64_t> row_tokens = {5, 500, 5};
+    const auto batches = BatchPacker::Pack(row_tokens, MakeBudget(10, 100, 1000, 1));
+    ASSERT_EQ(batches.size(), 2);
+    EXPECT_EQ(batches[0], (std::vector<size_t>{0, 2}));
+    EXPECT_EQ(batches[1], (std::vector<size_t>{1}));
+
+    EXPECT_THROW(BatchPacker::Pack(row_tokens, MakeBudget(0, 100, 1000, 1)), std::runtime_error);
+}
+
+TEST(BatchPackerTest, BudgetReadsModelParameters) {
+    ModelDetails details;
+    details.provider_name = "openai";
+    details.batch_size = 16;
+    details.model_parameters = {{"max_tokens", 1000}};
+
+    const auto budget = BatchPacker::Budget(details, "", ScalarFunctionType::FILTER);
+    EXPECT_EQ(budget.max_rows, 16);
+    EXPECT_EQ(budget.max_output_tokens, 1000);
+    EXPECT_EQ(budget.output_tokens_per_row, BatchPacker::FILTER_OUTPUT_TOKENS_PER_ROW);
+    EXPECT_EQ(budget.max_input_tokens, 128000 - BatchPacker::PROMPT_OVERHEAD_TOKENS);
+
+    details.provider_name = "ollama";
+    details.model_parameters = {{"options", {{"num_ctx", 8192}}}};
+    EXPECT_EQ(BatchPacker::ContextWindow(details), 8192);
+    EXPECT_EQ(BatchPacker::MaxOutputTokens(details), BatchPacker::DEFAULT_MAX_OUTPUT_TOKENS);
+
+    // Options of the wrong type fall back to the defaults
+    details.model_parameters = {{"options", {{"num_ctx", "8192"}, {"num_predict", 1.5}}}};
+    EXPECT_EQ(BatchPacker::ContextWindow(details), 4096);
+    EXPECT_EQ(BatchPacker::MaxOutputTokens(details), BatchPacker::DEFAULT_MAX_OUTPUT_TOKENS);
+}
+
+TEST(BatchPackerTest, DefaultOllamaModelPacksManyRows) {
+    BatchPacker::ClearLearnedMaxRows();
+    ModelDetails details;
+    details.provider_name = "ollama";
+    details.model = "llama3.2";
+    details.batch_size = 2048;
+
+    // The default context window is not used up by the default output cap
+    const auto budget = BatchPacker::Budget(details, "Is the review positive?", ScalarFunctionType::FILTER);
+    const auto batches = BatchPacker::Pack(std::vector<int64_t>(100, 20), budget);
+    ASSERT_EQ(batches.size(), 1);
+    EXPECT_EQ(batches[0].size(), 100);
+}
+
+TEST(BatchPackerTest, LatencyModeSendsOneRowPerBatch) {
+    ModelDetails details;
+    details.provider_name = "openai";
+    details.batch_size = 16;
+    details.execution_mode = ExecutionMode::LATENCY;
+
+    const auto budget = BatchPacker::Budget(details, "", ScalarFunctionType::COMPLETE);
+    EXPECT_EQ(budget.max_rows, 1);
+    EXPECT_EQ(BatchPacker::Pack({5, 5, 5}, budget).size(), 3);
+}
+
+TEST(BatchPackerTest, OverflowsLimitLaterBatches) {
+    BatchPacker::ClearLearnedMaxRows();
+    ModelDetails details;
+    details.provider_name = "openai";
+    details.model = "gpt-4o";
+    details.batch_size = 16;
+
+    BatchPacker::RecordOverflow(details, ScalarFunctionType::COMPLETE, 10);
+    BatchPacker::RecordOverflow(details, ScalarFunctionType::COMPLETE, 16);
+    EXPECT_EQ(BatchPacker::Budget(details, "", ScalarFunctionType::COMPLETE).max_rows, 5);
+    EXPECT_EQ(BatchPacker::LearnedMaxRows(details, ScalarFunctionType::COMPLETE, 3), 3);
+    // Other functions and models keep their batch size
+    EXPECT_EQ(BatchPacker::Budget(details, "", ScalarFunctionType::FILTER).max_rows, 16);
+    details.model = "gpt-4o-mini";
+    EXPECT_EQ(BatchPacker::Budget(details, "", ScalarFunctionType::COMPLETE).max_rows, 16);
+
+    BatchPacker::RecordOverflow(details, "llm_reduce", 1);
+    EXPECT_EQ(BatchPacker::LearnedMaxRows(details, "llm_reduce", 8), 1);
+    BatchPacker::ClearLearnedMaxRows();
+}
+
+TEST(BatchPackerTest, SchemaItemsHaveTheirOwnBudgetAndLimit) {
+    BatchPacker::ClearLearnedMaxRows();
+    OutputBudget::Clear();
+    ModelDetails details;
+    details.provider_name = "openai";
+    details.model = "gpt-4o";
+    details.batch_size = 16;
+    auto cascade_details = details;
+    cascade_details.model_parameters = {
+            {"response_format", {{"json_schema", {{"schema", {{"type", "object"}, {"properties", {{"answer", {{"type", "boolean"}}}}}}}}}}}};
+
+    // Object items are budgeted like completions, not like one filter token
+    EXPECT_EQ(BatchPacker::Budget(cascade_details, "", ScalarFunctionType::FILTER).output_tokens_per_row,
+              BatchPacker::COMPLETE_OUTPUT_TOKENS_PER_ROW);
+
+    BatchPacker::RecordOverflow(cascade_details, ScalarFunctionType::FILTER, 16);
+    EXPECT_EQ(BatchPacker::Budget(cascade_details, "", ScalarFunctionType::FILTER).max_rows, 8);
+    EXPECT_EQ(BatchPacker::Budget(details, "", ScalarFunctionType::FILTER).max_rows, 16);
+    BatchPacker::ClearLearnedMaxRows();
+}
+
+}// namespace flock
@@ -0,0 +1,64 @@
+#include "flock/core/config.hpp"
+#include "flock/functions/checkpoint_journal.hpp"
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+namespace flock {
+
+class CheckpointJournalTest : public ::testing::Test {
+protected:
+    void SetUp() override { ClearJournal(); }
+    void TearDown() override { ClearJournal(); }
+
+    static void ClearJournal() {
+        auto con = Config::GetConnection();
+        Config::StorageAttachmentGuard guard(con, false);
+        con.Query("DELETE FROM flock_storage.flock_config." + Config::get_checkpoint_table_name() +
+                  " WHERE request_hash = '" + REQUEST_HASH + "';");
+    }
+
+    static constexpr const char* REQUEST_HASH = "checkpoint_journal_unit_test";
+};
+
+// Scalar functions journal from several worker threads at once; none of their rows may be lost
+TEST_F(CheckpointJournalTest, ConcurrentAppendsAndLoads) {
+    constexpr int num_threads = 4;
+    constexpr int batches_per_thread = 10;
+
+    std::vector<std::thread> threads;
+    std::vector<int> failures(num_threads, 0);
+    for (int t = 0; t < num_threads; t++) {
+        threads.emplace_back([t, &failures]() {
+            for (int batch = 0; batch < batches_per_thread; batch++) {
+                auto row_hash = std::to_string(t) + "-" + std::to_string(batch);
+                try {
+                    CheckpointJournal::Append(REQUEST_HASH, {row_hash}, nlohmann::json::array({row_hash}));
+                    if (CheckpointJournal::Load(REQUEST_HASH, {row_hash}).count(row_hash) == 0) {
+                        failures[t]++;
+                    }
+                } catch (const std::exception&) {
+                    failures[t]++;
+                }
+            }
+        });
+    }
+    for (auto& thread: threads) {
+        thread.join();
+    }
+
+    std::vector<std::string> row_hashes;
+    for (int t = 0; t < num_threads; t++) {
+        EXPECT_EQ(failures[t], 0) << "thread " << t;
+        for (int batch = 0; batch < batches_per_thread; batch++) {
+            row_hashes.push_back(std::to_string(t) + "-" + std::to_string(batch));
+        }
+    }
+    const auto journaled = CheckpointJournal::Load(REQUEST_HASH, row_hashes);
+    ASSERT_EQ(journaled.size(), row_hashes.size());
+    for (const auto& row_hash: row_hashes) {
+        EXPECT_EQ(journaled.at(row_hash), row_hash);
+    }
+}
+
+}// namespace flock
@@ -0,0 +1,47 @@
+#include "flock/functions/input_parser.hpp"
+#include <gtest/gtest.h>
+
+namespace flock {
+
+static nlohmann::json CastQueryToJson(const std::string& query) {
+    duckdb::DuckDB db(nullptr);
+    duckdb::Connection con(db);
+    auto result = con.Query(query);
+    if (result->HasError()) {
+        throw std::runtime_error(result->GetError());
+    }
+    auto chunk = result->Fetch();
+    return CastVectorOfStructsToJson(chunk->data[0], static_cast<int>(chunk->size()));
+}
+
+TEST(InputParserTest, CastsContextColumnsColumnWise) {
+    const auto json = CastQueryToJson(
+            "SELECT {'prompt': 'Summarize', 'context_columns': [{'name': 'id', 'type': 'tabular', 'data': i::VARCHAR}, "
+            "{'name': 'text', 'type': NULL, 'data': CASE WHEN i = 1 THEN NULL ELSE 'row ' || i END}]} "
+            "FROM range(3) t(i)");
+
+    EXPECT_EQ(json["prompt"], "Summarize");
+    ASSERT_EQ(json["context_columns"].size(), 2);
+    EXPECT_EQ(json["context_columns"][0], nlohmann::json({{"name", "id"}, {"type", "tabular"}, {"data", {"0", "1", "2"}}}));
+    // NULL metadata is dropped and NULL data is kept as null
+    EXPECT_EQ(json["context_columns"][1], nlohmann::json({{"name", "text"}, {"data", {"row 0", nullptr, "row 2"}}}));
+}
+
+TEST(InputParserTest, ReadsConstantAndNestedData) {
+    const auto json = CastQueryToJson("SELECT {'context_columns': [{'data': [1, 2]}], 'batch_size': 4} FROM range(2)");
+
+    EXPECT_EQ(json["batch_size"], 4);
+    EXPECT_EQ(json["context_columns"][0]["data"], nlohmann::json({"[1, 2]", "[1, 2]"}));
+}
+
+TEST(InputParserTest, RejectsInvalidContextColumns) {
+    EXPECT_THROW(CastQueryToJson("SELECT {'context_columns': [{'name': 'x'}]}"), std::runtime_error);
+    EXPECT_THROW(CastQueryToJson("SELECT {'context_columns': [{'data': 'x', 'color': 'red'}]}"), std::runtime_error);
+    EXPECT_THROW(CastQueryToJson("SELECT {'context_columns': [{'data': 'x', 'transcription_model': 'whisper'}]}"),
+                 std::runtime_error);
+    EXPECT_THROW(CastQueryToJson("SELECT {'context_columns': CASE WHEN i = 0 THEN [{'data': 'a'}] "
+                                 "ELSE [{'data': 'b'}, {'data': 'c'}] END} FROM range(2) t(i)"),
+                 std::runtime_error);
+}
+
+}// namespace flock
@@ -11,6 +11,7 @@ public:
     MOCK_METHOD(void, AddCompletionRequest, (const std::string& prompt, const int num_output_tuples, OutputType output_type, const nlohmann::json& media_data), (override));
     MOCK_METHOD(void, AddEmbeddingRequest, (const std::vector<std::string>& inputs), (override));
     MOCK_METHOD(void, AddTranscriptionRequest, (const nlohmann::json& audio_files), (override));
+    MOCK_METHOD(void, AddYesNoRequest, (const std::string& prompt, const nlohmann::json& media_data), (override));
     MOCK_METHOD(std::vector<nlohmann::json>, CollectCompletions, (const std::string& contentType), (override));
     MOCK_METHOD(std::vector<nlohmann::json>, CollectEmbeddings, (const std::string& contentType), (override));
     MOCK_METHOD(std::vector<nlohmann::json>, CollectTranscriptions, (const std::string& contentType), (override));
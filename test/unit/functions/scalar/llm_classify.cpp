@@ -0,0 +1,100 @@
+#include "flock/functions/scalar/llm_classify.hpp"
+#include "llm_function_test_base.hpp"
+
+namespace flock {
+
+class LLMClassifyTest : public LLMFunctionTestBase<LlmClassify> {
+protected:
+    static constexpr const char* LABELS = "['positive', 'negative', 'neutral']";
+
+    std::string GetExpectedResponse() const override {
+        return "positive";
+    }
+
+    nlohmann::json GetExpectedJsonResponse() const override {
+        return nlohmann::json{{"items", {0}}};
+    }
+
+    std::string GetFunctionName() const override {
+        return "llm_classify";
+    }
+
+    nlohmann::json PrepareExpectedResponseForBatch(const std::vector<std::string>& responses) const override {
+        nlohmann::json expected_response = {{"items", {}}};
+        for (const auto& response: responses) {
+            expected_response["items"].push_back(response);
+        }
+        return expected_response;
+    }
+
+    nlohmann::json PrepareExpectedResponseForLargeInput(size_t input_count) const override {
+        nlohmann::json expected_response = {{"items", {}}};
+        for (size_t i = 0; i < input_count; i++) {
+            expected_response["items"].push_back(i % 3);
+        }
+        return expected_response;
+    }
+
+    std::string FormatExpectedResult(const nlohmann::json& response) const override {
+        return response.dump();
+    }
+};
+
+TEST_F(LLMClassifyTest, ReturnsTheLabelsAsEnum) {
+    // Indexes are what the schema asks for; a label or an out-of-range index is tolerated or NULL
+    const nlohmann::json expected_response = {{"items", {0, 2, "Negative", 7}}};
+    EXPECT_CALL(*mock_provider, AddCompletionRequest(::testing::HasSubstr("1: negative"), 4, OutputType::INTEGER,
+                                                     ::testing::_))
+            .Times(1);
+    EXPECT_CALL(*mock_provider, CollectCompletions(::testing::_))
+            .WillOnce(::testing::Return(std::vector<nlohmann::json>{expected_response}));
+
+    auto con = Config::GetConnection();
+    const auto results = con.Query("SELECT " + GetFunctionName() +
+                                   "({'model_name': 'gpt-4o'}, {'prompt': 'Sentiment?', 'context_columns': [{'data': v}]}, " +
+                                   LABELS + ") AS sentiment FROM (VALUES (1, 'great'), (2, 'fine'), (3, 'bad'), (4, 'odd')) "
+                                            "AS t(i, v) ORDER BY i;");
+    ASSERT_FALSE(results->HasError()) << "Query failed: " << results->GetError();
+    ASSERT_EQ(results->types[0].id(), duckdb::LogicalTypeId::ENUM);
+    ASSERT_EQ(results->RowCount(), 4);
+    EXPECT_EQ(results->GetValue(0, 0).ToString(), "positive");
+    EXPECT_EQ(results->GetValue(0, 1).ToString(), "neutral");
+    EXPECT_EQ(results->GetValue(0, 2).ToString(), "negative");
+    EXPECT_TRUE(results->GetValue(0, 3).IsNull());
+}
+
+TEST_F(LLMClassifyTest, RejectsInvalidLabels) {
+    auto con = Config::GetConnection();
+    const auto call = [&](const std::string& labels) {
+        return con.Query("SELECT " + GetFunctionName() +
+                         "({'model_name': 'gpt-4o'}, {'prompt': 'Sentiment?', 'context_columns': [{'data': 'x'}]}, " +
+                         labels + ")");
+    };
+    EXPECT_TRUE(call("[]::VARCHAR[]")->HasError());
+    EXPECT_TRUE(call("['a', 'a']")->HasError());
+    EXPECT_TRUE(call("['a', NULL]")->HasError());
+    EXPECT_TRUE(con.Query("SELECT " + GetFunctionName() +
+                          "({'model_name': 'gpt-4o'}, {'prompt': 'Sentiment?', 'context_columns': [{'data': 'x'}]})")
+                        ->HasError());
+
+    // An empty value must be one of the labels, whatever its type
+    for (const std::string empty_value: {"'neutral'", "1"}) {
+        const auto results = con.Query("SELECT " + GetFunctionName() + "({'model_name': 'gpt-4o', 'empty_value': " +
+                                       empty_value + "}, {'prompt': 'Sentiment?', 'context_columns': [{'data': 'x'}]}, " +
+                                       "['positive', 'negative'])");
+        ASSERT_TRUE(results->HasError());
+        EXPECT_NE(results->GetError().find("'empty_value' must be one of the labels"), std::string::npos);
+    }
+}
+
+TEST_F(LLMClassifyTest, ParseLabel) {
+    const std::vector<std::string> labels = {"positive", "negative"};
+    EXPECT_EQ(LlmClassify::ParseLabel(1, labels), 1);
+    EXPECT_EQ(LlmClassify::ParseLabel(" 0 ", labels), 0);
+    EXPECT_EQ(LlmClassify::ParseLabel("POSITIVE", labels), 0);
+    EXPECT_EQ(LlmClassify::ParseLabel(2, labels), std::nullopt);
+    EXPECT_EQ(LlmClassify::ParseLabel("maybe", labels), std::nullopt);
+    EXPECT_EQ(LlmClassify::LabelSchema(2), nlohmann::json::parse(R"({"type": "integer", "enum": [0, 1]})"));
+}
+
+}// namespace flock
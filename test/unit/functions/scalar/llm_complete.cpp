@@ -1,3 +1,5 @@
+#include "flock/functions/batch_packer.hpp"
+#include "flock/functions/checkpoint_journal.hpp"
 #include "flock/functions/scalar/llm_complete.hpp"
 #include "llm_function_test_base.hpp"
 
@@ -52,6 +54,42 @@ TEST_F(LLMCompleteTest, LLMCompleteWithoutInputColumns) {
     ASSERT_EQ(results->GetValue(0, 0).GetValue<std::string>(), GetExpectedResponse());
 }
 
+TEST_F(LLMCompleteTest, LLMCompleteWithoutInputColumnsAsksOncePerQuery) {
+    EXPECT_CALL(*mock_provider, AddCompletionRequest(::testing::_, 1, ::testing::_, ::testing::_))
+            .Times(1);
+    EXPECT_CALL(*mock_provider, CollectCompletions(::testing::_))
+            .WillOnce(::testing::Return(std::vector<nlohmann::json>{GetExpectedJsonResponse()}));
+
+    auto con = Config::GetConnection();
+    const auto results = con.Query("SELECT count(*), count(DISTINCT answer) FROM (SELECT " + GetFunctionName() +
+                                   "({'model_name': 'gpt-4o'}, {'prompt': 'Explain the purpose of FlockMTL.'}) AS answer "
+                                   "FROM range(100000) AS t(i) WHERE i >= 0);");
+    ASSERT_FALSE(results->HasError()) << "Query failed: " << results->GetError();
+    EXPECT_EQ(results->GetValue(0, 0).GetValue<int64_t>(), 100000);
+    EXPECT_EQ(results->GetValue(1, 0).GetValue<int64_t>(), 1);
+}
+
+TEST_F(LLMCompleteTest, LLMCompleteWithoutInputColumnsAsksAgainOnEachExecution) {
+    EXPECT_CALL(*mock_provider, AddCompletionRequest(::testing::_, 1, ::testing::_, ::testing::_))
+            .Times(2);
+    EXPECT_CALL(*mock_provider, CollectCompletions(::testing::_))
+            .WillOnce(::testing::Return(std::vector<nlohmann::json>{{{"items", {"first answer"}}}}))
+            .WillOnce(::testing::Return(std::vector<nlohmann::json>{{{"items", {"second answer"}}}}));
+
+    auto con = Config::GetConnection();
+    auto prepared = con.Prepare("SELECT " + GetFunctionName() +
+                                "({'model_name': 'gpt-4o'}, {'prompt': 'Explain the purpose of FlockMTL.'}) AS answer;");
+    ASSERT_FALSE(prepared->HasError()) << "Prepare failed: " << prepared->GetError();
+
+    // The response belongs to one execution, so the second one does not reuse it
+    const auto first = prepared->Execute();
+    ASSERT_FALSE(first->HasError()) << "Query failed: " << first->GetError();
+    const auto second = prepared->Execute();
+    ASSERT_FALSE(second->HasError()) << "Query failed: " << second->GetError();
+    EXPECT_EQ(first->Cast<duckdb::MaterializedQueryResult>().GetValue(0, 0).GetValue<std::string>(), "first answer");
+    EXPECT_EQ(second->Cast<duckdb::MaterializedQueryResult>().GetValue(0, 0).GetValue<std::string>(), "second answer");
+}
+
 TEST_F(LLMCompleteTest, LLMCompleteWithInputColumns) {
     const nlohmann::json expected_response = {{"items", {"The capital of Canada is Ottawa."}}};
     EXPECT_CALL(*mock_provider, AddCompletionRequest(::testing::_, ::testing::_, ::testing::_, ::testing::_))
@@ -262,4 +300,259 @@ TEST_F(LLMCompleteTest, LLMCompleteAudioMissingTranscriptionModel) {
     ASSERT_TRUE(results->HasError());
 }
 
+// Test checkpointing: journaled rows are skipped when the same query runs again
+TEST_F(LLMCompleteTest, LLMCompleteCheckpointSkipsJournaledRows) {
+    const std::string prompt = "Name the capital of this country (checkpoint unit test)";
+    const auto request_hash = CheckpointJournal::RequestHash(
+            Model::ResolveModelDetailsToJson({{"model_name", "gpt-4o"}}), prompt, ScalarFunctionType::COMPLETE);
+    auto con = Config::GetConnection();
+    auto clear_journal = [&con, &request_hash]() {
+        Config::StorageAttachmentGuard guard(con, false);
+        con.Query("DELETE FROM flock_storage.flock_config." + Config::get_checkpoint_table_name() +
+                  " WHERE request_hash = '" + request_hash + "';");
+    };
+    clear_journal();
+
+    const nlohmann::json expected_response = {{"items", {"Ottawa", "Paris"}}};
+    EXPECT_CALL(*mock_provider, AddCompletionRequest(::testing::_, 2, ::testing::_, ::testing::_))
+            .Times(1);
+    EXPECT_CALL(*mock_provider, CollectCompletions(::testing::_))
+            .WillOnce(::testing::Return(std::vector<nlohmann::json>{expected_response}));
+
+    const auto query = "SELECT " + GetFunctionName() +
+                       "({'model_name': 'gpt-4o', 'checkpoint': true}, "
+                       "{'prompt': '" + prompt + "', 'context_columns': [{'data': country}]}) AS capital "
+                       "FROM VALUES ('Canada'), ('France'), ('Canada') AS tbl(country);";
+
+    for (auto run = 0; run < 2; run++) {
+        const auto results = con.Query(query);
+        ASSERT_FALSE(results->HasError()) << "Query failed: " << results->GetError();
+        ASSERT_EQ(results->RowCount(), 3);
+        EXPECT_EQ(results->GetValue(0, 0).GetValue<std::string>(), "Ottawa");
+        EXPECT_EQ(results->GetValue(0, 1).GetValue<std::string>(), "Paris");
+        EXPECT_EQ(results->GetValue(0, 2).GetValue<std::string>(), "Ottawa");
+    }
+
+    clear_journal();
+}
+
+// Test that all batches of a chunk are submitted together and reassembled in order
+TEST_F(LLMCompleteTest, LLMCompleteDispatchesBatchesConcurrently) {
+    EXPECT_CALL(*mock_provider, AddCompletionRequest(::testing::_, ::testing::_, ::testing::_, ::testing::_))
+            .Times(3);
+    EXPECT_CALL(*mock_provider, CollectCompletions(::testing::_))
+            .WillOnce(::testing::Return(std::vector<nlohmann::json>{
+                    {{"items", {"r0", "r1"}}},
+                    {{"items", {"r2", "r3", "extra"}}},
+                    {{"items", nlohmann::json::array()}}}));
+
+    auto con = Config::GetConnection();
+    const auto results = con.Query("SELECT " + GetFunctionName() +
+                                   "({'model_name': 'gpt-4o', 'batch_size': 2}, "
+                                   "{'prompt': 'Echo the row', 'context_columns': [{'data': 'row ' || i::VARCHAR}]}) AS result "
+                                   "FROM range(5) AS t(i);");
+
+    ASSERT_FALSE(results->HasError()) << "Query failed: " << results->GetError();
+    ASSERT_EQ(results->RowCount(), 5);
+    EXPECT_EQ(results->GetValue(0, 0).GetValue<std::string>(), "r0");
+    EXPECT_EQ(results->GetValue(0, 1).GetValue<std::string>(), "r1");
+    EXPECT_EQ(results->GetValue(0, 2).GetValue<std::string>(), "r2");
+    EXPECT_EQ(results->GetValue(0, 3).GetValue<std::string>(), "r3");
+}
+
+// Test the cascade: confident rows keep the primary answer and only the rest reach the escalation model
+TEST_F(LLMCompleteTest, LLMCompleteCascadeEscalatesLowConfidenceRows) {
+    ::testing::InSequence sequence;
+    EXPECT_CALL(*mock_provider, AddCompletionRequest(::testing::_, 3, ::testing::_, ::testing::_));
+    EXPECT_CALL(*mock_provider, CollectCompletions(::testing::_))
+            .WillOnce(::testing::Return(std::vector<nlohmann::json>{
+                    {{"items", {{{"answer", "a"}, {"confidence", 0.95}}, {{"answer", "b"}, {"confidence", 0.2}}, "c"}}}}));
+    EXPECT_CALL(*mock_provider, AddCompletionRequest(::testing::_, 2, ::testing::_, ::testing::_));
+    EXPECT_CALL(*mock_provider, CollectCompletions(::testing::_))
+            .WillOnce(::testing::Return(std::vector<nlohmann::json>{{{"items", {"B", "C"}}}}));
+
+    auto con = Config::GetConnection();
+    const auto results = con.Query("SELECT " + GetFunctionName() +
+                                   "({'model_name': 'gpt-4o-mini', 'cascade': {'model_name': 'gpt-4o', 'threshold': 0.9}}, "
+                                   "{'prompt': 'Echo the row', 'context_columns': [{'data': 'row ' || i::VARCHAR}]}) AS result "
+                                   "FROM range(3) AS t(i);");
+
+    ASSERT_FALSE(results->HasError()) << "Query failed: " << results->GetError();
+    ASSERT_EQ(results->RowCount(), 3);
+    EXPECT_EQ(results->GetValue(0, 0).GetValue<std::string>(), "a");
+    EXPECT_EQ(results->GetValue(0, 1).GetValue<std::string>(), "B");
+    EXPECT_EQ(results->GetValue(0, 2).GetValue<std::string>(), "C");
+}
+
+TEST_F(LLMCompleteTest, LLMCompleteCascadeInvalidOptions) {
+    auto con = Config::GetConnection();
+    for (const auto* model: {"{'model_name': 'gpt-4o-mini', 'cascade': {'threshold': 0.5}}",
+                             "{'model_name': 'gpt-4o-mini', 'cascade': {'model_name': 'gpt-4o', 'threshold': 1.5}}",
+                             "{'model_name': 'gpt-4o-mini', 'checkpoint': true, 'cascade': {'model_name': 'gpt-4o'}}"}) {
+        const auto results = con.Query("SELECT " + GetFunctionName() + "(" + model +
+                                       ", {'prompt': 'Echo', 'context_columns': [{'data': 'x'}]});");
+        EXPECT_TRUE(results->HasError()) << model;
+    }
+}
+
+// Test that rows without any context are answered without calling the model
+TEST_F(LLMCompleteTest, LLMCompleteSkipsRowsWithoutContext) {
+    EXPECT_CALL(*mock_provider, AddCompletionRequest(::testing::_, 2, ::testing::_, ::testing::_))
+            .Times(2);
+    EXPECT_CALL(*mock_provider, CollectCompletions(::testing::_))
+            .Times(2)
+            .WillRepeatedly(::testing::Return(std::vector<nlohmann::json>{{{"items", {"r1", "r3"}}}}));
+
+    auto con = Config::GetConnection();
+    for (const std::string empty_value: {"", ", 'empty_value': 'n/a'"}) {
+        const auto results = con.Query("SELECT " + GetFunctionName() + "({'model_name': 'gpt-4o'" + empty_value + "}, " +
+                                       "{'prompt': 'Echo the row', 'context_columns': ["
+                                       "{'data': CASE WHEN i % 2 = 1 THEN 'row ' || i::VARCHAR END}, "
+                                       "{'data': CASE WHEN i = 2 THEN '' END}]}) AS result "
+                                       "FROM range(4) AS t(i) ORDER BY i;");
+        ASSERT_FALSE(results->HasError()) << "Query failed: " << results->GetError();
+        ASSERT_EQ(results->RowCount(), 4);
+        const auto expected_empty = empty_value.empty() ? duckdb::Value() : duckdb::Value("n/a");
+        EXPECT_EQ(results->GetValue(0, 0), expected_empty);
+        EXPECT_EQ(results->GetValue(0, 1).GetValue<std::string>(), "r1");
+        EXPECT_EQ(results->GetValue(0, 2), expected_empty);
+        EXPECT_EQ(results->GetValue(0, 3).GetValue<std::string>(), "r3");
+    }
+}
+
+// Test that under the retry policy rows missing from a response are asked again one at a time
+TEST_F(LLMCompleteTest, LLMCompleteErrorPolicyRetriesFailedRows) {
+    ::testing::InSequence sequence;
+    EXPECT_CALL(*mock_provider, AddCompletionRequest(::testing::_, 3, ::testing::_, ::testing::_));
+    EXPECT_CALL(*mock_provider, CollectCompletions(::testing::_))
+            .WillOnce(::testing::Return(std::vector<nlohmann::json>{{{"items", {"a"}}}}));
+    // Both rows are asked again together; that fails, so they are sent one at a time
+    EXPECT_CALL(*mock_provider, AddCompletionRequest(::testing::_, 1, ::testing::_, ::testing::_)).Times(2);
+    EXPECT_CALL(*mock_provider, CollectCompletions(::testing::_))
+            .WillOnce(::testing::Throw(std::runtime_error("Invalid JSON response")));
+    EXPECT_CALL(*mock_provider, AddCompletionRequest(::testing::_, 1, ::testing::_, ::testing::_));
+    EXPECT_CALL(*mock_provider, CollectCompletions(::testing::_))
+            .WillOnce(::testing::Return(std::vector<nlohmann::json>{{{"items", {"b"}}}}));
+    EXPECT_CALL(*mock_provider, AddCompletionRequest(::testing::_, 1, ::testing::_, ::testing::_));
+    EXPECT_CALL(*mock_provider, CollectCompletions(::testing::_))
+            .WillOnce(::testing::Throw(std::runtime_error("Invalid JSON response")));
+
+    auto con = Config::GetConnection();
+    const auto results = con.Query("SELECT " + GetFunctionName() +
+                                   "({'model_name': 'gpt-4o', 'error_policy': 'retry'}, "
+                                   "{'prompt': 'Echo the row', 'context_columns': [{'data': 'row ' || i::VARCHAR}]}) AS result "
+                                   "FROM range(3) AS t(i);");
+
+    ASSERT_FALSE(results->HasError()) << "Query failed: " << results->GetError();
+    ASSERT_EQ(results->RowCount(), 3);
+    EXPECT_EQ(results->GetValue(0, 0).GetValue<std::string>(), "a");
+    EXPECT_EQ(results->GetValue(0, 1).GetValue<std::string>(), "b");
+    EXPECT_TRUE(results->GetValue(0, 2).IsNull());
+}
+
+// Test that a failed request fails the query by default and only its rows under the null policy
+TEST_F(LLMCompleteTest, LLMCompleteErrorPolicyNullsFailedRows) {
+    // Once by default, then once concurrently and once on its own under the null policy
+    EXPECT_CALL(*mock_provider, AddCompletionRequest(::testing::_, 2, ::testing::_, ::testing::_))
+            .Times(3);
+    EXPECT_CALL(*mock_provider, CollectCompletions(::testing::_))
+            .Times(3)
+            .WillRepeatedly(::testing::Throw(std::runtime_error("Invalid JSON response")));
+
+    auto con = Config::GetConnection();
+    for (const std::string policy: {"", ", 'error_policy': 'null'"}) {
+        const auto results = con.Query("SELECT " + GetFunctionName() + "({'model_name': 'gpt-4o'" + policy + "}, " +
+                                       "{'prompt': 'Echo the row', 'context_columns': [{'data': 'row ' || i::VARCHAR}]}) "
+                                       "AS result FROM range(2) AS t(i);");
+        if (policy.empty()) {
+            EXPECT_TRUE(results->HasError());
+            continue;
+        }
+        ASSERT_FALSE(results->HasError()) << "Query failed: " << results->GetError();
+        ASSERT_EQ(results->RowCount(), 2);
+        EXPECT_TRUE(results->GetValue(0, 0).IsNull());
+        EXPECT_TRUE(results->GetValue(0, 1).IsNull());
+    }
+
+    EXPECT_TRUE(con.Query("SELECT " + GetFunctionName() + "({'model_name': 'gpt-4o', 'error_policy': 'skip'}, "
+                          "{'prompt': 'Echo', 'context_columns': [{'data': 'x'}]});")
+                        ->HasError());
+}
+
+// Test that only the failed batch of a round is asked again, and the batch that succeeded is kept
+TEST_F(LLMCompleteTest, LLMCompleteRetriesOnlyTheFailedBatch) {
+    ::testing::InSequence sequence;
+    EXPECT_CALL(*mock_provider, AddCompletionRequest(::testing::HasSubstr("row 0"), 2, ::testing::_, ::testing::_));
+    EXPECT_CALL(*mock_provider, AddCompletionRequest(::testing::HasSubstr("row 2"), 2, ::testing::_, ::testing::_));
+    EXPECT_CALL(*mock_provider, CollectCompletions(::testing::_))
+            .WillOnce(::testing::Throw(FailedRequestsError("Invalid JSON response", {1},
+                                                           {{{"items", {"a", "b"}}}, nullptr})));
+    EXPECT_CALL(*mock_provider, AddCompletionRequest(::testing::HasSubstr("row 2"), 1, ::testing::_, ::testing::_));
+    EXPECT_CALL(*mock_provider, AddCompletionRequest(::testing::HasSubstr("row 3"), 1, ::testing::_, ::testing::_));
+    EXPECT_CALL(*mock_provider, CollectCompletions(::testing::_))
+            .WillOnce(::testing::Return(std::vector<nlohmann::json>{{{"items", {"c"}}}, {{"items", {"d"}}}}));
+
+    auto con = Config::GetConnection();
+    const auto results = con.Query("SELECT " + GetFunctionName() +
+                                   "({'model_name': 'gpt-4o', 'batch_size': 2, 'error_policy': 'retry'}, "
+                                   "{'prompt': 'Echo the row', 'context_columns': [{'data': 'row ' || i::VARCHAR}]}) AS result "
+                                   "FROM range(4) AS t(i) ORDER BY i;");
+
+    ASSERT_FALSE(results->HasError()) << "Query failed: " << results->GetError();
+    ASSERT_EQ(results->RowCount(), 4);
+    EXPECT_EQ(results->GetValue(0, 0).GetValue<std::string>(), "a");
+    EXPECT_EQ(results->GetValue(0, 1).GetValue<std::string>(), "b");
+    EXPECT_EQ(results->GetValue(0, 2).GetValue<std::string>(), "c");
+    EXPECT_EQ(results->GetValue(0, 3).GetValue<std::string>(), "d");
+}
+
+// Test that a batch overflowing its output budget is split in halves, and later queries start at the smaller size
+TEST_F(LLMCompleteTest, LLMCompleteSplitsOverflowingBatchInHalves) {
+    BatchPacker::ClearLearnedMaxRows();
+    const std::vector<nlohmann::json> halves = {{{"items", {"a", "b"}}}, {{"items", {"c", "d"}}}};
+    ::testing::InSequence sequence;
+    EXPECT_CALL(*mock_provider, AddCompletionRequest(::testing::_, 4, ::testing::_, ::testing::_));
+    EXPECT_CALL(*mock_provider, CollectCompletions(::testing::_))
+            .WillOnce(::testing::Throw(ExceededMaxOutputTokensError({0}, std::vector<nlohmann::json>(1))));
+    EXPECT_CALL(*mock_provider, AddCompletionRequest(::testing::_, 2, ::testing::_, ::testing::_)).Times(2);
+    EXPECT_CALL(*mock_provider, CollectCompletions(::testing::_)).WillOnce(::testing::Return(halves));
+    EXPECT_CALL(*mock_provider, AddCompletionRequest(::testing::_, 2, ::testing::_, ::testing::_)).Times(2);
+    EXPECT_CALL(*mock_provider, CollectCompletions(::testing::_)).WillOnce(::testing::Return(halves));
+
+    auto con = Config::GetConnection();
+    for (auto run = 0; run < 2; run++) {
+        const auto results = con.Query("SELECT " + GetFunctionName() + "({'model_name': 'gpt-4o'}, " +
+                                       "{'prompt': 'Echo the row', 'context_columns': [{'data': 'row ' || i::VARCHAR}]}) "
+                                       "AS result FROM range(4) AS t(i) ORDER BY i;");
+        ASSERT_FALSE(results->HasError()) << "Query failed: " << results->GetError();
+        ASSERT_EQ(results->RowCount(), 4);
+        EXPECT_EQ(results->GetValue(0, 0).GetValue<std::string>(), "a");
+        EXPECT_EQ(results->GetValue(0, 3).GetValue<std::string>(), "d");
+    }
+    BatchPacker::ClearLearnedMaxRows();
+}
+
+// Test that the items completed before an overflow are kept and only the rest of the batch is sent again
+TEST_F(LLMCompleteTest, LLMCompleteKeepsItemsOfTruncatedResponse) {
+    BatchPacker::ClearLearnedMaxRows();
+    ::testing::InSequence sequence;
+    EXPECT_CALL(*mock_provider, AddCompletionRequest(::testing::_, 4, ::testing::_, ::testing::_));
+    EXPECT_CALL(*mock_provider, CollectCompletions(::testing::_))
+            .WillOnce(::testing::Throw(ExceededMaxOutputTokensError({0}, {{{"items", {"a"}}}})));
+    EXPECT_CALL(*mock_provider, AddCompletionRequest(::testing::_, 3, ::testing::_, ::testing::_));
+    EXPECT_CALL(*mock_provider, CollectCompletions(::testing::_))
+            .WillOnce(::testing::Return(std::vector<nlohmann::json>{{{"items", {"b", "c", "d"}}}}));
+
+    auto con = Config::GetConnection();
+    const auto results = con.Query("SELECT " + GetFunctionName() + "({'model_name': 'gpt-4o'}, " +
+                                   "{'prompt': 'Echo the row', 'context_columns': [{'data': 'row ' || i::VARCHAR}]}) "
+                                   "AS result FROM range(4) AS t(i) ORDER BY i;");
+    ASSERT_FALSE(results->HasError()) << "Query failed: " << results->GetError();
+    ASSERT_EQ(results->RowCount(), 4);
+    EXPECT_EQ(results->GetValue(0, 0).GetValue<std::string>(), "a");
+    EXPECT_EQ(results->GetValue(0, 1).GetValue<std::string>(), "b");
+    EXPECT_EQ(results->GetValue(0, 3).GetValue<std::string>(), "d");
+    BatchPacker::ClearLearnedMaxRows();
+}
+
 }// namespace flock
\ No newline at end of file
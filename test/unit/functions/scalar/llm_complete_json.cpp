@@ -91,4 +91,97 @@ TEST_F(LLMCompleteJsonTest, Operation_BatchProcessing) {
     EXPECT_EQ(result_value, expected_response["items"][0].dump());
 }
 
+TEST_F(LLMCompleteJsonTest, SchemaReturnsTypedStruct) {
+    const nlohmann::json expected_response = {
+            {"items",
+             {{{"category", "audio"}, {"score", 0.9}, {"tags", {"wireless", "bluetooth"}}},
+              {{"category", "kitchen"}, {"score", 1}, {"tags", nlohmann::json::array()}},
+              nullptr}}};
+    EXPECT_CALL(*mock_provider, AddCompletionRequest(::testing::_, ::testing::_, ::testing::_, ::testing::_))
+            .Times(1);
+    EXPECT_CALL(*mock_provider, CollectCompletions(::testing::_))
+            .WillOnce(::testing::Return(std::vector<nlohmann::json>{expected_response}));
+
+    auto con = Config::GetConnection();
+    const auto results = con.Query(
+            "SELECT " + GetFunctionName() +
+            "({'model_name': 'gpt-4o', 'model_parameters': '{\"response_format\": {\"type\": \"json_schema\", "
+            "\"json_schema\": {\"name\": \"product\", \"schema\": {\"type\": \"object\", \"properties\": "
+            "{\"category\": {\"type\": \"string\"}, \"score\": {\"type\": \"number\"}, "
+            "\"tags\": {\"type\": \"array\", \"items\": {\"type\": \"string\"}}}}}, \"strict\": true}}'}, "
+            "{'prompt': 'Categorize the product', 'context_columns': [{'data': product}]}) AS result "
+            "FROM (VALUES (1, 'Headphones'), (2, 'Kettle'), (3, 'Unknown')) AS t(i, product) ORDER BY i;");
+    ASSERT_FALSE(results->HasError()) << "Query failed: " << results->GetError();
+    ASSERT_EQ(results->types[0], duckdb::LogicalType::STRUCT({{"category", duckdb::LogicalType::VARCHAR},
+                                                              {"score", duckdb::LogicalType::DOUBLE},
+                                                              {"tags", duckdb::LogicalType::LIST(duckdb::LogicalType::VARCHAR)}}));
+    ASSERT_EQ(results->RowCount(), 3);
+    const auto first = duckdb::StructValue::GetChildren(results->GetValue(0, 0));
+    EXPECT_EQ(first[0].GetValue<std::string>(), "audio");
+    EXPECT_DOUBLE_EQ(first[1].GetValue<double>(), 0.9);
+    ASSERT_EQ(duckdb::ListValue::GetChildren(first[2]).size(), 2);
+    EXPECT_EQ(duckdb::ListValue::GetChildren(first[2])[1].GetValue<std::string>(), "bluetooth");
+    const auto second = duckdb::StructValue::GetChildren(results->GetValue(0, 1));
+    EXPECT_DOUBLE_EQ(second[1].GetValue<double>(), 1.0);
+    EXPECT_TRUE(duckdb::ListValue::GetChildren(second[2]).empty());
+    EXPECT_TRUE(results->GetValue(0, 2).IsNull());
+}
+
+TEST_F(LLMCompleteJsonTest, SchemaStructFieldsFollowThePropertyOrder) {
+    EXPECT_CALL(*mock_provider, AddCompletionRequest(::testing::_, ::testing::_, ::testing::_, ::testing::_))
+            .Times(1);
+    EXPECT_CALL(*mock_provider, CollectCompletions(::testing::_))
+            .WillOnce(::testing::Return(std::vector<nlohmann::json>{{{"items", {{{"score", 0.5}, {"category", "audio"}}}}}}));
+
+    auto con = Config::GetConnection();
+    const auto results = con.Query(
+            "SELECT " + GetFunctionName() +
+            "({'model_name': 'gpt-4o', 'model_parameters': '{\"response_format\": {\"type\": \"json_schema\", "
+            "\"json_schema\": {\"name\": \"product\", \"schema\": {\"type\": \"object\", \"properties\": "
+            "{\"score\": {\"type\": \"number\"}, \"category\": {\"type\": \"string\"}}}}, \"strict\": true}}'}, "
+            "{'prompt': 'Categorize the product', 'context_columns': [{'data': product}]}) AS result "
+            "FROM (VALUES ('Headphones')) AS t(product);");
+    ASSERT_FALSE(results->HasError()) << "Query failed: " << results->GetError();
+    ASSERT_EQ(results->types[0], duckdb::LogicalType::STRUCT({{"score", duckdb::LogicalType::DOUBLE},
+                                                              {"category", duckdb::LogicalType::VARCHAR}}));
+}
+
+TEST_F(LLMCompleteJsonTest, SchemaTypesTheEmptyValue) {
+    EXPECT_CALL(*mock_provider, AddCompletionRequest(::testing::_, 1, ::testing::_, ::testing::_))
+            .Times(1);
+    EXPECT_CALL(*mock_provider, CollectCompletions(::testing::_))
+            .WillOnce(::testing::Return(std::vector<nlohmann::json>{{{"items", {3}}}}));
+
+    const std::string model = "{'model_name': 'gpt-4o', 'model_parameters': '{\"response_format\": {\"type\": "
+                              "\"json_schema\", \"json_schema\": {\"name\": \"count\", \"schema\": "
+                              "{\"type\": \"integer\"}}, \"strict\": true}}'";
+    auto con = Config::GetConnection();
+    const auto results = con.Query("SELECT " + GetFunctionName() + "(" + model + ", 'empty_value': '0'}, " +
+                                   "{'prompt': 'Count the parts', 'context_columns': [{'data': product}]}) AS result "
+                                   "FROM (VALUES (1, 'Kettle'), (2, NULL)) AS t(i, product) ORDER BY i;");
+    ASSERT_FALSE(results->HasError()) << "Query failed: " << results->GetError();
+    ASSERT_EQ(results->types[0], duckdb::LogicalType::BIGINT);
+    EXPECT_EQ(results->GetValue(0, 0).GetValue<int64_t>(), 3);
+    EXPECT_EQ(results->GetValue(0, 1).GetValue<int64_t>(), 0);
+
+    // An empty value that is not of the result type fails at bind
+    const auto invalid = con.Query("SELECT " + GetFunctionName() + "(" + model + ", 'empty_value': 'n/a'}, " +
+                                   "{'prompt': 'Count the parts', 'context_columns': [{'data': product}]}) AS result "
+                                   "FROM (VALUES ('Kettle')) AS t(product);");
+    ASSERT_TRUE(invalid->HasError());
+    EXPECT_NE(invalid->GetError().find("empty_value"), std::string::npos);
+}
+
+TEST_F(LLMCompleteJsonTest, SchemaToLogicalType) {
+    EXPECT_EQ(ScalarFunctionBase::SchemaToLogicalType(nlohmann::json::parse(R"({"type": ["integer", "null"]})")),
+              duckdb::LogicalType::BIGINT);
+    EXPECT_EQ(ScalarFunctionBase::SchemaToLogicalType(nlohmann::json::parse(R"({"type": "array", "items": {"type": "boolean"}})")),
+              duckdb::LogicalType::LIST(duckdb::LogicalType::BOOLEAN));
+    // Objects without properties and untyped schemas stay JSON
+    EXPECT_EQ(ScalarFunctionBase::SchemaToLogicalType(nlohmann::json::parse(R"({"type": "object"})")),
+              duckdb::LogicalType::JSON());
+    EXPECT_EQ(ScalarFunctionBase::SchemaToLogicalType(nlohmann::json::parse(R"({"anyOf": [{"type": "string"}]})")),
+              duckdb::LogicalType::JSON());
+}
+
 }// namespace flock
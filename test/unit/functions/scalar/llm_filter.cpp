@@ -216,4 +216,105 @@ TEST_F(LLMFilterTest, LLMFilterAudioTranscriptionOllamaError) {
     ASSERT_TRUE(results->HasError());
 }
 
+TEST_F(LLMFilterTest, ReturnsBooleanAndOnlySeesSelectedRows) {
+    // The cheaper conjunct leaves 5 of the 10 rows for the model
+    const nlohmann::json expected_response = {{"items", {true, "False", "maybe", true, false}}};
+    EXPECT_CALL(*mock_provider, AddCompletionRequest(::testing::_, 5, ::testing::_, ::testing::_))
+            .Times(1);
+    EXPECT_CALL(*mock_provider, CollectCompletions(::testing::_))
+            .WillOnce(::testing::Return(std::vector<nlohmann::json>{expected_response}));
+
+    auto con = Config::GetConnection();
+    const auto results = con.Query("SELECT i FROM range(10) AS t(i) WHERE i % 2 = 0 AND " + GetFunctionName() +
+                                   "({'model_name': 'gpt-4o'}, {'prompt': 'Keep it?', 'context_columns': [{'data': i::VARCHAR}]}) "
+                                   "ORDER BY i;");
+    ASSERT_FALSE(results->HasError()) << "Query failed: " << results->GetError();
+    ASSERT_EQ(results->RowCount(), 2);
+    EXPECT_EQ(results->GetValue(0, 0).GetValue<int64_t>(), 0);
+    EXPECT_EQ(results->GetValue(0, 1).GetValue<int64_t>(), 6);
+}
+
+TEST_F(LLMFilterTest, ParseVerdict) {
+    EXPECT_EQ(LlmFilter::ParseVerdict(true), true);
+    EXPECT_EQ(LlmFilter::ParseVerdict(" TRUE "), true);
+    EXPECT_EQ(LlmFilter::ParseVerdict("false"), false);
+    EXPECT_EQ(LlmFilter::ParseVerdict(0), false);
+    EXPECT_EQ(LlmFilter::ParseVerdict(nullptr), std::nullopt);
+    EXPECT_EQ(LlmFilter::ParseVerdict("maybe"), std::nullopt);
+}
+
+TEST_F(LLMFilterTest, RowsWithoutContextAreNull) {
+    EXPECT_CALL(*mock_provider, AddCompletionRequest(::testing::_, 1, ::testing::_, ::testing::_))
+            .Times(1);
+    EXPECT_CALL(*mock_provider, CollectCompletions(::testing::_))
+            .WillOnce(::testing::Return(std::vector<nlohmann::json>{{{"items", {false}}}}));
+
+    auto con = Config::GetConnection();
+    const auto results = con.Query("SELECT " + GetFunctionName() +
+                                   "({'model_name': 'gpt-4o'}, {'prompt': 'Keep it?', 'context_columns': [{'data': v}]}) "
+                                   "FROM (VALUES (1, NULL), (2, ''), (3, 'text')) AS t(i, v) ORDER BY i;");
+    ASSERT_FALSE(results->HasError()) << "Query failed: " << results->GetError();
+    ASSERT_EQ(results->RowCount(), 3);
+    EXPECT_TRUE(results->GetValue(0, 0).IsNull());
+    EXPECT_TRUE(results->GetValue(0, 1).IsNull());
+    EXPECT_EQ(results->GetValue(0, 2), duckdb::Value::BOOLEAN(false));
+}
+
+TEST_F(LLMFilterTest, LogprobsAsksEveryRowForOneToken) {
+    EXPECT_CALL(*mock_provider, AddYesNoRequest(::testing::_, ::testing::_))
+            .Times(3);
+    EXPECT_CALL(*mock_provider, AddCompletionRequest(::testing::_, ::testing::_, ::testing::_, ::testing::_))
+            .Times(0);
+    EXPECT_CALL(*mock_provider, CollectCompletions(::testing::_))
+            .WillOnce(::testing::Return(std::vector<nlohmann::json>{
+                    {{"items", {0.9}}}, {{"items", {0.2}}}, {{"items", {nullptr}}}}));
+
+    auto con = Config::GetConnection();
+    const auto results = con.Query("SELECT " + GetFunctionName() +
+                                   "({'model_name': 'gpt-4o', 'logprobs': true}, "
+                                   "{'prompt': 'Keep it?', 'context_columns': [{'data': v}]}) "
+                                   "FROM (VALUES (1, 'a'), (2, 'b'), (3, 'c')) AS t(i, v) ORDER BY i;");
+    ASSERT_FALSE(results->HasError()) << "Query failed: " << results->GetError();
+    ASSERT_EQ(results->RowCount(), 3);
+    EXPECT_EQ(results->GetValue(0, 0), duckdb::Value::BOOLEAN(true));
+    EXPECT_EQ(results->GetValue(0, 1), duckdb::Value::BOOLEAN(false));
+    // The answer was neither yes nor no
+    EXPECT_TRUE(results->GetValue(0, 2).IsNull());
+}
+
+TEST_F(LLMFilterTest, ConfidenceReturnsTheProbabilityOfYes) {
+    EXPECT_CALL(*mock_provider, AddYesNoRequest(::testing::_, ::testing::_))
+            .Times(2);
+    EXPECT_CALL(*mock_provider, CollectCompletions(::testing::_))
+            .WillOnce(::testing::Return(std::vector<nlohmann::json>{{{"items", {0.75}}}, {{"items", {0.1}}}}));
+
+    auto con = Config::GetConnection();
+    const auto results = con.Query("SELECT llm_filter_confidence({'model_name': 'gpt-4o'}, "
+                                   "{'prompt': 'Keep it?', 'context_columns': [{'data': v}]}) "
+                                   "FROM (VALUES (1, 'a'), (2, NULL), (3, 'c')) AS t(i, v) ORDER BY i;");
+    ASSERT_FALSE(results->HasError()) << "Query failed: " << results->GetError();
+    ASSERT_EQ(results->RowCount(), 3);
+    EXPECT_DOUBLE_EQ(results->GetValue(0, 0).GetValue<double>(), 0.75);
+    EXPECT_TRUE(results->GetValue(0, 1).IsNull());
+    EXPECT_DOUBLE_EQ(results->GetValue(0, 2).GetValue<double>(), 0.1);
+}
+
+TEST_F(LLMFilterTest, LogprobsRejectsUnsupportedCombinations) {
+    auto con = Config::GetConnection();
+    auto results = con.Query("SELECT llm_complete({'model_name': 'gpt-4o', 'logprobs': true}, "
+                             "{'prompt': 'Summarize', 'context_columns': [{'data': 'x'}]})");
+    EXPECT_TRUE(results->HasError());
+    results = con.Query("SELECT " + GetFunctionName() + "({'model_name': 'gpt-4o', 'logprobs': true, 'checkpoint': true}, "
+                                                        "{'prompt': 'Keep it?', 'context_columns': [{'data': 'x'}]})");
+    EXPECT_TRUE(results->HasError());
+    results = con.Query("SELECT " + GetFunctionName() + "({'model_name': 'gpt-4o', 'logprobs': 'sometimes'}, "
+                                                        "{'prompt': 'Keep it?', 'context_columns': [{'data': 'x'}]})");
+    EXPECT_TRUE(results->HasError());
+    // Reasoning models would spend the one answer token on reasoning
+    results = con.Query("SELECT " + GetFunctionName() + "({'model_name': 'gpt-4o', 'model': 'o3-mini', 'logprobs': true}, "
+                                                        "{'prompt': 'Keep it?', 'context_columns': [{'data': 'x'}]})");
+    ASSERT_TRUE(results->HasError());
+    EXPECT_NE(results->GetError().find("reasoning model 'o3-mini'"), std::string::npos);
+}
+
 }// namespace flock
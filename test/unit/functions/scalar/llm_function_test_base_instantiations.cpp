@@ -1,3 +1,4 @@
+#include "flock/functions/scalar/llm_classify.hpp"
 #include "flock/functions/scalar/llm_complete.hpp"
 #include "flock/functions/scalar/llm_embedding.hpp"
 #include "flock/functions/scalar/llm_filter.hpp"
@@ -18,6 +19,7 @@ void LLMFunctionTestBase<FunctionClass>::SetUp() {
 
     mock_provider = std::make_shared<MockProvider>(ModelDetails{});
     Model::SetMockProvider(mock_provider);
+    PromptManager::ClearTranscriptionCache();
 }
 
 template<typename FunctionClass>
@@ -58,6 +60,7 @@ void LLMFunctionTestBase<FunctionClass>::TestValidateArguments() {
 }
 
 // Explicit instantiations for all used function classes
+template class LLMFunctionTestBase<LlmClassify>;
 template class LLMFunctionTestBase<LlmComplete>;
 template class LLMFunctionTestBase<LlmEmbedding>;
 template class LLMFunctionTestBase<LlmFilter>;
@@ -94,6 +94,29 @@ TEST_F(MetricsTest, TracksDifferentFunctionsSeparately) {
     EXPECT_EQ(total_output, 150);
 }
 
+TEST_F(MetricsTest, UpdateCachedTokensForLlmComplete) {
+    auto* db = GetDatabase();
+    const void* state_id = reinterpret_cast<const void*>(0x1234);
+
+    MetricsManager::StartInvocation(db, state_id, FunctionType::LLM_COMPLETE);
+    MetricsManager::UpdateTokens(1000, 50);
+    MetricsManager::UpdateCachedTokens(800);
+
+    auto& manager = GetMetricsManager();
+    auto metrics = manager.GetMetrics();
+
+    bool found = false;
+    for (const auto& [key, value]: metrics.items()) {
+        if (key.find("llm_complete_") == 0) {
+            EXPECT_EQ(value["input_tokens"].get<int64_t>(), 1000);
+            EXPECT_EQ(value["cached_input_tokens"].get<int64_t>(), 800);
+            found = true;
+            break;
+        }
+    }
+    EXPECT_TRUE(found);
+}
+
 TEST_F(MetricsTest, IncrementApiCalls) {
     auto* db = GetDatabase();
     const void* state_id = reinterpret_cast<const void*>(0x1234);
@@ -0,0 +1,118 @@
+#include "../mock_provider.hpp"
+#include "flock/core/config.hpp"
+#include "flock/functions/table/llm_pipelined.hpp"
+#include "flock/model_manager/model.hpp"
+#include "flock/prompt_manager/prompt_manager.hpp"
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace flock {
+
+class LLMPipelinedTest : public ::testing::Test {
+protected:
+    std::shared_ptr<MockProvider> mock_provider;
+
+    void SetUp() override {
+        auto con = Config::GetConnection();
+        con.Query(" CREATE SECRET ("
+                  "       TYPE OPENAI,"
+                  "    API_KEY 'your-api-key');");
+
+        mock_provider = std::make_shared<MockProvider>(ModelDetails{});
+        Model::SetMockProvider(mock_provider);
+        PromptManager::ClearTranscriptionCache();
+    }
+
+    void TearDown() override {
+        Model::ResetMockProvider();
+    }
+};
+
+TEST_F(LLMPipelinedTest, CompleteKeepsInputColumnsAndAppendsResult) {
+    EXPECT_CALL(*mock_provider, AddCompletionRequest(::testing::_, 3, ::testing::_, ::testing::_))
+            .Times(1);
+    EXPECT_CALL(*mock_provider, CollectCompletions(::testing::_))
+            .WillOnce(::testing::Return(std::vector<nlohmann::json>{{{"items", {"r0", "r1", "r2"}}}}));
+
+    auto con = Config::GetConnection();
+    const auto results = con.Query("SELECT * FROM llm_complete_pipelined("
+                                   "(SELECT i, 'row ' || i::VARCHAR AS txt FROM range(3) AS t(i)), "
+                                   "{'model_name': 'gpt-4o'}, {'prompt': 'Echo the row'}, "
+                                   "context_columns := ['txt']);");
+
+    ASSERT_FALSE(results->HasError()) << "Query failed: " << results->GetError();
+    ASSERT_EQ(results->ColumnCount(), 3);
+    EXPECT_EQ(results->names[2], LlmPipelined::RESULT_COLUMN);
+    ASSERT_EQ(results->RowCount(), 3);
+    EXPECT_EQ(results->GetValue(1, 0).GetValue<std::string>(), "row 0");
+    EXPECT_EQ(results->GetValue(2, 0).GetValue<std::string>(), "r0");
+    EXPECT_EQ(results->GetValue(2, 2).GetValue<std::string>(), "r2");
+}
+
+TEST_F(LLMPipelinedTest, EmitsEveryChunkForAnyLookahead) {
+    EXPECT_CALL(*mock_provider, AddCompletionRequest(::testing::_, ::testing::_, ::testing::_, ::testing::_))
+            .Times(::testing::AtLeast(1));
+    EXPECT_CALL(*mock_provider, CollectCompletions(::testing::_))
+            .WillRepeatedly(::testing::Return(std::vector<nlohmann::json>{{{"items", {true}}}}));
+
+    auto con = Config::GetConnection();
+    for (const auto* lookahead: {"0", "1", "8"}) {
+        const auto results = con.Query(std::string("SELECT count(*), count(result) FROM llm_filter_pipelined("
+                                                   "(SELECT 'row ' || i::VARCHAR AS txt FROM range(5000) AS t(i)), "
+                                                   "{'model_name': 'gpt-4o'}, "
+                                                   "{'prompt': 'Is the row even?'}, lookahead := ") +
+                                       lookahead + ");");
+        ASSERT_FALSE(results->HasError()) << "Query failed: " << results->GetError();
+        EXPECT_EQ(results->GetValue(0, 0).GetValue<int64_t>(), 5000);
+        EXPECT_EQ(results->GetValue(1, 0).GetValue<int64_t>(), 5000);
+    }
+}
+
+TEST_F(LLMPipelinedTest, CoalescesSmallChunksIntoFullBatches) {
+    // The filter leaves 20 rows spread over the 5 chunks of the range
+    const std::string input = "(SELECT 'row ' || i::VARCHAR AS txt FROM range(10000) AS t(i) WHERE i % 500 = 0)";
+    EXPECT_CALL(*mock_provider, AddCompletionRequest(::testing::_, 20, ::testing::_, ::testing::_))
+            .Times(1);
+    EXPECT_CALL(*mock_provider, CollectCompletions(::testing::_))
+            .WillOnce(::testing::Return(std::vector<nlohmann::json>{{{"items", {"r0"}}}}));
+
+    auto con = Config::GetConnection();
+    auto results = con.Query("SELECT * FROM llm_complete_pipelined(" + input +
+                             ", {'model_name': 'gpt-4o', 'batch_size': 100}, {'prompt': 'Echo the row'});");
+    ASSERT_FALSE(results->HasError()) << "Query failed: " << results->GetError();
+    ASSERT_EQ(results->RowCount(), 20);
+    EXPECT_EQ(results->GetValue(1, 0).GetValue<std::string>(), "r0");
+    ::testing::Mock::VerifyAndClearExpectations(mock_provider.get());
+
+    // Without a flush deadline every chunk is sent on its own
+    EXPECT_CALL(*mock_provider, AddCompletionRequest(::testing::_, ::testing::_, ::testing::_, ::testing::_))
+            .Times(5);
+    EXPECT_CALL(*mock_provider, CollectCompletions(::testing::_))
+            .WillRepeatedly(::testing::Return(std::vector<nlohmann::json>{{{"items", {"r"}}}}));
+    results = con.Query("SELECT * FROM llm_complete_pipelined(" + input +
+                        ", {'model_name': 'gpt-4o', 'batch_size': 100}, {'prompt': 'Echo the row'}, "
+                        "flush_after_ms := 0);");
+    ASSERT_FALSE(results->HasError()) << "Query failed: " << results->GetError();
+    EXPECT_EQ(results->RowCount(), 20);
+}
+
+TEST_F(LLMPipelinedTest, InvalidParametersFailAtBind) {
+    auto con = Config::GetConnection();
+    auto results = con.Query("SELECT * FROM llm_complete_pipelined((SELECT 'a' AS txt), {'model_name': 'gpt-4o'}, "
+                             "{'prompt': 'p'}, context_columns := ['missing']);");
+    EXPECT_TRUE(results->HasError());
+
+    results = con.Query("SELECT * FROM llm_complete_pipelined((SELECT 'a' AS txt), {'model_name': 'gpt-4o'}, "
+                        "{'prompt': 'p'}, lookahead := -1);");
+    EXPECT_TRUE(results->HasError());
+
+    results = con.Query("SELECT * FROM llm_complete_pipelined((SELECT 'a' AS txt), {'model_name': 'gpt-4o'}, "
+                        "{'prompt': 'p'}, flush_after_ms := -1);");
+    EXPECT_TRUE(results->HasError());
+
+    results = con.Query("SELECT * FROM llm_complete_pipelined((SELECT 'a' AS result), {'model_name': 'gpt-4o'}, "
+                        "{'prompt': 'p'});");
+    EXPECT_TRUE(results->HasError());
+}
+
+}// namespace flock
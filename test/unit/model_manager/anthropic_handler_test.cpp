@@ -7,6 +7,13 @@
 namespace flock {
 using json = nlohmann::json;
 
+// Exposes the protected usage parser for testing
+class TestableAnthropicModelManager : public AnthropicModelManager {
+public:
+    TestableAnthropicModelManager() : AnthropicModelManager("sk-ant-test", ANTHROPIC_DEFAULT_API_VERSION, true) {}
+    using AnthropicModelManager::ExtractTokenUsage;
+};
+
 class AnthropicHandlerTest : public ::testing::Test {
 protected:
     void SetUp() override {
@@ -234,4 +241,40 @@ TEST_F(AnthropicHandlerTest, MultipleContentBlocks) {
     EXPECT_EQ(response["content"][1]["type"], "text");
 }
 
+// Test that prompt cache reads and writes are counted as input and cache reads are reported separately
+TEST_F(AnthropicHandlerTest, TokenUsageIncludesPromptCache) {
+    TestableAnthropicModelManager handler;
+    json response = {
+        {"usage", {
+            {"input_tokens", 20},
+            {"output_tokens", 15},
+            {"cache_creation_input_tokens", 0},
+            {"cache_read_input_tokens", 1500}
+        }}
+    };
+
+    auto usage = handler.ExtractTokenUsage(response);
+    EXPECT_EQ(usage.input_tokens, 1520);
+    EXPECT_EQ(usage.output_tokens, 15);
+    EXPECT_EQ(usage.cached_input_tokens, 1500);
+}
+
+// Test that the local token count fallback only sees the text of a request, not base64 media
+TEST_F(AnthropicHandlerTest, RequestTextSkipsMedia) {
+    const std::string image_data(100000, 'A');
+    json anthropic_request = {
+            {"model", "claude-3-5-sonnet"},
+            {"system", {{{"type", "text"}, {"text", "Be brief."}}}},
+            {"messages",
+             {{{"role", "user"},
+               {"content",
+                {{{"type", "image"}, {"source", {{"type", "base64"}, {"media_type", "image/png"}, {"data", image_data}}}},
+                 {{"type", "text"}, {"text", "Describe the image."}}}}}}}};
+    EXPECT_EQ(BaseModelProviderHandler::RequestText(anthropic_request), "Be brief.\nDescribe the image.\n");
+
+    json ollama_request = {{"model", "llama3"},
+                           {"messages", {{{"role", "user"}, {"content", "Describe the image."}, {"images", {image_data}}}}}};
+    EXPECT_EQ(BaseModelProviderHandler::RequestText(ollama_request), "Describe the image.\n");
+}
+
 }// namespace flock
@@ -0,0 +1,73 @@
+#include "flock/model_manager/providers/handlers/ollama.hpp"
+#include "flock/model_manager/providers/handlers/openai.hpp"
+#include "nlohmann/json.hpp"
+#include <cmath>
+#include <gtest/gtest.h>
+
+namespace flock {
+using json = nlohmann::json;
+
+// Exposes the protected response parsers for testing
+class TestableOpenAIModelManager : public OpenAIModelManager {
+public:
+    TestableOpenAIModelManager() : OpenAIModelManager("sk-test", "", true) {}
+    using OpenAIModelManager::checkProviderSpecificResponse;
+    using OpenAIModelManager::ExtractCompletionOutput;
+};
+
+class TestableOllamaModelManager : public OllamaModelManager {
+public:
+    TestableOllamaModelManager() : OllamaModelManager("http://localhost:11434", true) {}
+    using OllamaModelManager::checkProviderSpecificResponse;
+    using OllamaModelManager::ExtractCompletionOutput;
+};
+
+TEST(LogprobsTest, YesProbabilityRenormalizesOverYesAndNo) {
+    const auto top_logprobs = json::array({{{"token", "Yes"}, {"logprob", std::log(0.6)}},
+                                           {{"token", " yes"}, {"logprob", std::log(0.1)}},
+                                           {{"token", "No"}, {"logprob", std::log(0.1)}},
+                                           {{"token", "Maybe"}, {"logprob", std::log(0.2)}}});
+    EXPECT_NEAR(BaseModelProviderHandler::YesProbability(top_logprobs).get<double>(), 0.875, 1e-9);
+    EXPECT_NEAR(BaseModelProviderHandler::YesProbability({{{"token", "FALSE"}, {"logprob", 0.0}}}).get<double>(), 0.0,
+                1e-9);
+    EXPECT_TRUE(BaseModelProviderHandler::YesProbability({{{"token", "Sure"}, {"logprob", 0.0}}}).is_null());
+}
+
+TEST(LogprobsTest, OpenAIReadsTheAnswerToken) {
+    TestableOpenAIModelManager handler;
+    const json response = {
+            {"choices",
+             {{{"finish_reason", "length"},
+               {"message", {{"content", "Yes"}}},
+               {"logprobs",
+                {{"content",
+                  {{{"token", "Yes"},
+                    {"logprob", std::log(0.9)},
+                    {"top_logprobs",
+                     {{{"token", "Yes"}, {"logprob", std::log(0.9)}}, {{"token", "No"}, {"logprob", std::log(0.1)}}}}}}}}}}}}};
+
+    // Stopping at the single token is expected, not an overflow
+    EXPECT_NO_THROW(handler.checkProviderSpecificResponse(response, IModelProviderHandler::RequestType::Completion));
+    EXPECT_NEAR(handler.ExtractCompletionOutput(response)["items"][0].get<double>(), 0.9, 1e-9);
+
+    const json truncated = {{"choices", {{{"finish_reason", "length"}, {"message", {{"content", "{\"items\""}}}}}}};
+    EXPECT_THROW(handler.checkProviderSpecificResponse(truncated, IModelProviderHandler::RequestType::Completion), ExceededMaxOutputTokensError);
+}
+
+TEST(LogprobsTest, OllamaReadsTheAnswerToken) {
+    TestableOllamaModelManager handler;
+    const json response = {
+            {"done", true},
+            {"done_reason", "length"},
+            {"message", {{"role", "assistant"}, {"content", "no"}}},
+            {"logprobs",
+             {{{"token", "no"},
+               {"logprob", std::log(0.7)},
+               {"top_logprobs",
+                {{{"token", "no"}, {"logprob", std::log(0.7)}}, {{"token", "yes"}, {"logprob", std::log(0.3)}}}}}}}};
+
+    EXPECT_NO_THROW(handler.checkProviderSpecificResponse(response, IModelProviderHandler::RequestType::Completion));
+    EXPECT_NEAR(handler.ExtractCompletionOutput(response)["items"][0].get<double>(), 0.3, 1e-9);
+}
+
+}// namespace flock
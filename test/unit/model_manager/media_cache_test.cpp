@@ -0,0 +1,145 @@
+#include "flock/model_manager/providers/handlers/media_cache.hpp"
+#include "flock/model_manager/providers/handlers/url_handler.hpp"
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+namespace flock {
+
+class MediaCacheTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        cache_dir = std::filesystem::temp_directory_path() / "flock_media_cache_test";
+        std::filesystem::remove_all(cache_dir);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(cache_dir);
+    }
+
+    static MediaCache::Entry MakeEntry(const std::string& content) {
+        MediaCache::Entry entry;
+        entry.base64_content = content;
+        entry.etag = "\"v1\"";
+        entry.validated_at = MediaCache::Now();
+        return entry;
+    }
+
+    std::filesystem::path cache_dir;
+};
+
+TEST_F(MediaCacheTest, GetReturnsStoredEntry) {
+    MediaCache cache(cache_dir);
+    cache.Put("https://example.com/a.png", MakeEntry("QUJD"));
+
+    auto entry = cache.Get("https://example.com/a.png");
+    ASSERT_TRUE(entry.has_value());
+    EXPECT_EQ(entry->base64_content, "QUJD");
+    EXPECT_EQ(entry->etag, "\"v1\"");
+    EXPECT_FALSE(cache.Get("https://example.com/b.png").has_value());
+}
+
+TEST_F(MediaCacheTest, PersistedEntriesSurviveNewInstance) {
+    {
+        MediaCache cache(cache_dir);
+        cache.Put("https://example.com/a.png", MakeEntry("QUJD"));
+        cache.Put("https://example.com/local-only.png", MakeEntry("REVG"), false);
+    }
+
+    MediaCache reopened(cache_dir);
+    auto entry = reopened.Get("https://example.com/a.png");
+    ASSERT_TRUE(entry.has_value());
+    EXPECT_EQ(entry->base64_content, "QUJD");
+    EXPECT_EQ(entry->etag, "\"v1\"");
+    EXPECT_FALSE(reopened.Get("https://example.com/local-only.png").has_value());
+}
+
+TEST_F(MediaCacheTest, MemoryLimitEvictsLeastRecentlyUsed) {
+    MediaCache cache(cache_dir, 8, MediaCache::DEFAULT_DISK_LIMIT_BYTES);
+    cache.Put("a", MakeEntry("AAAA"), false);
+    cache.Put("b", MakeEntry("BBBB"), false);
+    ASSERT_TRUE(cache.Get("a").has_value());// "a" becomes most recently used
+    cache.Put("c", MakeEntry("CCCC"), false);
+
+    EXPECT_LE(cache.MemoryBytes(), 8u);
+    EXPECT_TRUE(cache.Get("a").has_value());
+    EXPECT_FALSE(cache.Get("b").has_value());
+    EXPECT_TRUE(cache.Get("c").has_value());
+}
+
+TEST_F(MediaCacheTest, DiskLimitEvictsOldEntries) {
+    MediaCache cache(cache_dir, MediaCache::DEFAULT_MEMORY_LIMIT_BYTES, 8);
+    cache.Put("https://example.com/a.png", MakeEntry("AAAA"));
+    cache.Put("https://example.com/b.png", MakeEntry("BBBB"));
+    cache.Put("https://example.com/c.png", MakeEntry("CCCC"));
+
+    uintmax_t total_size = 0;
+    for (const auto& entry: std::filesystem::directory_iterator(cache_dir)) {
+        if (entry.path().extension() == ".b64") {
+            total_size += entry.file_size();
+        }
+    }
+    EXPECT_LE(total_size, 8u);
+}
+
+TEST_F(MediaCacheTest, DiskBytesTracksWrittenContent) {
+    MediaCache cache(cache_dir);
+    cache.Put("https://example.com/a.png", MakeEntry("AAAA"));
+    cache.Put("https://example.com/b.png", MakeEntry("BBBBBBBB"));
+    EXPECT_EQ(cache.DiskBytes(), 12u);
+
+    // Rewriting an entry replaces its bytes instead of adding to them
+    cache.Put("https://example.com/a.png", MakeEntry("AA"));
+    EXPECT_EQ(cache.DiskBytes(), 10u);
+}
+
+TEST_F(MediaCacheTest, ConcurrentPutsStayWithinDiskLimit) {
+    MediaCache cache(cache_dir, MediaCache::DEFAULT_MEMORY_LIMIT_BYTES, 64);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&cache, t]() {
+            for (int i = 0; i < 20; i++) {
+                cache.Put("https://example.com/" + std::to_string(t) + "/" + std::to_string(i % 5) + ".png",
+                          MakeEntry("ABCDEFGH"));
+            }
+        });
+    }
+    for (auto& thread: threads) {
+        thread.join();
+    }
+
+    uintmax_t total_size = 0;
+    for (const auto& entry: std::filesystem::directory_iterator(cache_dir)) {
+        EXPECT_NE(entry.path().extension(), ".tmp");
+        if (entry.path().extension() == ".b64") {
+            EXPECT_EQ(entry.file_size(), 8u);
+            total_size += entry.file_size();
+        }
+    }
+    EXPECT_LE(total_size, 64u);
+    EXPECT_TRUE(cache.Get("https://example.com/0/0.png").has_value());
+}
+
+TEST_F(MediaCacheTest, ResolveLocalFileReencodesOnlyWhenChanged) {
+    auto file_path = (cache_dir / "image.bin").string();
+    std::filesystem::create_directories(cache_dir);
+    {
+        std::ofstream file(file_path, std::ios::binary);
+        file << "abc";
+    }
+
+    auto first = URLHandler::ResolveFileToBase64(file_path);
+    EXPECT_EQ(first.base64_content, "YWJj");
+    EXPECT_FALSE(first.is_temp_file);
+    EXPECT_EQ(URLHandler::ResolveFileToBase64(file_path).base64_content, "YWJj");
+
+    {
+        std::ofstream file(file_path, std::ios::binary | std::ios::trunc);
+        file << "abcd";
+    }
+    EXPECT_EQ(URLHandler::ResolveFileToBase64(file_path).base64_content, "YWJjZA==");
+}
+
+}// namespace flock
@@ -0,0 +1,48 @@
+#include "flock/model_manager/output_budget.hpp"
+#include <gtest/gtest.h>
+
+namespace flock {
+
+TEST(OutputBudgetTest, FixedBudgetsForBooleansAndIntegers) {
+    ModelDetails details;
+    details.model = "gpt-4o";
+    EXPECT_EQ(OutputBudget::MaxTokens(details, OutputType::BOOL, 10),
+              OutputBudget::ENVELOPE_TOKENS + 10 * OutputBudget::BOOL_ITEM_TOKENS);
+    EXPECT_EQ(OutputBudget::MaxTokens(details, OutputType::INTEGER, 1),
+              OutputBudget::ENVELOPE_TOKENS + OutputBudget::INTEGER_ITEM_TOKENS);
+
+    // A limit set by the user, or a reasoning model, is left alone
+    details.model_parameters = {{"max_tokens", 100}};
+    EXPECT_FALSE(OutputBudget::MaxTokens(details, OutputType::BOOL, 10).has_value());
+    details.model_parameters = nlohmann::json::object();
+    details.model = "o3-mini";
+    EXPECT_FALSE(OutputBudget::MaxTokens(details, OutputType::BOOL, 10).has_value());
+}
+
+TEST(OutputBudgetTest, StringBudgetsFollowObservedSizes) {
+    OutputBudget::Clear();
+    ModelDetails details;
+    details.model = "gpt-4o";
+    EXPECT_FALSE(OutputBudget::MaxTokens(details, OutputType::STRING, 4).has_value());
+
+    OutputBudget::Observe("gpt-4o", {{"items", {"a", "b"}}}, 59);
+    OutputBudget::Observe("gpt-4o", {{"items", {"c"}}}, 10);
+    EXPECT_EQ(OutputBudget::ItemTokens("gpt-4o", OutputType::STRING), 60);
+    EXPECT_EQ(OutputBudget::MaxTokens(details, OutputType::STRING, 4), OutputBudget::ENVELOPE_TOKENS + 4 * 60);
+    // Other output types are observed separately
+    EXPECT_FALSE(OutputBudget::ItemTokens("gpt-4o", OutputType::OBJECT).has_value());
+    OutputBudget::Clear();
+}
+
+TEST(OutputBudgetTest, CustomSchemasTakeTheirItemType) {
+    OutputBudget::Clear();
+    ModelDetails details;
+    details.model = "gpt-4o";
+    details.model_parameters = {{"response_format", {{"json_schema", {{"schema", {{"type", "integer"}, {"enum", {0, 1}}}}}}}}};
+    EXPECT_EQ(OutputBudget::MaxTokens(details, OutputType::STRING, 2),
+              OutputBudget::ENVELOPE_TOKENS + 2 * OutputBudget::INTEGER_ITEM_TOKENS);
+    details.model_parameters = {{"format", {{"type", "object"}}}};
+    EXPECT_FALSE(OutputBudget::MaxTokens(details, OutputType::INTEGER, 2).has_value());
+}
+
+}// namespace flock
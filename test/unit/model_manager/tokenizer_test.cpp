@@ -0,0 +1,119 @@
+#include "../functions/mock_provider.hpp"
+#include "flock/core/config.hpp"
+#include "flock/model_manager/model.hpp"
+#include "flock/model_manager/tokenizer.hpp"
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+
+namespace flock {
+
+// Every single byte plus a few merges: "ab" < "abc" < " ab" < "bc"
+static std::vector<std::pair<std::string, uint32_t>> MakeRanks() {
+    std::vector<std::pair<std::string, uint32_t>> ranks;
+    for (int byte = 0; byte < 256; byte++) {
+        ranks.emplace_back(std::string(1, static_cast<char>(byte)), static_cast<uint32_t>(byte));
+    }
+    ranks.emplace_back("ab", 256);
+    ranks.emplace_back("abc", 257);
+    ranks.emplace_back(" ab", 258);
+    ranks.emplace_back("bc", 259);
+    return ranks;
+}
+
+class TokenizerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        tokenizer_dir = std::filesystem::temp_directory_path() / "flock_tokenizer_test";
+        std::filesystem::remove_all(tokenizer_dir);
+        std::filesystem::create_directories(tokenizer_dir);
+        setenv("FLOCK_TOKENIZER_DIR", tokenizer_dir.c_str(), 1);
+        TokenCounter::ClearCache();
+    }
+
+    void TearDown() override {
+        unsetenv("FLOCK_TOKENIZER_DIR");
+        TokenCounter::ClearCache();
+        std::filesystem::remove_all(tokenizer_dir);
+    }
+
+    // Write the ranks in tiktoken format: base64 token, space, rank
+    void WriteRankFile(const std::string& encoding) const {
+        static const char* alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        std::ofstream file(tokenizer_dir / (encoding + ".tiktoken"));
+        for (const auto& [token, rank]: MakeRanks()) {
+            std::string encoded;
+            int value = 0, bits = -6;
+            for (const auto c: token) {
+                value = (value << 8) + static_cast<unsigned char>(c);
+                bits += 8;
+                while (bits >= 0) {
+                    encoded.push_back(alphabet[(value >> bits) & 0x3F]);
+                    bits -= 6;
+                }
+            }
+            if (bits > -6) {
+                encoded.push_back(alphabet[((value << 8) >> (bits + 8)) & 0x3F]);
+            }
+            while (encoded.size() % 4) {
+                encoded.push_back('=');
+            }
+            file << encoded << " " << rank << "\n";
+        }
+    }
+
+    std::filesystem::path tokenizer_dir;
+};
+
+TEST_F(TokenizerTest, SplitPiecesFollowsCl100kPattern) {
+    const auto pieces = BpeTokenizer::SplitPieces("Hello world's  test 12345\n\n  foo!!");
+    const std::vector<std::string_view> expected = {"Hello", " world", "'s", " ", " test", " ", "123", "45",
+                                                    "\n\n", " ", " foo", "!!"};
+    EXPECT_EQ(pieces, expected);
+}
+
+TEST_F(TokenizerTest, EncodeAppliesMergesByRank) {
+    const auto tokenizer = BpeTokenizer::FromRanks(MakeRanks());
+    EXPECT_EQ(tokenizer->Encode("abc ab abcd xbc"), (std::vector<uint32_t>{257, 258, 32, 257, 100, 32, 120, 259}));
+    EXPECT_EQ(tokenizer->Count("abc ab abcd xbc"), 8);
+    EXPECT_EQ(tokenizer->Count(""), 0);
+}
+
+TEST_F(TokenizerTest, LoadsRankFileForModelEncoding) {
+    EXPECT_EQ(TokenCounter::EncodingForModel("gpt-4o-mini"), TokenCounter::O200K_BASE);
+    EXPECT_EQ(TokenCounter::EncodingForModel("gpt-3.5-turbo"), TokenCounter::CL100K_BASE);
+    EXPECT_EQ(TokenCounter::EncodingForModel("llama3"), "");
+
+    // Without rank files counting falls back to the approximation
+    EXPECT_EQ(TokenCounter::Count("gpt-4o", "abc ab abcd xbc"), TokenCounter::Approximate("abc ab abcd xbc"));
+
+    WriteRankFile(TokenCounter::O200K_BASE);
+    WriteRankFile(TokenCounter::CL100K_BASE);
+    TokenCounter::ClearCache();
+    EXPECT_EQ(TokenCounter::Count("gpt-4o", "abc ab abcd xbc"), 8);
+    // Other providers are approximated with cl100k
+    EXPECT_EQ(TokenCounter::Count("llama3", "abc ab"), 2);
+}
+
+TEST_F(TokenizerTest, LlmTokenCountUsesModelTokenizer) {
+    WriteRankFile(TokenCounter::O200K_BASE);
+    auto mock_provider = std::make_shared<MockProvider>(ModelDetails{});
+    Model::SetMockProvider(mock_provider);
+
+    auto con = Config::GetConnection();
+    con.Query(" CREATE SECRET ("
+              "       TYPE OPENAI,"
+              "    API_KEY 'your-api-key');");
+    const auto results = con.Query("SELECT llm_token_count({'model_name': 'gpt-4o'}, text) AS tokens "
+                                   "FROM VALUES ('abc ab'), ('abcd'), (NULL) AS t(text);");
+    Model::ResetMockProvider();
+
+    ASSERT_FALSE(results->HasError()) << "Query failed: " << results->GetError();
+    ASSERT_EQ(results->RowCount(), 3);
+    EXPECT_EQ(results->GetValue(0, 0).GetValue<int64_t>(), 2);
+    EXPECT_EQ(results->GetValue(0, 1).GetValue<int64_t>(), 2);
+    EXPECT_TRUE(results->GetValue(0, 2).IsNull());
+}
+
+}// namespace flock
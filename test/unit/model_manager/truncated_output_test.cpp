@@ -0,0 +1,20 @@
+#include "flock/model_manager/truncated_output.hpp"
+#include <gtest/gtest.h>
+
+namespace flock {
+
+TEST(TruncatedOutputTest, KeepsCompletedItems) {
+    EXPECT_EQ(ParseTruncatedItems(R"({"items": ["a", "b,]", {"x": [1, 2]}, "cu)"),
+              nlohmann::json::parse(R"(["a", "b,]", {"x": [1, 2]}])"));
+    EXPECT_EQ(ParseTruncatedItems(R"({"items": ["esc\"aped", "x"]})"), nlohmann::json::parse(R"(["esc\"aped", "x"])"));
+    // A value cut mid-way is dropped even when its prefix is valid JSON
+    EXPECT_EQ(ParseTruncatedItems(R"({"items": [true, 12)"), nlohmann::json::parse("[true]"));
+}
+
+TEST(TruncatedOutputTest, ReturnsNothingWithoutItems) {
+    EXPECT_TRUE(ParseTruncatedItems(R"({"items": [)").empty());
+    EXPECT_TRUE(ParseTruncatedItems(R"({"other": ["a", "b"]})").empty());
+    EXPECT_TRUE(ParseTruncatedItems("").empty());
+}
+
+}// namespace flock
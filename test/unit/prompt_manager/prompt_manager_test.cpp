@@ -4,6 +4,8 @@
 #include "flock/prompt_manager/prompt_manager.hpp"
 #include "nlohmann/json.hpp"
 #include <gmock/gmock.h>
+#include <filesystem>
+#include <fstream>
 #include <gtest/gtest.h>
 #include <memory>
 #include <string>
@@ -252,6 +254,52 @@ TEST(PromptManager, CreatePromptDetailsOnlyPromptName) {
     EXPECT_EQ(version, 6);
 }
 
+// Test that the rendered prompt keeps the table data last so batches share a cacheable prefix
+TEST(PromptManager, RenderKeepsTuplesAfterInvariantPrefix) {
+    const json batch1 = json::array({{{"name", "review"}, {"data", {"great", "bad"}}}});
+    const json batch2 = json::array({{{"name", "review"}, {"data", {"fine"}}}});
+
+    auto [prompt1, media1] = PromptManager::Render("Classify the review", batch1, ScalarFunctionType::COMPLETE);
+    auto [prompt2, media2] = PromptManager::Render("Classify the review", batch2, ScalarFunctionType::COMPLETE);
+
+    const auto pos1 = prompt1.rfind(TUPLES_SECTION_HEADER);
+    const auto pos2 = prompt2.rfind(TUPLES_SECTION_HEADER);
+    ASSERT_NE(pos1, std::string::npos);
+    ASSERT_EQ(pos1, pos2);
+    EXPECT_EQ(prompt1.substr(0, pos1), prompt2.substr(0, pos2));
+    EXPECT_NE(prompt1.substr(0, pos1).find("Classify the review"), std::string::npos);
+    EXPECT_NE(prompt1.substr(0, pos1).find("## Output Format"), std::string::npos);
+    EXPECT_EQ(prompt1.substr(0, pos1).find("great"), std::string::npos);
+    EXPECT_NE(prompt1.substr(pos1).find("great"), std::string::npos);
+}
+
+// Test that a user prompt quoting the table header does not move the start of the table data
+TEST(PromptManager, RenderTableHeaderInUserPrompt) {
+    const json batch = json::array({{{"name", "review"}, {"data", {"great"}}}});
+    auto [prompt, media] = PromptManager::Render(std::string("Read the ") + TUPLES_SECTION_HEADER + "below",
+                                                 batch, ScalarFunctionType::COMPLETE);
+
+    const auto pos = prompt.rfind(TUPLES_SECTION_HEADER);
+    ASSERT_NE(pos, std::string::npos);
+    EXPECT_NE(prompt.substr(0, pos).find("Read the"), std::string::npos);
+    EXPECT_NE(prompt.substr(pos).find("great"), std::string::npos);
+}
+
+// Test that a row value quoting the table header does not move the cacheable prefix
+TEST(PromptManager, RenderPrefixLengthIgnoresHeaderInRows) {
+    const json plain = json::array({{{"name", "review"}, {"data", {"great"}}}});
+    const json quoting = json::array({{{"name", "review"}, {"data", {std::string("see ") + TUPLES_SECTION_HEADER}}}});
+
+    auto [prompt1, media1] = PromptManager::Render("Classify the review", plain, ScalarFunctionType::COMPLETE);
+    auto [prompt2, media2] = PromptManager::Render("Classify the review", quoting, ScalarFunctionType::COMPLETE);
+
+    const auto prefix_length = media1[PROMPT_PREFIX_LENGTH].get<size_t>();
+    EXPECT_EQ(prefix_length, prompt1.rfind(TUPLES_SECTION_HEADER));
+    EXPECT_EQ(media2[PROMPT_PREFIX_LENGTH].get<size_t>(), prefix_length);
+    EXPECT_EQ(prompt2.substr(0, prefix_length), prompt1.substr(0, prefix_length));
+    EXPECT_NE(prompt2.rfind(TUPLES_SECTION_HEADER), prefix_length);
+}
+
 // Test fixture for TranscribeAudioColumn tests
 class TranscribeAudioColumnTest : public ::testing::Test {
 protected:
@@ -266,6 +314,7 @@ protected:
 
         mock_provider = std::make_shared<MockProvider>(ModelDetails{});
         Model::SetMockProvider(mock_provider);
+        PromptManager::ClearTranscriptionCache();
     }
 
     void TearDown() override {
@@ -425,4 +474,85 @@ TEST_F(TranscribeAudioColumnTest, TranscribeAudioColumnOutputFormat) {
     EXPECT_EQ(result["data"][0], expected_transcription);
 }
 
-}// namespace flock
\ No newline at end of file
+// Test that a file already transcribed with the same model is served from the cache
+TEST_F(TranscribeAudioColumnTest, TranscribeAudioColumnReusesCachedTranscripts) {
+    json audio_column = {
+            {"name", "call"},
+            {"type", "audio"},
+            {"transcription_model", "gpt-4o-transcribe"},
+            {"data", {"https://example.com/call.mp3"}}};
+
+    json expected_transcription = "{\"text\": \"Cached call\"}";
+
+    EXPECT_CALL(*mock_provider, AddTranscriptionRequest(::testing::_))
+            .Times(1);
+    EXPECT_CALL(*mock_provider, CollectTranscriptions("multipart/form-data"))
+            .WillOnce(::testing::Return(std::vector<nlohmann::json>{expected_transcription}));
+
+    auto first = PromptManager::TranscribeAudioColumn(audio_column);
+    auto second = PromptManager::TranscribeAudioColumn(audio_column);
+
+    EXPECT_EQ(first["data"][0], expected_transcription);
+    EXPECT_EQ(second["data"][0], expected_transcription);
+}
+
+// Test that a local file is keyed by its path, size and mtime, so an edited file is transcribed again
+TEST_F(TranscribeAudioColumnTest, TranscribeAudioColumnRetranscribesChangedLocalFile) {
+    auto file_path = (std::filesystem::temp_directory_path() / "flock_transcript_cache_test.mp3").string();
+    {
+        std::ofstream file(file_path, std::ios::binary | std::ios::trunc);
+        file << "first";
+    }
+    json audio_column = {
+            {"name", "call"},
+            {"type", "audio"},
+            {"transcription_model", "gpt-4o-transcribe"},
+            {"data", {file_path}}};
+
+    json first_transcription = "{\"text\": \"First\"}";
+    json second_transcription = "{\"text\": \"Second\"}";
+
+    EXPECT_CALL(*mock_provider, AddTranscriptionRequest(::testing::_))
+            .Times(2);
+    EXPECT_CALL(*mock_provider, CollectTranscriptions("multipart/form-data"))
+            .WillOnce(::testing::Return(std::vector<nlohmann::json>{first_transcription}))
+            .WillOnce(::testing::Return(std::vector<nlohmann::json>{second_transcription}));
+
+    EXPECT_EQ(PromptManager::TranscribeAudioColumn(audio_column)["data"][0], first_transcription);
+    EXPECT_EQ(PromptManager::TranscribeAudioColumn(audio_column)["data"][0], first_transcription);
+
+    {
+        std::ofstream file(file_path, std::ios::binary | std::ios::trunc);
+        file << "second take";
+    }
+    EXPECT_EQ(PromptManager::TranscribeAudioColumn(audio_column)["data"][0], second_transcription);
+    std::filesystem::remove(file_path);
+}
+
+// Test that prefetching transcribes each distinct file once and keeps NULL rows aligned
+TEST_F(TranscribeAudioColumnTest, PrefetchTranscriptionsDeduplicatesFiles) {
+    json columns = json::array({{{"name", "call"},
+                                 {"type", "audio"},
+                                 {"transcription_model", "gpt-4o-transcribe"},
+                                 {"data", {"https://example.com/a.mp3", nullptr, "https://example.com/b.mp3", "https://example.com/a.mp3"}}}});
+
+    json transcription_a = "{\"text\": \"A\"}";
+    json transcription_b = "{\"text\": \"B\"}";
+    json expected_files = json::array({"https://example.com/a.mp3", "https://example.com/b.mp3"});
+
+    EXPECT_CALL(*mock_provider, AddTranscriptionRequest(expected_files))
+            .Times(1);
+    EXPECT_CALL(*mock_provider, CollectTranscriptions("multipart/form-data"))
+            .WillOnce(::testing::Return(std::vector<nlohmann::json>{transcription_a, transcription_b}));
+
+    PromptManager::PrefetchTranscriptions(columns);
+    auto result = PromptManager::TranscribeAudioColumn(columns[0]);
+
+    ASSERT_EQ(result["data"].size(), 4);
+    EXPECT_EQ(result["data"][0], transcription_a);
+    EXPECT_TRUE(result["data"][1].is_null());
+    EXPECT_EQ(result["data"][2], transcription_b);
+    EXPECT_EQ(result["data"][3], transcription_a);
+}
+
+}// namespace flock